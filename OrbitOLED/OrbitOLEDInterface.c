@@ -93,4 +93,15 @@ OLEDInitialise (void){
 }
 
 
+/*****************************************************************************
+ * OLEDUpdateBusy
+ *   	return: 	true while the display is being updated in the background
+ *   	input: 		void
+ *
+ *   	purpose:	Lets callers skip drawing a frame rather than queue another update
+ *****************************************************************************/
+bool
+OLEDUpdateBusy (void){
 
+	return OrbitOledUpdateBusy() != 0;
+}
@@ -34,5 +34,14 @@ void OLEDStringDraw(const char *pcStr, uint32_t ulColumn, uint32_t ulRow);
  */
 void OLEDInitialise (void);
 
+/*
+ * OLEDUpdateBusy
+ *   	return: 	true while the display is being updated in the background
+ *   	input: 		void
+ *
+ *   	purpose:	Lets callers skip drawing a frame rather than queue another update
+ */
+bool OLEDUpdateBusy (void);
+
 
 #endif /* ORBITOLEDINTERFACE_H_ */
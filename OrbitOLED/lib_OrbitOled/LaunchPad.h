@@ -41,7 +41,7 @@
 //#include "inc/hw_peci.h"
 //#include "inc/hw_pwm.h"
 //#include "inc/hw_qei.h"
-//#include "inc/hw_ssi.h"
+#include "inc/hw_ssi.h"
 //#include "inc/hw_sysctl.h"
 //#include "inc/hw_sysexc.h"
 #include "inc/hw_timer.h"
@@ -69,7 +69,7 @@
 //#include "driverlib/hibernate.h"
 //#include "driverlib/i2c.h"
 //#include "driverlib/i2s.h"
-//#include "driverlib/interrupt.h"
+#include "driverlib/interrupt.h"
 //#include "driverlib/lpc.h"
 //#include "driverlib/mpu.h"
 //#include "driverlib/peci.h"
@@ -85,7 +85,7 @@
 //#include "driverlib/systick.h"
 #include "driverlib/timer.h"
 //#include "driverlib/uart.h"
-//#include "driverlib/udma.h"
+#include "driverlib/udma.h"
 //#include "driverlib/usb.h"
 //#include "driverlib/watchdog.h"
 
@@ -76,6 +76,32 @@ char *	pbOledFontUser;
 */
 char	rgbOledBmp[cbOledDispMax];
 
+/* These arrays hold the range of columns in each display memory
+** page that the drawing routines have changed since the last update.
+** A page whose first dirty column is after its last is clean.
+*/
+int		rgcolOledDirtyFirst[cpagOledMax];
+int		rgcolOledDirtyLast[cpagOledMax];
+
+/* This is the uDMA channel control table. Only the SSI3 transmit
+** channel is used, to send display data in the background, but the
+** controller requires the table to be aligned to its size.
+*/
+#if defined(__TI_COMPILER_VERSION__)
+#pragma DATA_ALIGN(rgbOledDmaCtl, 1024)
+char	rgbOledDmaCtl[1024];
+#else
+char	rgbOledDmaCtl[1024] __attribute__ ((aligned(1024)));
+#endif
+
+/* State of the background update of the display. The SSI3 interrupt
+** handler sends one dirty page after another until none are left.
+*/
+volatile int	fOledUpdateBusy;		//an update is being sent
+volatile int	fOledUpdatePending;		//an update was requested while busy
+int				ipagOledUpdate;			//page being sent
+void			(*pfnOledUpdateDone)();	//called when an update has been sent
+
 /* ------------------------------------------------------------ */
 /*				Forward Declarations							*/
 /* ------------------------------------------------------------ */
@@ -84,7 +110,8 @@ void	OrbitOledHostInit();
 void	OrbitOledDevInit();
 void	OrbitOledDvrInit();
 char	Ssi3PutByte(char bVal);
-void	OrbitOledPutBuffer(int cb, char * rgbTx);
+void	OrbitOledUpdatePage();
+void	OrbitOledSsi3IntHandler();
 
 /* ------------------------------------------------------------ */
 /*				Procedure Definitions							*/
@@ -161,6 +188,19 @@ OrbitOledHostInit()
 	SSIConfigSetExpClk(SSI3_BASE, SysCtlClockGet(), SSI_FRF_MOTO_MODE_0, SSI_MODE_MASTER, 8000000, 8);
 	SSIEnable(SSI3_BASE);
 
+	/* Initialize the uDMA controller to feed display data to the
+	** SSI3 transmit FIFO. The SSI3 interrupt signals when it is done.
+	*/
+	SysCtlPeripheralEnable(SYSCTL_PERIPH_UDMA);
+	uDMAEnable();
+	uDMAControlBaseSet(rgbOledDmaCtl);
+	uDMAChannelAssign(UDMA_CH15_SSI3TX);
+	uDMAChannelAttributeDisable(UDMA_CH15_SSI3TX, UDMA_ATTR_ALL);
+	uDMAChannelControlSet(UDMA_CH15_SSI3TX | UDMA_PRI_SELECT,
+						UDMA_SIZE_8 | UDMA_SRC_INC_8 | UDMA_DST_INC_NONE | UDMA_ARB_4);
+	SSIDMAEnable(SSI3_BASE, SSI_DMA_TX);
+	SSIIntRegister(SSI3_BASE, OrbitOledSsi3IntHandler);
+
 	/* Make power control pins be outputs with the supplies off
 	*/
 	GPIOPinWrite(VBAT_OLEDPort, VBAT_OLED, VBAT_OLED);
@@ -354,6 +394,7 @@ void
 OrbitOledClearBuffer()
 	{
 	int			ib;
+	int			ipag;
 	char *		pb;
 
 	pb = rgbOledBmp;
@@ -364,6 +405,51 @@ OrbitOledClearBuffer()
 		*pb++ = 0x00;
 	}
 
+	/* The display no longer matches any of the buffer.
+	*/
+	for (ipag = 0; ipag < cpagOledMax; ipag++) {
+		OrbitOledMarkDirty(ipag, 0, ccolOledMax-1);
+	}
+
+}
+
+/* ------------------------------------------------------------ */
+/***	OrbitOledMarkDirty
+**
+**	Parameters:
+**		ipag		- display memory page that was changed
+**		colFirst	- first column changed
+**		colLast		- last column changed
+**
+**	Return Value:
+**		none
+**
+**	Errors:
+**		none
+**
+**	Description:
+**		Record that columns in a page of the memory buffer have
+**		changed, so that the next update sends them to the display.
+*/
+
+void
+OrbitOledMarkDirty(int ipag, int colFirst, int colLast)
+	{
+
+	/* The SSI3 interrupt handler clears the range when it starts
+	** sending the page, so keep it from seeing half an update.
+	*/
+	IntDisable(INT_SSI3);
+
+	if (colFirst < rgcolOledDirtyFirst[ipag]) {
+		rgcolOledDirtyFirst[ipag] = colFirst;
+	}
+	if (colLast > rgcolOledDirtyLast[ipag]) {
+		rgcolOledDirtyLast[ipag] = colLast;
+	}
+
+	IntEnable(INT_SSI3);
+
 }
 
 /* ------------------------------------------------------------ */
@@ -379,49 +465,89 @@ OrbitOledClearBuffer()
 **		none
 **
 **	Description:
-**		Update the OLED display with the contents of the memory buffer
+**		Start updating the OLED display with the contents of the memory
+**		buffer. Only the columns of each page changed since the last
+**		update are sent, by uDMA in the background, so this returns
+**		before the display has been updated. If an update is already
+**		being sent, another is sent straight after it, so any number
+**		of calls while busy cost one more update.
 */
 
 void
 OrbitOledUpdate()
 	{
-	int		ipag;
-//	int		icol;
-	char *	pb;
 
-	pb = rgbOledBmp;
+	IntDisable(INT_SSI3);
 
-	for (ipag = 0; ipag < cpagOledMax; ipag++) {
+	if (fOledUpdateBusy) {
+		fOledUpdatePending = 1;
+	}
+	else {
+		fOledUpdateBusy = 1;
+		ipagOledUpdate = 0;
+		OrbitOledUpdatePage();
+	}
 
-		GPIOPinWrite(nDC_OLEDPort, nDC_OLED, LOW);
+	IntEnable(INT_SSI3);
 
-		/* Set the page address
-		*/
-		Ssi3PutByte(0x22);		//Set page command
-		Ssi3PutByte(ipag);		//page number
+}
 
-		/* Start at the left column
-		*/
-		Ssi3PutByte(0x00);		//set low nibble of column
-		Ssi3PutByte(0x10);		//set high nibble of column
+/* ------------------------------------------------------------ */
+/***	OrbitOledUpdateBusy
+**
+**	Parameters:
+**		none
+**
+**	Return Value:
+**		returns 1 if an update is being sent, 0 if not
+**
+**	Errors:
+**		none
+**
+**	Description:
+**		Drawing is allowed while an update is being sent. Changes
+**		to columns already sent go out with the next update.
+*/
 
-		GPIOPinWrite(nDC_OLEDPort, nDC_OLED, nDC_OLED);
+int
+OrbitOledUpdateBusy()
+	{
 
-		/* Copy this memory page of display data.
-		*/
-		OrbitOledPutBuffer(ccolOledMax, pb);
-		pb += ccolOledMax;
+	return fOledUpdateBusy;
 
-	}
+}
+
+/* ------------------------------------------------------------ */
+/***	OrbitOledSetUpdateDone
+**
+**	Parameters:
+**		pfn		- function to call, or 0 for none
+**
+**	Return Value:
+**		none
+**
+**	Errors:
+**		none
+**
+**	Description:
+**		Set the function called when an update has been sent to the
+**		display. It is called from the SSI3 interrupt handler, or
+**		from OrbitOledUpdate if there was nothing to send.
+*/
+
+void
+OrbitOledSetUpdateDone(void (*pfn)())
+	{
+
+	pfnOledUpdateDone = pfn;
 
 }
 
 /* ------------------------------------------------------------ */
-/***	OrbitOledPutBuffer
+/***	OrbitOledUpdatePage
 **
 **	Parameters:
-**		cb		- number of bytes to send/receive
-**		rgbTx	- pointer to the buffer to send
+**		none
 **
 **	Return Value:
 **		none
@@ -430,41 +556,113 @@ OrbitOledUpdate()
 **		none
 **
 **	Description:
-**		Send the bytes specified in rgbTx to the slave 
+**		Start sending the next dirty page of the update, or finish
+**		the update if there are none left. Must be called with the
+**		SSI3 interrupt disabled or from its handler.
 */
 
 void
-OrbitOledPutBuffer(int cb, char * rgbTx)
+OrbitOledUpdatePage()
 	{
-	int32_t				ib;
-	uint32_t	    bTmp;
+	int		colFirst;
+	int		colLast;
 
-	/* Bring the slave select line low
+	/* Find the next page that has changed since it was last sent,
+	** starting over if another update was requested meanwhile.
 	*/
-	GPIOPinWrite(nCS_OLEDPort, nCS_OLED, LOW);
+	while (1) {
+		if (ipagOledUpdate == cpagOledMax) {
+			if (!fOledUpdatePending) {
+				fOledUpdateBusy = 0;
+				if (pfnOledUpdateDone != 0) {
+					(*pfnOledUpdateDone)();
+				}
+				return;
+			}
+			fOledUpdatePending = 0;
+			ipagOledUpdate = 0;
+		}
+
+		if (rgcolOledDirtyFirst[ipagOledUpdate] <= rgcolOledDirtyLast[ipagOledUpdate]) {
+			break;
+		}
+		ipagOledUpdate += 1;
+	}
 
-	/* Write/Read the data
+	/* Take the dirty range, so that drawing from now on marks
+	** the page dirty again for the next update.
 	*/
-	for (ib = 0; ib < cb; ib++) {
-		/* Wait for transmitter to be ready
-		*/
-		while (SSIBusy(SSI3_BASE));
+	colFirst = rgcolOledDirtyFirst[ipagOledUpdate];
+	colLast = rgcolOledDirtyLast[ipagOledUpdate];
+	rgcolOledDirtyFirst[ipagOledUpdate] = ccolOledMax;
+	rgcolOledDirtyLast[ipagOledUpdate] = -1;
 
-		/* Write the next transmit byte.
-		*/
-		SSIDataPut(SSI3_BASE, (uint32_t)*rgbTx++);
+	GPIOPinWrite(nDC_OLEDPort, nDC_OLED, LOW);
+
+	/* Set the page address
+	*/
+	Ssi3PutByte(0xB0 | ipagOledUpdate);	//set page start command
 
-		/* Wait for receive byte.
-		*/
-		while (SSIBusy(SSI3_BASE));
-		SSIDataGet(SSI3_BASE, &bTmp);
+	/* Start at the first dirty column
+	*/
+	Ssi3PutByte(0x00 | (colFirst & 0x0F));		//set low nibble of column
+	Ssi3PutByte(0x10 | (colFirst >> 4));		//set high nibble of column
 
+	GPIOPinWrite(nDC_OLEDPort, nDC_OLED, nDC_OLED);
+
+	/* Bring the slave select line low and let the uDMA copy the
+	** dirty columns of this memory page to the transmit FIFO.
+	*/
+	GPIOPinWrite(nCS_OLEDPort, nCS_OLED, LOW);
+	uDMAChannelTransferSet(UDMA_CH15_SSI3TX | UDMA_PRI_SELECT, UDMA_MODE_BASIC,
+							&rgbOledBmp[(ipagOledUpdate * ccolOledMax) + colFirst],
+							(void *)(SSI3_BASE + SSI_O_DR), colLast - colFirst + 1);
+	uDMAChannelEnable(UDMA_CH15_SSI3TX);
+
+}
+
+/* ------------------------------------------------------------ */
+/***	OrbitOledSsi3IntHandler
+**
+**	Parameters:
+**		none
+**
+**	Return Value:
+**		none
+**
+**	Errors:
+**		none
+**
+**	Description:
+**		Interrupt handler for SSI3, which the uDMA signals when it has
+**		copied a page to the transmit FIFO. Finishes sending the page
+**		and starts the next one.
+*/
+
+void
+OrbitOledSsi3IntHandler()
+	{
+	uint32_t	bRx;
+
+	if (!fOledUpdateBusy ||
+		uDMAChannelModeGet(UDMA_CH15_SSI3TX | UDMA_PRI_SELECT) != UDMA_MODE_STOP) {
+		return;
 	}
 
+	/* Wait for the last few bytes to leave the FIFO, at most 8 bytes
+	** at 8 MHz, then discard the bytes received meanwhile.
+	*/
+	while (SSIBusy(SSI3_BASE));
+	while (SSIDataGetNonBlocking(SSI3_BASE, &bRx));
+	SSIIntClear(SSI3_BASE, SSI_RXOR);
+
 	/* Bring the slave select line high
 	*/
 	GPIOPinWrite(nCS_OLEDPort, nCS_OLED, nCS_OLED);
-	
+
+	ipagOledUpdate += 1;
+	OrbitOledUpdatePage();
+
 }
 
 /* ------------------------------------------------------------ */
@@ -66,6 +66,9 @@ void	OrbitOledInit();
 void	OrbitOledClear();
 void	OrbitOledClearBuffer();
 void	OrbitOledUpdate();
+int		OrbitOledUpdateBusy();
+void	OrbitOledSetUpdateDone(void (*pfn)());
+void	OrbitOledMarkDirty(int ipag, int colFirst, int colLast);
 
 /* ------------------------------------------------------------ */
 
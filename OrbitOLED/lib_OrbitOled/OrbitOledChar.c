@@ -324,6 +324,8 @@ OrbitOledDrawGlyph(char ch)
 	char *	pbFont;
 	char *	pbBmp;
 	int		ib;
+	int		ibFirst;
+	int		ibLast;
 
 	if ((ch & 0x80) != 0) {
 		return;
@@ -337,9 +339,28 @@ OrbitOledDrawGlyph(char ch)
 	}
 
 	pbBmp = pbOledCur;
+	ibFirst = dxcoOledFontCur;
+	ibLast = -1;
 
+	/* Copy the glyph, noting which of its columns differ from what
+	** is already in the buffer, since redrawing the same text is common.
+	*/
 	for (ib = 0; ib < dxcoOledFontCur; ib++) {
-		*pbBmp++ = *pbFont++;
+		if (*pbBmp != *pbFont) {
+			*pbBmp = *pbFont;
+			if (ib < ibFirst) {
+				ibFirst = ib;
+			}
+			ibLast = ib;
+		}
+		pbBmp++;
+		pbFont++;
+	}
+
+	if (ibFirst <= ibLast) {
+		ib = pbOledCur - rgbOledBmp;
+		OrbitOledMarkDirty(ib / ccolOledMax, (ib & (ccolOledMax-1)) + ibFirst,
+							(ib & (ccolOledMax-1)) + ibLast);
 	}
 
 }
@@ -23,6 +23,8 @@
 /*				Include File Definitions						*/
 /* ------------------------------------------------------------ */
 
+#include <stdlib.h>
+
 #include "FillPat.h"
 #include "LaunchPad.h"
 #include "OrbitBoosterPackDefs.h"
@@ -303,8 +305,18 @@ OrbitOledGetDrawMode()
 void
 OrbitOledDrawPixel()
 	{
+	char	bDsp;
+	int		ib;
 
-	*pbOledCur = (*pfnDoRop)((clrOledCur << bnOledCur), *pbOledCur, (1<<bnOledCur));
+	bDsp = (*pfnDoRop)((clrOledCur << bnOledCur), *pbOledCur, (1<<bnOledCur));
+
+	/* Only mark the column dirty if the pixel actually changed.
+	*/
+	if (bDsp != *pbOledCur) {
+		*pbOledCur = bDsp;
+		ib = pbOledCur - rgbOledBmp;
+		OrbitOledMarkDirty(ib / ccolOledMax, ib & (ccolOledMax-1), ib & (ccolOledMax-1));
+	}
 
 }
 
@@ -554,6 +566,7 @@ OrbitOledFillRect(int xco, int yco)
 		ibPat = xcoLeft & 0x07;		//index to first pattern byte
 		xcoCur = xcoLeft;
 		pbCur = pbLeft;
+		OrbitOledMarkDirty(ycoTop/8, xcoLeft, xcoRight);
 
 		/* Loop through all of the bytes horizontally making up this stripe
 		** of the rectangle.
@@ -757,6 +770,9 @@ OrbitOledPutBmp(int dxco, int dyco, char * pbBits)
 		xcoCur = xcoLeft;
 		pbDspCur = pbDspLeft;
 		pbBmpCur = pbBmpLeft;
+		if (xcoLeft < xcoRight) {
+			OrbitOledMarkDirty(ycoTop/8, xcoLeft, xcoRight-1);
+		}
 
 		/* Loop through all of the bytes horizontally making up this stripe
 		** of the rectangle.
@@ -26,6 +26,9 @@
 #include "delay.h"
 #include "LaunchPad.h"
 #include "OrbitBoosterPackDefs.h"
+#include "inc/hw_ints.h"
+#include "driverlib/interrupt.h"
+#include "driverlib/cpu.h"
 
 /* ------------------------------------------------------------ */
 /*				Local Type Definitions							*/
@@ -41,11 +44,15 @@
 /*				Local Variables									*/
 /* ------------------------------------------------------------ */
 
+static volatile bool	fDelayExpired;
+
 
 /* ------------------------------------------------------------ */
 /*				Forward Declarations							*/
 /* ------------------------------------------------------------ */
 
+static void	DelayIntHandler(void);
+
 
 /* ------------------------------------------------------------ */
 /*				Procedure Definitions							*/
@@ -63,7 +70,8 @@
 **
 **	Description:
 **		Initialized the hardware for use by delay functions. This
-**		initializes Timer 1 to count
+**		initializes Timer 1 as a one shot timer whose timeout
+**		interrupt wakes the processor at the end of a delay.
 */
 
 void
@@ -73,9 +81,11 @@ DelayInit()
 	/* Configure Timer 1. 
 	*/
 	SysCtlPeripheralEnable(SYSCTL_PERIPH_TIMER1);
+	while (!SysCtlPeripheralReady(SYSCTL_PERIPH_TIMER1));
 
-	TimerConfigure(TIMER1_BASE, TIMER_CFG_PERIODIC_UP);
-	TimerEnable(TIMER1_BASE, TIMER_A);
+	TimerConfigure(TIMER1_BASE, TIMER_CFG_ONE_SHOT);
+	TimerIntRegister(TIMER1_BASE, TIMER_A, DelayIntHandler);
+	TimerIntEnable(TIMER1_BASE, TIMER_TIMA_TIMEOUT);
 
 
 }
@@ -94,23 +104,73 @@ DelayInit()
 **
 **	Description:
 **		Delay the requested number of milliseconds. Uses Timer1.
+**		Sleeps with WFI until the timer times out rather than
+**		polling it. Works whether or not interrupts are enabled.
 */
 
 void
 DelayMs(int cms)
 	{
-	int		ims;
+	bool	fWasDisabled;
+	bool	fDone;
+
+	if (cms <= 0) {
+		return;
+	}
+
+	fDelayExpired = false;
+	TimerLoadSet(TIMER1_BASE, TIMER_A, (uint32_t)cms * cntMsDelay);
+	TimerEnable(TIMER1_BASE, TIMER_A);
 
-	for (ims=0; ims<cms; ims++) {
+	do {
 		/*
-		 * Clear Timer1
+		 * Masking interrupts around the check means a timeout
+		 * arriving just before the WFI still wakes it. The
+		 * timeout status is checked directly in case the
+		 * interrupts were already masked by the caller.
 		 */
-		HWREG(TIMER1_BASE + TIMER_O_TAV) = 0;
-		while (TimerValueGet(TIMER1_BASE, TIMER_A) < cntMsDelay);
-	}
+		fWasDisabled = IntMasterDisable();
+		fDone = fDelayExpired ||
+			(TimerIntStatus(TIMER1_BASE, false) & TIMER_TIMA_TIMEOUT);
+		if (!fDone) {
+			CPUwfi();
+		}
+		if (!fWasDisabled) {
+			IntMasterEnable();
+		}
+	} while (!fDone);
+
+	TimerIntClear(TIMER1_BASE, TIMER_TIMA_TIMEOUT);
+	IntPendClear(INT_TIMER1A);
 
 }		
 
+/* ------------------------------------------------------------ */
+/***	DelayIntHandler
+**
+**	Parameters:
+**		none
+**
+**	Return Value:
+**		none
+**
+**	Errors:
+**		none
+**
+**	Description:
+**		Timer1 timeout interrupt. Marks the current delay as
+**		expired.
+*/
+
+static void
+DelayIntHandler(void)
+	{
+
+	TimerIntClear(TIMER1_BASE, TIMER_TIMA_TIMEOUT);
+	fDelayExpired = true;
+
+}
+
 /* ------------------------------------------------------------ */
 /***	ProcName
 **
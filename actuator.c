@@ -0,0 +1,94 @@
+/** @file   actuator.c
+    @author Bailey Lissington, Dillon Pike, Joseph Ramirez
+    @date   21 May 2021
+    @brief  Functions related to shaping the controller duty commands before they reach the rotors.
+            Thrust rises roughly with the square of duty above the motor deadband, so linear
+            controller gains act differently across the range. Each command is passed through
+            an inverse thrust table, offset past the deadband, and slew limited, in Q16 fixed point.
+*/
+
+// standard library includes
+#include <stdint.h>
+
+// library includes
+#include "actuator.h"
+
+// Constant definitions
+#define FULL_SCALE (100UL << PWM_DUTY_Q_BITS) // 100 % in Q16
+#define LUT_SEGMENTS 16 // number of linear segments in the thrust table
+#define LUT_SEGMENT_WIDTH (FULL_SCALE / LUT_SEGMENTS)
+
+// Duty above the deadband (Q16 % of the remaining duty range) that produces thrust
+// at each 1/LUT_SEGMENTS step of full thrust, for thrust proportional to duty squared
+static const uint32_t thrustToDuty[LUT_SEGMENTS + 1] = {
+          0, 1638400, 2317048, 2837792, 3276800, 3663574, 4013244, 4334799,
+    4634095, 4915200, 5181076, 5433958, 5675584, 5907335, 6130331, 6345496,
+    6553600
+};
+
+// Per-rotor shaping parameters and state
+typedef struct {
+    uint32_t deadband; // Q16 % duty
+    uint32_t slewRate; // Q16 % duty per s
+    uint32_t slewStep; // Q16 % duty per update, set by actuatorInit
+    uint32_t lastDuty; // Q16 % duty applied at the previous update
+} actuator_t;
+
+static actuator_t actuators[] = {
+    [MAIN] = {PWM_DUTY_TO_Q(ACTUATOR_MAIN_DEADBAND), PWM_DUTY_TO_Q(ACTUATOR_MAIN_SLEW_RATE), 0, 0},
+    [TAIL] = {PWM_DUTY_TO_Q(ACTUATOR_TAIL_DEADBAND), PWM_DUTY_TO_Q(ACTUATOR_TAIL_SLEW_RATE), 0, 0},
+};
+
+/** Interpolates the thrust table.
+    @param commanded thrust in Q16 % of full thrust.
+    @return duty above the deadband in Q16 % of the remaining duty range.  */
+static uint32_t linearise(uint32_t command)
+{
+    if (command >= FULL_SCALE) {
+        return thrustToDuty[LUT_SEGMENTS];
+    }
+    uint32_t segment = command / LUT_SEGMENT_WIDTH;
+    uint32_t offset = command % LUT_SEGMENT_WIDTH;
+    uint32_t rise = thrustToDuty[segment + 1] - thrustToDuty[segment];
+
+    return thrustToDuty[segment] + (uint32_t)(((uint64_t)rise * offset) / LUT_SEGMENT_WIDTH);
+}
+
+/** Sets the rate actuatorShape is called at for each rotor, which the slew limits are
+    spread over.  */
+void actuatorInit(uint32_t updateHz)
+{
+    actuators[MAIN].slewStep = actuators[MAIN].slewRate / updateHz;
+    actuators[TAIL].slewStep = actuators[TAIL].slewRate / updateHz;
+}
+
+/** Shapes a controller command into the duty cycle that produces the commanded thrust.  */
+uint32_t actuatorShape(rotor chosenRotor, uint32_t command)
+{
+    actuator_t* act = &actuators[chosenRotor];
+
+    if (command == 0) {
+        act->lastDuty = 0;
+        return 0;
+    }
+
+    // Spreads the linearised command over the duty range above the deadband
+    uint32_t span = PWM_DUTY_TO_Q(PWM_DUTY_MAX) - act->deadband;
+    uint32_t duty = act->deadband + (uint32_t)(((uint64_t)linearise(command) * span) / FULL_SCALE);
+
+    if (duty < PWM_DUTY_TO_Q(PWM_DUTY_MIN)) {
+        duty = PWM_DUTY_TO_Q(PWM_DUTY_MIN);
+    } else if (duty > PWM_DUTY_TO_Q(PWM_DUTY_MAX)) {
+        duty = PWM_DUTY_TO_Q(PWM_DUTY_MAX);
+    }
+
+    // Limits the change since the previous update
+    if (duty > act->lastDuty + act->slewStep) {
+        duty = act->lastDuty + act->slewStep;
+    } else if (act->lastDuty > act->slewStep && duty < act->lastDuty - act->slewStep) {
+        duty = act->lastDuty - act->slewStep;
+    }
+    act->lastDuty = duty;
+
+    return duty;
+}
@@ -0,0 +1,40 @@
+/** @file   actuator.h
+    @author Bailey Lissington, Dillon Pike, Joseph Ramirez
+    @date   21 May 2021
+    @brief  Functions related to shaping the controller duty commands before they reach the rotors.
+*/
+
+#ifndef ACTUATOR_H_
+#define ACTUATOR_H_
+
+#include <stdint.h>
+#include "pwm.h"
+
+// Duty cycle below which each rotor produces no thrust in %
+#define ACTUATOR_MAIN_DEADBAND 4.0
+#define ACTUATOR_TAIL_DEADBAND 4.0
+
+// Maximum rate of change of each rotor's duty cycle in % per s
+#define ACTUATOR_MAIN_SLEW_RATE 200
+#define ACTUATOR_TAIL_SLEW_RATE 400
+
+// Thrust command in % of full thrust that actuatorShape turns into a fixed duty cycle in %,
+// for duties that are specified as what reaches the rotor. Thrust rises with the square
+// of the duty above the deadband
+#define ACTUATOR_THRUST_FOR_DUTY(duty, deadband) \
+    (100.0 * ((duty) - (deadband)) * ((duty) - (deadband)) / ((PWM_DUTY_MAX - (deadband)) * (PWM_DUTY_MAX - (deadband))))
+
+/** Sets the rate actuatorShape is called at for each rotor, which the slew limits are
+    spread over. Each rotor must be shaped at this one rate.
+    @param rate the rotors are updated at in Hz.  */
+void actuatorInit(uint32_t updateHz);
+
+/** Shapes a controller command into the duty cycle that produces the commanded thrust.
+    Linearises the thrust curve, compensates the deadband, constrains the result to the
+    PWM duty range, then slew limits it. A zero command turns the rotor off immediately.
+    @param rotor the command is for.
+    @param commanded thrust in Q16 % of full thrust.
+    @return duty cycle to apply in Q16 %.  */
+uint32_t actuatorShape(rotor chosenRotor, uint32_t command);
+
+#endif /* ACTUATOR_H_ */
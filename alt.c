@@ -14,41 +14,99 @@
 #include "driverlib/adc.h"
 #include "driverlib/sysctl.h"
 #include "alt.h"
+#include "pacer.h"
+#include "intcfg.h"
+#include "profile.h"
 
 //#define TESTING // Enables built-in potentiometer to be used instead of the rig's output
 
-static volatile bool initialAltRead = false; // Has the initial altitude been read?
-static volatile uint8_t sampleCount = 0; // Counter comparing to BUF_SIZE; interrupt to get the mean initial read
+uint32_t initialAlt;
+circBuf_t circBufADC;
+eventQueue_t adcEvents; // produced by ADCIntHandler only
+static uint8_t sampleCount = 0; // samples written since the last EVENT_ADC_BLOCK_READY
+static volatile uint32_t adcTriggerTime = 0; // timebase value when the current conversion was started
+
+// Altitude rate estimate from the ADC stream
+static uint32_t adcSum = 0; // running sum of the samples in circBufADC
+static uint32_t adcSumHistory[ALT_RATE_WINDOW]; // adcSum after each of the last ALT_RATE_WINDOW samples
+static uint8_t adcSumIndex = 0; // index of the oldest recorded adcSum
+static uint8_t adcSumRecords = 0; // number of sums recorded, up to BUF_SIZE + ALT_RATE_WINDOW
+static volatile int32_t adcSumRate = 0; // filtered change in adcSum over the window, scaled by ALT_RATE_FILTER_SCALE
+
+// function prototypes
+static void altRateUpdate(void);
+
+/** Starts an ADC conversion and records when, so its handler can measure its latency.  */
+void altTrigger(void)
+{
+    // Recorded first, as the conversion's handler preempts the caller
+    adcTriggerTime = pacerGetTime();
+    ADCProcessorTrigger(ADC0_BASE, 0);
+}
 
 /** Calculates the raw ADC mean of the circular buffer and returns it.
     @return average raw ADC.  */
 uint32_t altRead(void)
 {
-    while (!initialAltRead); // Block until initial altitude reading
-
     uint32_t readAlt = bufferMean(&circBufADC);
     return readAlt;
 }
 
 /** Interrupt handler for when the ADC finishes conversion.
-    Fills in the values for buffer in initial read.
-    Waits for buffer to be filled before giving initialAltRead.  */
+    Writes the sample to the circular buffer and posts an event each time
+    another BUF_SIZE samples have been written.  */
 void ADCIntHandler(void)
 {
+    intLatencyRecord(INT_SRC_ADC, pacerGetTime() - adcTriggerTime);
+    PROFILE_START(PROFILE_ADC_ISR);
     uint32_t valADC;
     ADCSequenceDataGet(ADC0_BASE, 0, &valADC);
+    adcSum += valADC - oldestCircBuf(&circBufADC); // replaces the oldest sample in the running sum
     writeCircBuf(&circBufADC, valADC);
     ADCIntClear(ADC0_BASE, 0);
-    if (sampleCount < BUF_SIZE) {
-        sampleCount++;
+    sampleCount++;
+    if (sampleCount >= BUF_SIZE) {
+        sampleCount = 0;
+        eventPost(&adcEvents, EVENT_ADC_BLOCK_READY, 0, 0);
+    }
+    altRateUpdate();
+    PROFILE_END(PROFILE_ADC_ISR);
+}
+
+/** Records the running sum of the circular buffer every sample and low-pass filters its
+    change over the last ALT_RATE_WINDOW samples into adcSumRate.  */
+static void altRateUpdate(void)
+{
+    // Change since the oldest recorded sum, then overwrites the oldest with the newest
+    int32_t change = ((int32_t)adcSum - (int32_t)adcSumHistory[adcSumIndex]) * ALT_RATE_FILTER_SCALE;
+    adcSumHistory[adcSumIndex] = adcSum;
+    adcSumIndex++;
+    if (adcSumIndex >= ALT_RATE_WINDOW) {
+        adcSumIndex = 0;
+    }
+
+    // Only filters once the oldest recorded sum is of a full buffer
+    if (adcSumRecords < BUF_SIZE + ALT_RATE_WINDOW) {
+        adcSumRecords++;
     } else {
-        initialAltRead = true;
+        adcSumRate += (change - adcSumRate) / ALT_RATE_FILTER_DIV;
     }
 }
 
+/** Returns the altitude rate estimated from the ADC stream.
+    @return altitude rate in percentage per second, positive when climbing.  */
+double getAltitudeRate(void)
+{
+    // The ADC reading decreases as altitude increases
+    return -(double)adcSumRate / ALT_RATE_FILTER_SCALE / BUF_SIZE * 100 / MAX_ALT
+           * ADC_SAMPLE_RATE_HZ / ALT_RATE_WINDOW;
+}
+
 /** Initialises the Analog to Digital Converter of the MCU.  */
 void initADC(void)
 {
+    eventQueueInit(&adcEvents);
+
     // Enable ADC0
     SysCtlPeripheralEnable(SYSCTL_PERIPH_ADC0);
     while (!SysCtlPeripheralReady(SYSCTL_PERIPH_ADC0));
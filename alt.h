@@ -7,28 +7,48 @@
 #ifndef ALT_H
 #define ALT_H
 
+#include "event.h"
+#include "circBufT.h"
+
 #define ADC_MAX 4095 // max raw value from the adc (2**12-1)
 #define ADC_MAX_V 3.3 // Max voltage the ADC can handle
 #define ALT_MAX_REDUCTION_V 1.0 // Voltage the altitude sensor reduces by at 100 % altitude
 #define MAX_ALT (ADC_MAX / ADC_MAX_V * ALT_MAX_REDUCTION_V) // Maximum altitude expressed as 12-bit int
 #define BUF_SIZE 10
+#define ADC_SAMPLE_RATE_HZ 500 // rate ADC conversions are triggered at (SYSTICK_RATE_HZ)
+
+// Altitude rate estimate, updated every sample: change in the buffer sum over the last
+// ALT_RATE_WINDOW samples, low-pass filtered with a weight of 1 / ALT_RATE_FILTER_DIV on
+// each new change. A climb rate step reaches half the estimate in about 74 ms, and the
+// estimate's -3 dB bandwidth is about 4 Hz, as tests/test_alt.c measures
+#define ALT_RATE_WINDOW 50
+#define ALT_RATE_FILTER_DIV 8
+#define ALT_RATE_FILTER_SCALE 16 // fixed-point scale keeping the fraction of the filtered change
 
 // Global variables needed by alt.c and main.c
-uint32_t initialAlt; // sets initial alt reading i.e. where 0% lies
-circBuf_t circBufADC; // global since initCircBuf uses the same address of circBufADC
+extern uint32_t initialAlt; // sets initial alt reading i.e. where 0% lies
+extern circBuf_t circBufADC; // global since initCircBuf uses the same address of circBufADC
+extern eventQueue_t adcEvents; // EVENT_ADC_BLOCK_READY posted by ADCIntHandler every BUF_SIZE samples
+
+/** Starts an ADC conversion and records when, so its handler can measure its latency.  */
+void altTrigger(void);
 
 /** Calculates the raw ADC mean of the circular buffer and returns it.
     @return average raw ADC.  */
 uint32_t altRead(void);
 
 /** Interrupt handler for when the ADC finishes conversion.
-   Fills in the values for buffer in initial read.
-   Waits for buffer to be filled before giving initialAltRead.  */
+   Writes the sample to the circular buffer and posts an event each time
+   another BUF_SIZE samples have been written.  */
 void ADCIntHandler(void);
 
 /** Initialises the Analog to Digital Converter of the MCU.  */
 void initADC(void);
 
+/** Returns the altitude rate estimated from the ADC stream.
+    @return altitude rate in percentage per second, positive when climbing.  */
+double getAltitudeRate(void);
+
 /** Converts raw ADC to altitude percentage.
     @param raw ADC value.
     @return altitude percentage.  */
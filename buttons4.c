@@ -24,17 +24,108 @@
 #include "inc/hw_types.h"
 #include "driverlib/gpio.h"
 #include "driverlib/sysctl.h"
+#include "driverlib/timer.h"
+#include "driverlib/interrupt.h"
 #include "driverlib/debug.h"
 #include "inc/tm4c123gh6pm.h"  // Board specific defines (for PF0)
 #include "buttons4.h"
+#include "clock.h"
 
+// *******************************************************
+// Port pin masks, generated from the button definitions
+// *******************************************************
+// Pins of port that any button is on
+#define BUT_PORT_PINS(port) \
+	(((UP_BUT_PORT_BASE == (port)) ? UP_BUT_PIN : 0) \
+	| ((DOWN_BUT_PORT_BASE == (port)) ? DOWN_BUT_PIN : 0) \
+	| ((LEFT_BUT_PORT_BASE == (port)) ? LEFT_BUT_PIN : 0) \
+	| ((RIGHT_BUT_PORT_BASE == (port)) ? RIGHT_BUT_PIN : 0) \
+	| ((SWITCH1_BUT_PORT_BASE == (port)) ? SWITCH1_BUT_PIN : 0) \
+	| ((RESET_BUT_PORT_BASE == (port)) ? RESET_BUT_PIN : 0))
+
+// Index of a port in the array of port readings
+enum butPorts {BUT_PORTA = 0, BUT_PORTB, BUT_PORTC, BUT_PORTD, BUT_PORTE, BUT_PORTF, NUM_BUT_PORTS};
+#define BUT_PORT_INDEX(port) \
+	(((port) == GPIO_PORTA_BASE) ? BUT_PORTA : ((port) == GPIO_PORTB_BASE) ? BUT_PORTB \
+	: ((port) == GPIO_PORTC_BASE) ? BUT_PORTC : ((port) == GPIO_PORTD_BASE) ? BUT_PORTD \
+	: ((port) == GPIO_PORTE_BASE) ? BUT_PORTE : BUT_PORTF)
+
+// A button on any other port would be read as if on port F
+#define BUT_PORT_LISTED(port) \
+	(((port) == GPIO_PORTA_BASE) || ((port) == GPIO_PORTB_BASE) || ((port) == GPIO_PORTC_BASE) \
+	|| ((port) == GPIO_PORTD_BASE) || ((port) == GPIO_PORTE_BASE) || ((port) == GPIO_PORTF_BASE))
+#if !BUT_PORT_LISTED(UP_BUT_PORT_BASE) || !BUT_PORT_LISTED(DOWN_BUT_PORT_BASE) \
+	|| !BUT_PORT_LISTED(LEFT_BUT_PORT_BASE) || !BUT_PORT_LISTED(RIGHT_BUT_PORT_BASE) \
+	|| !BUT_PORT_LISTED(SWITCH1_BUT_PORT_BASE) || !BUT_PORT_LISTED(RESET_BUT_PORT_BASE)
+#error "Buttons must be on GPIO ports A to F, which butPorts lists"
+#endif
+
+// Reads the button pins of port, skipping ports without buttons
+#define BUT_PORT_READ(port) \
+	((BUT_PORT_PINS(port) != 0) ? GPIOPinRead ((port), BUT_PORT_PINS(port)) : 0)
+
+// Bit of button name (e.g. UP) in a packed word, set if its pin is high
+#define BUT_BIT(name, pins) \
+	((uint32_t)(((pins)[BUT_PORT_INDEX(name##_BUT_PORT_BASE)] & name##_BUT_PIN) != 0) << (name))
+
+// Slide and reset switches, which have their own debounce time
+#define BUT_SWITCH_BITS (((uint32_t)1 << SWITCH1) | ((uint32_t)1 << RESET))
+
+// Pins of port that a switch is on
+#define BUT_SWITCH_PORT_PINS(port) \
+	(((SWITCH1_BUT_PORT_BASE == (port)) ? SWITCH1_BUT_PIN : 0) \
+	| ((RESET_BUT_PORT_BASE == (port)) ? RESET_BUT_PIN : 0))
+
+// Buttons of a 2-bit vertical counter equal to count - 1, i.e. on their count-th differing poll
+#define BUT_COUNT_REACHED(count) \
+	((((count) - 1) & 1 ? but_count0 : ~but_count0) & (((count) - 1) & 2 ? but_count1 : ~but_count1))
+
+// Buttons whose pin is high when not pushed
+#define BUT_NORMAL_BITS \
+	(((uint32_t)UP_BUT_NORMAL << UP) | ((uint32_t)DOWN_BUT_NORMAL << DOWN) \
+	| ((uint32_t)LEFT_BUT_NORMAL << LEFT) | ((uint32_t)RIGHT_BUT_NORMAL << RIGHT) \
+	| ((uint32_t)SWITCH1_BUT_NORMAL << SWITCH1) | ((uint32_t)RESET_BUT_NORMAL << RESET))
+
+// Bit n of each word below belongs to the button numbered n in butNames
 // *******************************************************
 // Globals to module
 // *******************************************************
-static bool but_state[NUM_BUTS];	// Corresponds to the electrical state
-static uint8_t but_count[NUM_BUTS];
-static bool but_flag[NUM_BUTS];
-static bool but_normal[NUM_BUTS];   // Corresponds to the electrical state
+static volatile uint32_t but_state;	// Corresponds to the electrical state
+static uint32_t but_count0;	// Low bits of the debounce counters
+static uint32_t but_count1;	// High bits of the debounce counters
+static volatile uint32_t but_flag;
+static void (*but_on_change)(void);	// Called when the debounce timer sees a change
+
+// Base, button pins and switch pins of each port, in butPorts order
+static const uint32_t but_port_bases[NUM_BUT_PORTS] = {
+	GPIO_PORTA_BASE, GPIO_PORTB_BASE, GPIO_PORTC_BASE,
+	GPIO_PORTD_BASE, GPIO_PORTE_BASE, GPIO_PORTF_BASE};
+static const uint8_t but_port_pins[NUM_BUT_PORTS] = {
+	BUT_PORT_PINS(GPIO_PORTA_BASE), BUT_PORT_PINS(GPIO_PORTB_BASE), BUT_PORT_PINS(GPIO_PORTC_BASE),
+	BUT_PORT_PINS(GPIO_PORTD_BASE), BUT_PORT_PINS(GPIO_PORTE_BASE), BUT_PORT_PINS(GPIO_PORTF_BASE)};
+static const uint8_t but_switch_port_pins[NUM_BUT_PORTS] = {
+	BUT_SWITCH_PORT_PINS(GPIO_PORTA_BASE), BUT_SWITCH_PORT_PINS(GPIO_PORTB_BASE),
+	BUT_SWITCH_PORT_PINS(GPIO_PORTC_BASE), BUT_SWITCH_PORT_PINS(GPIO_PORTD_BASE),
+	BUT_SWITCH_PORT_PINS(GPIO_PORTE_BASE), BUT_SWITCH_PORT_PINS(GPIO_PORTF_BASE)};
+
+// *******************************************************
+// readButtons: Reads each port with buttons on it once and returns the
+// pin levels packed one bit per button.
+static uint32_t
+readButtons (void)
+{
+	uint32_t pins[NUM_BUT_PORTS];
+
+	// Read each port once; true means HIGH, false means LOW
+	pins[BUT_PORTA] = BUT_PORT_READ (GPIO_PORTA_BASE);
+	pins[BUT_PORTB] = BUT_PORT_READ (GPIO_PORTB_BASE);
+	pins[BUT_PORTC] = BUT_PORT_READ (GPIO_PORTC_BASE);
+	pins[BUT_PORTD] = BUT_PORT_READ (GPIO_PORTD_BASE);
+	pins[BUT_PORTE] = BUT_PORT_READ (GPIO_PORTE_BASE);
+	pins[BUT_PORTF] = BUT_PORT_READ (GPIO_PORTF_BASE);
+	return BUT_BIT(UP, pins) | BUT_BIT(DOWN, pins) | BUT_BIT(LEFT, pins)
+	       | BUT_BIT(RIGHT, pins) | BUT_BIT(SWITCH1, pins) | BUT_BIT(RESET, pins);
+}
 
 // *******************************************************
 // initButtons: Initialise the variables associated with the set of buttons
@@ -42,14 +133,11 @@ static bool but_normal[NUM_BUTS];   // Corresponds to the electrical state
 void
 initButtons (void)
 {
-	int i;
-
 	// UP button (active HIGH)
     SysCtlPeripheralEnable (UP_BUT_PERIPH);
     GPIOPinTypeGPIOInput (UP_BUT_PORT_BASE, UP_BUT_PIN);
     GPIOPadConfigSet (UP_BUT_PORT_BASE, UP_BUT_PIN, GPIO_STRENGTH_2MA,
        GPIO_PIN_TYPE_STD_WPD);
-    but_normal[UP] = UP_BUT_NORMAL;
 
 
 
@@ -58,7 +146,6 @@ initButtons (void)
     GPIOPinTypeGPIOInput (DOWN_BUT_PORT_BASE, DOWN_BUT_PIN);
     GPIOPadConfigSet (DOWN_BUT_PORT_BASE, DOWN_BUT_PIN, GPIO_STRENGTH_2MA,
        GPIO_PIN_TYPE_STD_WPD);
-    but_normal[DOWN] = DOWN_BUT_NORMAL;
 
 
 
@@ -67,7 +154,6 @@ initButtons (void)
     GPIOPinTypeGPIOInput (LEFT_BUT_PORT_BASE, LEFT_BUT_PIN);
     GPIOPadConfigSet (LEFT_BUT_PORT_BASE, LEFT_BUT_PIN, GPIO_STRENGTH_2MA,
        GPIO_PIN_TYPE_STD_WPU);
-    but_normal[LEFT] = LEFT_BUT_NORMAL;
 
 
 
@@ -83,7 +169,6 @@ initButtons (void)
     GPIOPinTypeGPIOInput (RIGHT_BUT_PORT_BASE, RIGHT_BUT_PIN);
     GPIOPadConfigSet (RIGHT_BUT_PORT_BASE, RIGHT_BUT_PIN, GPIO_STRENGTH_2MA,
                       GPIO_PIN_TYPE_STD_WPU);
-    but_normal[RIGHT] = RIGHT_BUT_NORMAL;
 
 
 
@@ -92,62 +177,167 @@ initButtons (void)
     GPIOPinTypeGPIOInput (SWITCH1_BUT_PORT_BASE, SWITCH1_BUT_PIN);
     GPIOPadConfigSet (SWITCH1_BUT_PORT_BASE, SWITCH1_BUT_PIN, GPIO_STRENGTH_2MA,
                       GPIO_PIN_TYPE_STD_WPD);
-    but_normal[SWITCH1] = SWITCH1_BUT_NORMAL;
 
     // RESET (SWITCH2) (active LOW)
     SysCtlPeripheralEnable (RESET_BUT_PERIPH);
     GPIOPinTypeGPIOInput (RESET_BUT_PORT_BASE, RESET_BUT_PIN);
     GPIOPadConfigSet (RESET_BUT_PORT_BASE, RESET_BUT_PIN, GPIO_STRENGTH_2MA,
        GPIO_PIN_TYPE_STD_WPD);
-    but_normal[RESET] = RESET_BUT_NORMAL;
 
 
 
-	for (i = 0; i < NUM_BUTS; i++)
+	// Start from the pins' levels, so a switch already on is not reported
+	// as turned on
+	but_state = readButtons ();
+	but_count0 = 0;
+	but_count1 = 0;
+	but_flag = 0;
+}
+
+// *******************************************************
+// startDebounce: (Re)starts a one-shot debounce timer.  The load is
+// worked out at compile time, as it is restarted on every bounce.
+#define BUT_DEBOUNCE_LOAD(ms) ((uint32_t)(SYS_CLOCK_HZ / 1000) * (ms))
+
+static void
+startDebounce (uint32_t timerBase, uint32_t load)
+{
+	TimerDisable (timerBase, TIMER_A);
+	TimerLoadSet (timerBase, TIMER_A, load);
+	TimerEnable (timerBase, TIMER_A);
+}
+
+// *******************************************************
+// butEdgeIntHandler: Restarts the debounce timer of the buttons or of the
+// switches on any edge of their pins, so the pins are only read once they
+// stop bouncing.
+static void
+butEdgeIntHandler (void)
+{
+	bool butEdge = false;
+	bool switchEdge = false;
+	uint32_t edges;
+	int i;
+
+	for (i = 0; i < NUM_BUT_PORTS; i++)
 	{
-		but_state[i] = but_normal[i];
-		but_count[i] = 0;
-		but_flag[i] = false;
+		if (but_port_pins[i] == 0)
+			continue;
+		edges = GPIOIntStatus (but_port_bases[i], true) & but_port_pins[i];
+		GPIOIntClear (but_port_bases[i], edges);
+		butEdge = butEdge || (edges & ~but_switch_port_pins[i]);
+		switchEdge = switchEdge || (edges & but_switch_port_pins[i]);
 	}
+
+	if (butEdge)
+		startDebounce (BUT_DEBOUNCE_TIMER_BASE, BUT_DEBOUNCE_LOAD(BUT_DEBOUNCE_MS));
+	if (switchEdge)
+		startDebounce (SWITCH_DEBOUNCE_TIMER_BASE, BUT_DEBOUNCE_LOAD(SWITCH_DEBOUNCE_MS));
 }
 
 // *******************************************************
-// updateButtons: Function designed to be called regularly. It polls all
-// buttons once and updates variables associated with the buttons if
-// necessary.  It is efficient enough to be part of an ISR, e.g. from
-// a SysTick interrupt.
-// Debounce algorithm: A state machine is associated with each button.
-// A state change occurs only after NUM_BUT_POLLS consecutive polls have
-// read the pin in the opposite condition, before the state changes and
-// a flag is set.  Set NUM_BUT_POLLS according to the polling rate.
+// settleButtons: Takes the levels of the buttons in mask as their new
+// states, once their pins have been quiet for their debounce time.
+static void
+settleButtons (uint32_t mask)
+{
+	uint32_t changed;
+
+	changed = (readButtons () ^ but_state) & mask;
+	if (changed)
+	{
+		but_state ^= changed;
+		but_flag |= changed;	// Reset by call to checkButton()
+		if (but_on_change)
+			but_on_change ();
+	}
+}
+
+// *******************************************************
+// butDebounceIntHandler: Runs once the push button pins have been quiet
+// for BUT_DEBOUNCE_MS.
+static void
+butDebounceIntHandler (void)
+{
+	TimerIntClear (BUT_DEBOUNCE_TIMER_BASE, TIMER_TIMA_TIMEOUT);
+	settleButtons (~BUT_SWITCH_BITS);
+}
+
+// *******************************************************
+// switchDebounceIntHandler: Runs once the switch pins have been quiet
+// for SWITCH_DEBOUNCE_MS.
+static void
+switchDebounceIntHandler (void)
+{
+	TimerIntClear (SWITCH_DEBOUNCE_TIMER_BASE, TIMER_TIMA_TIMEOUT);
+	settleButtons (BUT_SWITCH_BITS);
+}
+
+// *******************************************************
+// initButtonInts: Enables edge interrupts on the button pins and the
+// debounce timers, after which updateButtons need not be called.
 void
-updateButtons (void)
+initButtonInts (void (*onChange)(void))
 {
-	bool but_value[NUM_BUTS];
 	int i;
-	
-	// Read the pins; true means HIGH, false means LOW
-	but_value[UP] = (GPIOPinRead (UP_BUT_PORT_BASE, UP_BUT_PIN) == UP_BUT_PIN);
-	but_value[DOWN] = (GPIOPinRead (DOWN_BUT_PORT_BASE, DOWN_BUT_PIN) == DOWN_BUT_PIN);
-    but_value[LEFT] = (GPIOPinRead (LEFT_BUT_PORT_BASE, LEFT_BUT_PIN) == LEFT_BUT_PIN);
-    but_value[RIGHT] = (GPIOPinRead (RIGHT_BUT_PORT_BASE, RIGHT_BUT_PIN) == RIGHT_BUT_PIN);
-
-    // Iterate through the buttons, updating button variables as required
-	for (i = 0; i < NUM_BUTS; i++)
+
+	but_on_change = onChange;
+
+	SysCtlPeripheralEnable (BUT_DEBOUNCE_PERIPH);
+	while (!SysCtlPeripheralReady (BUT_DEBOUNCE_PERIPH));
+	TimerConfigure (BUT_DEBOUNCE_TIMER_BASE, TIMER_CFG_ONE_SHOT);
+	TimerIntRegister (BUT_DEBOUNCE_TIMER_BASE, TIMER_A, butDebounceIntHandler);
+	TimerIntEnable (BUT_DEBOUNCE_TIMER_BASE, TIMER_TIMA_TIMEOUT);
+
+	SysCtlPeripheralEnable (SWITCH_DEBOUNCE_PERIPH);
+	while (!SysCtlPeripheralReady (SWITCH_DEBOUNCE_PERIPH));
+	TimerConfigure (SWITCH_DEBOUNCE_TIMER_BASE, TIMER_CFG_ONE_SHOT);
+	TimerIntRegister (SWITCH_DEBOUNCE_TIMER_BASE, TIMER_A, switchDebounceIntHandler);
+	TimerIntEnable (SWITCH_DEBOUNCE_TIMER_BASE, TIMER_TIMA_TIMEOUT);
+
+	for (i = 0; i < NUM_BUT_PORTS; i++)
 	{
-        if (but_value[i] != but_state[i])
-        {
-        	but_count[i]++;
-        	if (but_count[i] >= NUM_BUT_POLLS)
-        	{
-        		but_state[i] = but_value[i];
-        		but_flag[i] = true;	   // Reset by call to checkButton()
-        		but_count[i] = 0;
-        	}
-        }
-        else
-        	but_count[i] = 0;
+		if (but_port_pins[i] == 0)
+			continue;
+		GPIOIntTypeSet (but_port_bases[i], but_port_pins[i], GPIO_BOTH_EDGES);
+		GPIOIntRegister (but_port_bases[i], butEdgeIntHandler);
+		GPIOIntClear (but_port_bases[i], but_port_pins[i]);
+		GPIOIntEnable (but_port_bases[i], but_port_pins[i]);
 	}
+
+	// Takes the current levels without waiting for an edge
+	startDebounce (BUT_DEBOUNCE_TIMER_BASE, BUT_DEBOUNCE_LOAD(BUT_DEBOUNCE_MS));
+	startDebounce (SWITCH_DEBOUNCE_TIMER_BASE, BUT_DEBOUNCE_LOAD(SWITCH_DEBOUNCE_MS));
+}
+
+// *******************************************************
+// updateButtons: Function designed to be called regularly. It reads each
+// button port once and updates variables associated with the buttons if
+// necessary.  It is efficient enough to be part of an ISR, e.g. from
+// a SysTick interrupt.
+// Debounce algorithm: A 2-bit counter is associated with each button.
+// A state change occurs only after NUM_BUT_POLLS (NUM_SWITCH_POLLS for
+// SWITCH1 and RESET) consecutive polls have read the pin in the opposite
+// condition, before the state changes and a flag is set.
+void
+updateButtons (void)
+{
+	uint32_t but_value = readButtons ();
+	uint32_t changing;
+	uint32_t done;
+
+	// Buttons on their NUM_BUT_POLLS-th or NUM_SWITCH_POLLS-th differing poll change state
+	changing = but_value ^ but_state;
+	done = changing
+	       & ((BUT_COUNT_REACHED(NUM_BUT_POLLS) & ~BUT_SWITCH_BITS)
+	          | (BUT_COUNT_REACHED(NUM_SWITCH_POLLS) & BUT_SWITCH_BITS));
+
+	// Counts up the buttons still changing and clears the rest
+	but_count1 = (but_count1 ^ but_count0) & changing & ~done;
+	but_count0 = ~but_count0 & changing & ~done;
+
+	but_state ^= done;
+	but_flag |= done;	// Reset by call to checkButton()
 }
 
 // *******************************************************
@@ -157,29 +347,87 @@ updateButtons (void)
 uint8_t
 checkButton (uint8_t butName)
 {
-	if (but_flag[butName])
+	uint32_t bit = (uint32_t)1 << butName;
+	uint8_t result = NO_CHANGE;
+	bool wasDisabled;
+
+	// Masked so the debounce timer interrupt cannot set a flag between
+	// reading and clearing this one
+	wasDisabled = IntMasterDisable ();
+	if (but_flag & bit)
 	{
-		but_flag[butName] = false;
-		if (but_state[butName] == but_normal[butName])
-			return RELEASED;
+		but_flag &= ~bit;
+		if ((but_state & bit) == (BUT_NORMAL_BITS & bit))
+			result = RELEASED;
 		else
-			return PUSHED;
+			result = PUSHED;
 	}
-	return NO_CHANGE;
+	if (!wasDisabled)
+		IntMasterEnable ();
+	return result;
+}
+
+// *******************************************************
+// initGesture: Initialises the gesture recognition state of a button.
+void
+initGesture (butGesture_t *gesture)
+{
+	gesture->held = false;
+	gesture->repeating = false;
+	gesture->canDouble = false;
+	gesture->releaseMs = 0;
+	gesture->nextRepeatMs = 0;
+	gesture->repeatMs = BUT_REPEAT_START_MS;
 }
 
 // *******************************************************
-// Reads the pin of butName and returns true if high, otherwise false.
-// Accepts SWITCH1 and RESET as butName, otherwise returns false.
+// updateGesture: Recognises the gestures of a button from its state
+// changes and the time they were seen.  Times are compared by their
+// difference so they may wrap.
+uint8_t
+updateGesture (butGesture_t *gesture, uint8_t butState, uint32_t nowMs)
+{
+	uint8_t result = GESTURE_NONE;
+
+	if (butState == PUSHED && !gesture->held)
+	{
+		if (gesture->canDouble && (nowMs - gesture->releaseMs) <= BUT_DOUBLE_PRESS_MS)
+			result = GESTURE_DOUBLE_PRESS;
+		else
+			result = GESTURE_PRESS;
+		gesture->canDouble = (result == GESTURE_PRESS);	// A third press starts afresh
+		gesture->held = true;
+		gesture->repeating = false;
+		gesture->nextRepeatMs = nowMs + BUT_LONG_PRESS_MS;
+		gesture->repeatMs = BUT_REPEAT_START_MS;
+	}
+	else if (butState == RELEASED && gesture->held)
+	{
+		gesture->held = false;
+		gesture->canDouble = gesture->canDouble && !gesture->repeating;	// Only after a short press
+		gesture->releaseMs = nowMs;
+	}
+	else if (gesture->held && (int32_t)(nowMs - gesture->nextRepeatMs) >= 0)
+	{
+		if (gesture->repeating)
+			result = GESTURE_REPEAT;
+		else
+			result = GESTURE_LONG_PRESS;
+		gesture->repeating = true;
+		gesture->nextRepeatMs += gesture->repeatMs;
+		gesture->repeatMs -= gesture->repeatMs * BUT_REPEAT_ACCEL / 100;
+		if (gesture->repeatMs < BUT_REPEAT_MIN_MS)
+			gesture->repeatMs = BUT_REPEAT_MIN_MS;
+	}
+	return result;
+}
+
+// *******************************************************
+// Returns the debounced electrical state of butName, true if high,
+// otherwise false.
 // Added by Bailey Lissington, Dillon Pike, and Joseph Ramirez.
 bool
 getState (uint8_t butName)
 {
-    if (butName == SWITCH1) {
-        return (GPIOPinRead (SWITCH1_BUT_PORT_BASE, SWITCH1_BUT_PIN) == SWITCH1_BUT_PIN);
-
-    } else if (butName == RESET) {
-        return (GPIOPinRead (RESET_BUT_PORT_BASE, RESET_BUT_PIN) == RESET_BUT_PIN);
-    }
-    return false;
+    return (but_state >> butName) & 1;
 }
@@ -26,6 +26,7 @@
 //*****************************************************************************
 enum butNames {UP = 0, DOWN, LEFT, RIGHT, SWITCH1, RESET, NUM_BUTS};
 enum butStates {RELEASED = 0, PUSHED, NO_CHANGE};
+enum butGestures {GESTURE_NONE = 0, GESTURE_PRESS, GESTURE_DOUBLE_PRESS, GESTURE_LONG_PRESS, GESTURE_REPEAT};
 // UP button
 #define UP_BUT_PERIPH           SYSCTL_PERIPH_GPIOE
 #define UP_BUT_PORT_BASE        GPIO_PORTE_BASE
@@ -63,20 +64,74 @@ enum butStates {RELEASED = 0, PUSHED, NO_CHANGE};
 #define RESET_BUT_NORMAL  false
 
 #define NUM_BUT_POLLS 3
-// Debounce algorithm: A state machine is associated with each button.
-// A state change occurs only after NUM_BUT_POLLS consecutive polls have
-// read the pin in the opposite condition, before the state changes and
-// a flag is set.  Set NUM_BUT_POLLS according to the polling rate.
+#define NUM_SWITCH_POLLS 4
+// Debounce algorithm: A 2-bit counter is associated with each button.
+// A state change occurs only after NUM_BUT_POLLS (NUM_SWITCH_POLLS for
+// SWITCH1 and RESET) consecutive polls have read the pin in the opposite
+// condition, before the state changes and a flag is set.  Set
+// NUM_BUT_POLLS according to the polling rate.
+// The counters are "vertical": bit n of each of two words is button n's
+// counter, so every button is debounced at once with a few bitwise
+// operations.  This limits NUM_BUT_POLLS to 4.
+#if (NUM_BUT_POLLS < 1) || (NUM_BUT_POLLS > 4)
+#error "NUM_BUT_POLLS must be from 1 to 4 for the 2-bit debounce counters"
+#endif
+#if (NUM_SWITCH_POLLS < 1) || (NUM_SWITCH_POLLS > 4)
+#error "NUM_SWITCH_POLLS must be from 1 to 4 for the 2-bit debounce counters"
+#endif
+
+// Interrupt driven alternative to polling: any edge on a button pin
+// (re)starts a one-shot timer, and the pins are read once they have been
+// quiet for BUT_DEBOUNCE_MS.  SWITCH1 and RESET have their own timer, as
+// the slide switch bounces for longer and a glitch on RESET must not
+// reset the program.
+#define BUT_DEBOUNCE_MS 5
+#define BUT_DEBOUNCE_PERIPH     SYSCTL_PERIPH_TIMER2
+#define BUT_DEBOUNCE_TIMER_BASE TIMER2_BASE
+#define SWITCH_DEBOUNCE_MS 20
+#define SWITCH_DEBOUNCE_PERIPH     SYSCTL_PERIPH_TIMER0
+#define SWITCH_DEBOUNCE_TIMER_BASE TIMER0_BASE
+
+// Gesture timing in milliseconds.  A button held for BUT_LONG_PRESS_MS
+// gives a long press, then repeats that start BUT_REPEAT_START_MS apart
+// and speed up by BUT_REPEAT_ACCEL percent each time, down to
+// BUT_REPEAT_MIN_MS apart.  A press within BUT_DOUBLE_PRESS_MS of the
+// release of a short press is a double press.
+#define BUT_LONG_PRESS_MS 500
+#define BUT_REPEAT_START_MS 200
+#define BUT_REPEAT_MIN_MS 40
+#define BUT_REPEAT_ACCEL 25
+#define BUT_DOUBLE_PRESS_MS 300
+
+// Gesture recognition state of one button
+typedef struct {
+	bool held;
+	bool repeating;	// Has the long press been given for this hold?
+	bool canDouble;	// Can the next press be a double press?
+	uint32_t releaseMs;	// Time of the last release
+	uint32_t nextRepeatMs;	// Time of the next long press or repeat
+	uint32_t repeatMs;	// Time between repeats
+} butGesture_t;
 
 // *******************************************************
 // initButtons: Initialise the variables associated with the set of buttons
-// defined by the constants above.
+// defined by the constants above.  Each starts in the state its pin is in,
+// so a button or switch already on is not reported as a change.
 void
 initButtons (void);
 
 // *******************************************************
-// updateButtons: Function designed to be called regularly. It polls all
-// buttons once and updates variables associated with the buttons if
+// initButtonInts: Enables edge interrupts on the button pins and the
+// debounce timers, after which updateButtons need not be called.
+// onChange is called from the debounce timer interrupt whenever a
+// button has changed state, e.g. to schedule a call to checkButton.
+// Call after initButtons.
+void
+initButtonInts (void (*onChange)(void));
+
+// *******************************************************
+// updateButtons: Function designed to be called regularly. It reads each
+// button port once and updates variables associated with the buttons if
 // necessary.  It is efficient enough to be part of an ISR, e.g. from
 // a SysTick interrupt.
 void
@@ -91,8 +146,25 @@ uint8_t
 checkButton (uint8_t butName);
 
 // *******************************************************
-// Reads the pin of butName and returns true if high, otherwise false.
-// Accepts SWITCH1 and RESET as butName, otherwise returns false.
+// initGesture: Initialises the gesture recognition state of a button.
+void
+initGesture (butGesture_t *gesture);
+
+// *******************************************************
+// updateGesture: Recognises the gestures of a button from its state
+// changes (as returned by checkButton) and the time they were seen.
+// Must also be called regularly with NO_CHANGE while the button is held
+// to give the long press and repeats, at least as often as
+// BUT_REPEAT_MIN_MS for the full repeat rate.  Returns the gesture
+// recognised, or GESTURE_NONE.  A press is given straight away, even if
+// it turns out to start a double press.
+uint8_t
+updateGesture (butGesture_t *gesture, uint8_t butState, uint32_t nowMs);
+
+// *******************************************************
+// Returns the debounced electrical state of butName, true if high,
+// otherwise false.  Changes of SWITCH1 and RESET are reported by
+// checkButton like the other buttons, PUSHED meaning high.
 // Added by Bailey Lissington, Dillon Pike, and Joseph Ramirez.
 bool
 getState (uint8_t butName);
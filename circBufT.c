@@ -7,7 +7,7 @@
 // P.J. Bones UCECE
 // Last modified:  8.3.2017
 // 
-// bufferMean function and AVERAGE_OF_SUM macro added by
+// bufferMean and oldestCircBuf functions and AVERAGE_OF_SUM macro added by
 // Bailey Lissington, Dillon Pike, and Joseph Ramirez.
 //
 // Last modified: 21 May 2021
@@ -79,6 +79,16 @@ freeCircBuf (circBuf_t * buffer)
 	buffer->data = NULL;
 }
 
+// *******************************************************
+// oldestCircBuf: return entry at the current windex location, the
+// oldest entry once the buffer has filled and the one the next write
+// replaces. Neither index is advanced.
+uint32_t
+oldestCircBuf (circBuf_t *buffer)
+{
+	return buffer->data[buffer->windex];
+}
+
 /** Calculates the mean of the values stored in a circular buffer.
     @param address of circular buffer.
     @return mean of buffer values.  */
@@ -10,7 +10,7 @@
 // P.J. Bones UCECE
 // Last modified:  8.3.2017
 // 
-// bufferMean function added by Bailey Lissington,
+// bufferMean and oldestCircBuf functions added by Bailey Lissington,
 // Dillon Pike, and Joseph Ramirez.
 //
 // Last modified: 21 May 2021
@@ -55,6 +55,13 @@ readCircBuf (circBuf_t *buffer);
 void
 freeCircBuf (circBuf_t *buffer);
 
+// *******************************************************
+// oldestCircBuf: return entry at the current windex location, the
+// oldest entry once the buffer has filled and the one the next write
+// replaces. Neither index is advanced.
+uint32_t
+oldestCircBuf (circBuf_t *buffer);
+
 /** Calculates the mean of the values stored in a circular buffer.
     @param address of circular buffer.
     @return mean of buffer values.  */
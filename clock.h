@@ -0,0 +1,19 @@
+/** @file   clock.h
+    @author Bailey Lissington, Dillon Pike, Joseph Ramirez
+    @date   21 May 2021
+    @brief  System clock configuration, shared by initClock and the compile-time
+            checks of the modules whose timing depends on it.
+*/
+
+#ifndef CLOCK_H_
+#define CLOCK_H_
+
+#define SYS_PLL_HZ 200000000 // PLL output the system clock is divided from
+#define SYS_CLOCK_DIV 10 // a literal, as it is pasted into a SYSCTL_SYSDIV_ code
+#define SYS_CLOCK_HZ (SYS_PLL_HZ / SYS_CLOCK_DIV) // system clock set by initClock (main.c)
+#define SYS_CLOCK_SYSDIV_CODE SYS_CLOCK_DIV_TO_CODE(SYS_CLOCK_DIV)
+
+#define SYS_CLOCK_DIV_TO_CODE(div)  SYS_CLOCK_DIV_TO_CODE_(div)
+#define SYS_CLOCK_DIV_TO_CODE_(div) SYSCTL_SYSDIV_ ## div
+
+#endif /* CLOCK_H_ */
@@ -0,0 +1,122 @@
+/** @file   command.c
+    @author Bailey Lissington, Dillon Pike, Joseph Ramirez
+    @date   21 May 2021
+    @brief  Functions related to commands received over the serial port.
+*/
+
+// standard library includes
+#include <stdint.h>
+#include <stdbool.h>
+
+// library includes
+#include "utils/ustdlib.h"
+#include "utils/uartstdio.h"
+#include "pwm.h"
+#include "pacer.h"
+#include "sched.h"
+#include "intcfg.h"
+#include "command.h"
+
+// Constant definitions
+#define COMMAND_BUF_LEN 20 // longest accepted command including the terminator
+
+static char commandBuf[COMMAND_BUF_LEN];
+static uint8_t commandLen = 0;
+static bool commandOverflow = false;
+
+/** Runs a PWM frequency command such as "PWM M 500".
+    @param command without the terminating newline.
+    @return true if the command was recognised and applied.  */
+static bool runPWMCommand(const char* command)
+{
+    rotor chosenRotor;
+    const char* end;
+
+    if (ustrncasecmp(command, "PWM ", 4) != 0) {
+        return false;
+    }
+    switch (command[4]) {
+        case 'M': case 'm': chosenRotor = MAIN; break;
+        case 'T': case 't': chosenRotor = TAIL; break;
+        default: return false;
+    }
+    if (command[5] != ' ') {
+        return false;
+    }
+    uint32_t freqHz = ustrtoul(&command[6], &end, 10);
+    if ((end == &command[6]) || (*end != '\0')) {
+        return false;
+    }
+    return setPWMFrequency(chosenRotor, freqHz);
+}
+
+/** Prints the execution statistics of each scheduler task and the idle time, then clears them.
+    Execution times are in microseconds and wake latencies in clock cycles.  */
+static void printSchedStats(void)
+{
+    uint32_t ticksPerUs = pacerGetTickRate() / 1000000;
+
+    for (uint8_t i = 0; i < schedTaskCount(); i++) {
+        const schedTask_t* task = schedGetTask(i);
+        uint32_t meanExec = (task->runs > 0) ? (uint32_t)(task->totalExec / task->runs) : 0;
+        uint32_t minExec = (task->runs > 0) ? task->minExec : 0;
+
+        uint32_t meanOverrun = (task->overruns > 0) ? (uint32_t)(task->totalOverrun / task->overruns) : 0;
+
+        UARTprintf("%s: runs %u exec %u/%u/%u us late %u us\n", task->name, task->runs,
+                   minExec / ticksPerUs, meanExec / ticksPerUs, task->maxExec / ticksPerUs,
+                   task->maxLateness / ticksPerUs);
+        UARTprintf("  overruns %u by %u/%u us skipped %u\n", task->overruns,
+                   meanOverrun / ticksPerUs, task->maxOverrun / ticksPerUs, task->skipped);
+    }
+
+    pacerSleepStats_t sleepStats;
+    pacerGetSleepStats(&sleepStats);
+    uint32_t idlePercent = (sleepStats.elapsed > 0) ? (uint32_t)(sleepStats.asleep * 100 / sleepStats.elapsed) : 0;
+    uint32_t meanLatency = (sleepStats.wakeups > 0) ? (uint32_t)(sleepStats.latencyTotal / sleepStats.wakeups) : 0;
+    UARTprintf("idle: %u%% wake latency %u/%u cycles\n", idlePercent, meanLatency, sleepStats.latencyMax);
+
+    schedResetStats();
+    pacerResetSleepStats();
+}
+
+/** Prints the worst latency of each measured interrupt source, then clears them.  */
+static void printIntStats(void)
+{
+    for (uint8_t i = 0; i < INT_NUM_SRCS; i++) {
+        UARTprintf("%s: latency %u cycles\n", intSourceName((intSource_t)i), intLatencyMax((intSource_t)i));
+    }
+    intLatencyReset();
+}
+
+/** Reads any characters UARTStdioIntHandler has received without blocking and runs each
+    complete command.  */
+void commandPoll(void)
+{
+    while (UARTRxBytesAvail() > 0) {
+        char c = (char)UARTgetc();
+
+        if ((c == '\r') || (c == '\n')) {
+            if (commandLen > 0) {
+                commandBuf[commandLen] = '\0';
+                if (commandOverflow) {
+                    UARTprintf("Invalid command\n");
+                } else if (ustrcasecmp(commandBuf, "SCHED") == 0) {
+                    printSchedStats();
+                } else if (ustrcasecmp(commandBuf, "INT") == 0) {
+                    printIntStats();
+                } else if (runPWMCommand(commandBuf)) {
+                    UARTprintf("PWM M %d Hz T %d Hz\n", getPWMFrequency(MAIN), getPWMFrequency(TAIL));
+                } else {
+                    UARTprintf("Invalid command\n");
+                }
+            }
+            commandLen = 0;
+            commandOverflow = false;
+        } else if (commandLen < (COMMAND_BUF_LEN - 1)) {
+            commandBuf[commandLen++] = c;
+        } else {
+            commandOverflow = true; // rejects an over-long command once it ends
+        }
+    }
+}
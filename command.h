@@ -0,0 +1,18 @@
+/** @file   command.h
+    @author Bailey Lissington, Dillon Pike, Joseph Ramirez
+    @date   21 May 2021
+    @brief  Functions related to commands received over the serial port.
+*/
+
+#ifndef COMMAND_H_
+#define COMMAND_H_
+
+/** Reads any characters received on UART0 without blocking and runs each complete command.
+    Supported commands (case insensitive, terminated by a newline):
+        PWM M <hz>   sets the main rotor PWM frequency
+        PWM T <hz>   sets the tail rotor PWM frequency
+        SCHED        prints and clears the scheduler task and idle statistics
+        INT          prints and clears the worst latency of each measured interrupt source  */
+void commandPoll(void);
+
+#endif /* COMMAND_H_ */
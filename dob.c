@@ -0,0 +1,64 @@
+/** @file   dob.c
+    @author Bailey Lissington, Dillon Pike, Joseph Ramirez
+    @date   21 May 2021
+    @brief  Functions related to the disturbance observer for altitude hold.
+            Estimates the lumped disturbance (gusts, supply sag, hover duty drift) as the
+            difference between the duty the nominal model needs to produce the measured
+            climb rate and the duty actually applied, both through the same low-pass filter.
+*/
+
+// standard library includes
+#include <stdint.h>
+
+// library includes
+#include "dob.h"
+
+// Macro function definition
+#define MUL_Q(a, b) ((int32_t)(((int64_t)(a) * (b)) >> DOB_Q_BITS)) // Multiplies two fixed-point numbers
+#define CONSTRAIN(x, lo, hi) (((x) < (lo)) ? (lo) : (((x) > (hi)) ? (hi) : (x))) // Constrains x between lo and hi
+
+// Fixed-point constants calculated by dobInit
+static int32_t filterAlpha; // low-pass filter weight of each new sample
+static int32_t filterRate; // 1 / DOB_FILTER_TAU
+static int32_t modelInvGain; // 1 / DOB_MODEL_GAIN
+static int32_t modelTauOverGain; // DOB_MODEL_TAU / DOB_MODEL_GAIN
+
+// Fixed-point states
+static int32_t filteredDuty = 0;
+static int32_t filteredRate = 0;
+static int32_t nominalDuty = 0; // duty the nominal model needs to hold a zero climb rate
+static int32_t estimate = 0;
+
+/** Calculates the fixed-point observer constants for the period it is updated at.  */
+void dobInit(double deltaT)
+{
+    filterAlpha = DOB_TO_Q(deltaT / (DOB_FILTER_TAU + deltaT));
+    filterRate = DOB_TO_Q(1.0 / DOB_FILTER_TAU);
+    modelInvGain = DOB_TO_Q(1.0 / DOB_MODEL_GAIN);
+    modelTauOverGain = DOB_TO_Q(DOB_MODEL_TAU / DOB_MODEL_GAIN);
+}
+
+/** Restarts the observer with a zero estimate, taking the current duty cycle and climb rate
+    as the nominal operating point.  */
+void dobReset(int32_t duty, int32_t climbRate)
+{
+    filteredDuty = duty;
+    filteredRate = climbRate;
+    nominalDuty = duty - MUL_Q(modelInvGain, climbRate);
+    estimate = 0;
+}
+
+/** Updates the disturbance estimate from the applied main duty cycle and the measured climb rate.  */
+int32_t dobUpdate(int32_t duty, int32_t climbRate)
+{
+    filteredDuty += MUL_Q(filterAlpha, duty - filteredDuty);
+    filteredRate += MUL_Q(filterAlpha, climbRate - filteredRate);
+
+    // Inverse nominal model of the filtered climb rate: (tau * d/dt + 1) / gain,
+    // where the derivative of the filtered rate is (rate - filteredRate) / DOB_FILTER_TAU
+    int32_t modelDuty = MUL_Q(modelTauOverGain, MUL_Q(filterRate, climbRate - filteredRate))
+                        + MUL_Q(modelInvGain, filteredRate) + nominalDuty;
+
+    estimate = CONSTRAIN(modelDuty - filteredDuty, -DOB_MAX_ESTIMATE, DOB_MAX_ESTIMATE);
+    return estimate;
+}
@@ -0,0 +1,44 @@
+/** @file   dob.h
+    @author Bailey Lissington, Dillon Pike, Joseph Ramirez
+    @date   21 May 2021
+    @brief  Functions related to the disturbance observer for altitude hold.
+*/
+
+#ifndef DOB_H_
+#define DOB_H_
+
+#include <stdint.h>
+
+#define DOB_Q_BITS 16 // fractional bits of the fixed-point states and signals
+#define DOB_TO_Q(x) ((int32_t)((x) * (1L << DOB_Q_BITS))) // Converts a double to fixed-point
+#define DOB_FROM_Q(x) ((double)(x) / (1L << DOB_Q_BITS)) // Converts fixed-point to a double
+
+// Nominal model of the climb rate response to main duty: first order with a
+// steady climb rate of DOB_MODEL_GAIN % per s per % duty and time constant DOB_MODEL_TAU s
+#define DOB_MODEL_GAIN 2.0
+#define DOB_MODEL_TAU 0.5
+
+// Time constant of the observer's low-pass Q-filter in s. Shorter recovers from
+// disturbances faster but passes more altitude rate noise into the duty cycle
+#define DOB_FILTER_TAU 0.2
+
+#define DOB_MAX_ESTIMATE (30L << DOB_Q_BITS) // limit of the disturbance estimate in % duty
+
+/** Calculates the fixed-point observer constants for the period it is updated at.
+    @param time between updates in seconds.  */
+void dobInit(double deltaT);
+
+/** Restarts the observer with a zero estimate, taking the current duty cycle and climb rate
+    as the nominal operating point.
+    @param current main duty cycle in Q16 %.
+    @param current climb rate in Q16 % per s.  */
+void dobReset(int32_t duty, int32_t climbRate);
+
+/** Updates the disturbance estimate from the applied main duty cycle and the measured climb rate.
+    Subtracting the estimate from the next duty command cancels the disturbance.
+    @param main duty cycle applied since the last update in Q16 %.
+    @param measured climb rate in Q16 % per s.
+    @return disturbance estimate in Q16 % duty.  */
+int32_t dobUpdate(int32_t duty, int32_t climbRate);
+
+#endif /* DOB_H_ */
@@ -0,0 +1,60 @@
+/** @file   event.c
+    @author Bailey Lissington, Dillon Pike, Joseph Ramirez
+    @date   21 May 2021
+    @brief  Functions related to the event queues that interrupt handlers post to.
+*/
+
+// standard library includes
+#include <stdint.h>
+#include <stdbool.h>
+
+// library includes
+#include "event.h"
+
+/** Empties a queue. Only safe while neither side is using it.  */
+void eventQueueInit(eventQueue_t* queue)
+{
+    queue->head = 0;
+    queue->tail = 0;
+    queue->dropped = 0;
+}
+
+/** Adds an event to the back of a queue. Called only by the queue's producer.  */
+bool eventPost(eventQueue_t* queue, uint8_t type, uint8_t source, int16_t value)
+{
+    uint8_t head = queue->head;
+
+    if ((uint8_t)(head - queue->tail) >= EVENT_QUEUE_SIZE) {
+        queue->dropped++;
+        return false;
+    }
+
+    volatile event_t* slot = &queue->events[head & EVENT_QUEUE_MASK];
+    slot->type = type;
+    slot->source = source;
+    slot->value = value;
+
+    EVENT_BARRIER(); // the event is complete before the consumer can see it
+    queue->head = head + 1;
+    return true;
+}
+
+/** Takes the event at the front of a queue. Called only by the queue's consumer.  */
+bool eventGet(eventQueue_t* queue, event_t* event)
+{
+    uint8_t tail = queue->tail;
+
+    if (tail == queue->head) {
+        return false;
+    }
+    EVENT_BARRIER(); // the event is read after seeing it was posted
+
+    volatile event_t* slot = &queue->events[tail & EVENT_QUEUE_MASK];
+    event->type = slot->type;
+    event->source = slot->source;
+    event->value = slot->value;
+
+    EVENT_BARRIER(); // the event is read before its slot can be reused
+    queue->tail = tail + 1;
+    return true;
+}
@@ -0,0 +1,65 @@
+/** @file   event.h
+    @author Bailey Lissington, Dillon Pike, Joseph Ramirez
+    @date   21 May 2021
+    @brief  Functions related to the event queues that interrupt handlers post to.
+            Each queue is a lock-free ring with a single producer (one interrupt handler)
+            and a single consumer (the control task), so neither side ever blocks the other.
+*/
+
+#ifndef EVENT_H_
+#define EVENT_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define EVENT_QUEUE_SIZE 16 // events each queue holds. Must be a power of two no more than 128
+#define EVENT_QUEUE_MASK (EVENT_QUEUE_SIZE - 1)
+
+// Orders the event slot and index accesses between the producer and consumer
+#ifdef HOST_BUILD
+#define EVENT_BARRIER() __atomic_thread_fence(__ATOMIC_SEQ_CST)
+#else
+#define EVENT_BARRIER() __asm(" dmb")
+#endif
+
+typedef enum {
+    EVENT_BUTTON_CHANGED = 0, // source is the button name, value is PUSHED or RELEASED
+    EVENT_SWITCH_CHANGED, // source is the switch name, value is its new state
+    EVENT_REF_YAW_FOUND,
+    EVENT_ADC_BLOCK_READY, // another BUF_SIZE samples are in the circular buffer
+} eventType_t;
+
+typedef struct {
+    uint8_t type;
+    uint8_t source;
+    int16_t value;
+} event_t;
+
+// Indices run freely and are masked on access. head is only written by the
+// producer and tail only by the consumer
+typedef struct {
+    volatile event_t events[EVENT_QUEUE_SIZE];
+    volatile uint8_t head;
+    volatile uint8_t tail;
+    volatile uint32_t dropped; // events posted while the queue was full
+} eventQueue_t;
+
+/** Empties a queue. Only safe while neither side is using it.
+    @param queue to empty.  */
+void eventQueueInit(eventQueue_t* queue);
+
+/** Adds an event to the back of a queue. Called only by the queue's producer.
+    @param queue to post to.
+    @param type of the event, an eventType_t.
+    @param source of the event, e.g. the button or switch name.
+    @param value of the event, its meaning set by the type.
+    @return true if posted, false if the queue was full and the event was dropped.  */
+bool eventPost(eventQueue_t* queue, uint8_t type, uint8_t source, int16_t value);
+
+/** Takes the event at the front of a queue. Called only by the queue's consumer.
+    @param queue to take from.
+    @param event filled in with the event taken.
+    @return true if an event was taken, false if the queue was empty.  */
+bool eventGet(eventQueue_t* queue, event_t* event);
+
+#endif /* EVENT_H_ */
@@ -0,0 +1,68 @@
+/** @file   intcfg.c
+    @author Bailey Lissington, Dillon Pike, Joseph Ramirez
+    @date   21 May 2021
+    @brief  Functions related to the interrupt priorities and interrupt latency measurement.
+*/
+
+// standard library includes
+#include <stdint.h>
+#include <stdbool.h>
+
+// library includes
+#include "inc/hw_ints.h"
+#include "driverlib/interrupt.h"
+#include "intcfg.h"
+
+static volatile uint32_t latencyMax[INT_NUM_SRCS]; // worst latency of each source in clock cycles
+
+static const char* sourceNames[INT_NUM_SRCS] = {
+    "SysTick", "ADC", "Pacer"
+};
+
+/** Sets the priority of every interrupt source used by the program.  */
+void initIntPriorities(void)
+{
+    IntPrioritySet(INT_GPIOB, INT_PRIORITY_YAW);
+    IntPrioritySet(INT_GPIOC, INT_PRIORITY_REF_YAW);
+    IntPrioritySet(INT_ADC0SS0, INT_PRIORITY_ADC);
+    IntPrioritySet(FAULT_SYSTICK, INT_PRIORITY_SYSTICK);
+    IntPrioritySet(INT_WTIMER0A, INT_PRIORITY_TIMERS);
+    IntPrioritySet(INT_TIMER1A, INT_PRIORITY_TIMERS);
+    IntPrioritySet(INT_UART0, INT_PRIORITY_UART);
+    IntPrioritySet(INT_GPIOA, INT_PRIORITY_BUTTONS);
+    IntPrioritySet(INT_GPIOD, INT_PRIORITY_BUTTONS);
+    IntPrioritySet(INT_GPIOE, INT_PRIORITY_BUTTONS);
+    IntPrioritySet(INT_GPIOF, INT_PRIORITY_BUTTONS);
+    IntPrioritySet(INT_TIMER2A, INT_PRIORITY_BUTTONS);
+    IntPrioritySet(INT_TIMER0A, INT_PRIORITY_BUTTONS);
+    IntPrioritySet(INT_SSI3, INT_PRIORITY_OLED);
+    IntPrioritySet(FAULT_PENDSV, INT_PRIORITY_PENDSV);
+}
+
+/** Records the latency of one interrupt, measured by its handler on entry.  */
+void intLatencyRecord(intSource_t source, uint32_t latency)
+{
+    if (latency > latencyMax[source]) {
+        latencyMax[source] = latency;
+    }
+}
+
+/** Returns the worst latency of a source since the last reset.  */
+uint32_t intLatencyMax(intSource_t source)
+{
+    return latencyMax[source];
+}
+
+/** Returns the name of a source.  */
+const char* intSourceName(intSource_t source)
+{
+    return sourceNames[source];
+}
+
+/** Clears the worst latencies of every source.  */
+void intLatencyReset(void)
+{
+    for (uint8_t i = 0; i < INT_NUM_SRCS; i++) {
+        latencyMax[i] = 0;
+    }
+}
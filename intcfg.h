@@ -0,0 +1,130 @@
+/** @file   intcfg.h
+    @author Bailey Lissington, Dillon Pike, Joseph Ramirez
+    @date   21 May 2021
+    @brief  Functions related to the interrupt priorities and interrupt latency measurement.
+
+            The TM4C123 uses the top 3 bits of each priority, and a lower value preempts a higher one.
+            Priorities are assigned by how long each source can wait before data is lost:
+
+            Source               Handler             Priority  Deadline
+            GPIOB  yaw encoder   YawIntHandler       0x00      next quadrature edge, ~10s of us at speed
+            GPIOC  ref yaw       refYawIntHandler    0x20      reference pin passes in a few ms
+            ADC0 SS0             ADCIntHandler       0x40      before the next SysTick trigger, 2 ms
+            SysTick              SysTickIntHandler   0x60      one tick of jitter on the sample rate
+            WTIMER0A/TIMER1A     timebase, delay     0x80      next timebase wrap, 214 s
+            UART0                UARTStdioIntHandler 0xA0      refilling the transmit FIFO, 170 us
+            GPIOA/D/E/F buttons  butEdgeIntHandler   0xC0      restarting the debounce timer, 5 ms
+            TIMER2A/TIMER0A      butDebounceIntHandler,
+                                 switchDebounceIntHandler
+                                                     0xC0      reading the settled buttons
+            SSI3 OLED uDMA done  OrbitOledSsi3IntHandler
+                                                     0xC0      starting the next display page
+            PendSV               PendSVIntHandler    0xE0      button events, next control run
+
+            So encoder edges preempt everything, and PendSV's button events preempt nothing.
+            The ADC conversion SysTick triggers preempts SysTick itself.
+
+            State shared between contexts and why it is safe under nesting.
+            tests/test_intcfg.c preempts the readers at every instruction with their
+            writers, for the rows whose modules build on the host:
+
+            State                      Writer                  Reader                  Protection
+            yawCounter                 YawIntHandler,          control task            single 16 bit stores;
+                                       refYawIntHandler                                GPIOC's store cannot be
+                                                                                       split by GPIOB
+            yawEdgeCount, yawEdgeTime  YawIntHandler           rate loop task          INT_GPIOB masked while read
+            circBufADC, adcSumRate     ADCIntHandler           control, rate tasks     single word reads
+            adcEvents                  ADCIntHandler           main                    single producer queue
+            refYawEvents               refYawIntHandler        control task            single producer queue
+            inputEvents                PendSVIntHandler        control task            single producer queue
+            uartstdio buffers          UARTprintf callers,     UARTStdioIntHandler,    INT_UART0 masked while
+                                       UARTStdioIntHandler     commandPoll             transmit started; single
+                                                                                       producer receive buffer
+            button state, flags        debounce handlers       PendSVIntHandler        interrupts masked while
+                                                                                       flags are cleared
+            adcTriggerTime             SysTickIntHandler       ADCIntHandler           stored before the trigger
+            profile statistics         one context per probe   profile task            copied with interrupts masked
+            latency maxima             one handler per source  serial command         lost maximum on reset only
+            timebase overflows         timebase handler        any context             interrupts masked while
+                                                                                       read and while counted
+            OLED dirty ranges          drawing routines,       SSI3 handler            INT_SSI3 masked while
+                                       SSI3 handler                                    changed in main
+            fDelayExpired              DelayIntHandler         DelayMs                 interrupts masked while checked
+            PWM period, compare        applyDuties,            PWM generators          tasks only, which never
+                                       setPWMFrequency                                 preempt each other
+*/
+
+#ifndef INTCFG_H_
+#define INTCFG_H_
+
+#include <stdint.h>
+
+// Priorities of the interrupt sources, highest first
+#define INT_PRIORITY_YAW 0x00
+#define INT_PRIORITY_REF_YAW 0x20
+#define INT_PRIORITY_ADC 0x40
+#define INT_PRIORITY_SYSTICK 0x60
+#define INT_PRIORITY_TIMERS 0x80
+#define INT_PRIORITY_UART 0xA0
+#define INT_PRIORITY_BUTTONS 0xC0
+#define INT_PRIORITY_OLED 0xC0
+#define INT_PRIORITY_PENDSV 0xE0
+
+// Checks the priorities are ones the hardware holds, and keep the order of the table above
+#define INT_PRIORITY_VALID(priority) ((((priority) & 0x1F) == 0) && ((priority) <= 0xE0))
+
+#if !INT_PRIORITY_VALID(INT_PRIORITY_YAW) || !INT_PRIORITY_VALID(INT_PRIORITY_REF_YAW) \
+    || !INT_PRIORITY_VALID(INT_PRIORITY_ADC) || !INT_PRIORITY_VALID(INT_PRIORITY_SYSTICK) \
+    || !INT_PRIORITY_VALID(INT_PRIORITY_TIMERS) || !INT_PRIORITY_VALID(INT_PRIORITY_UART) \
+    || !INT_PRIORITY_VALID(INT_PRIORITY_BUTTONS) || !INT_PRIORITY_VALID(INT_PRIORITY_OLED) \
+    || !INT_PRIORITY_VALID(INT_PRIORITY_PENDSV)
+#error "Interrupt priorities must be 0x00 to 0xE0 in steps of 0x20, as only the top 3 bits are used"
+#endif
+#if (INT_PRIORITY_YAW >= INT_PRIORITY_REF_YAW) || (INT_PRIORITY_REF_YAW >= INT_PRIORITY_ADC) \
+    || (INT_PRIORITY_ADC >= INT_PRIORITY_SYSTICK) || (INT_PRIORITY_SYSTICK >= INT_PRIORITY_TIMERS) \
+    || (INT_PRIORITY_TIMERS >= INT_PRIORITY_UART) || (INT_PRIORITY_UART >= INT_PRIORITY_BUTTONS) \
+    || (INT_PRIORITY_UART >= INT_PRIORITY_OLED)
+#error "Interrupt priorities must preempt in the order of the table, the encoder first"
+#endif
+#if (INT_PRIORITY_PENDSV <= INT_PRIORITY_BUTTONS) || (INT_PRIORITY_PENDSV <= INT_PRIORITY_OLED)
+#error "PendSV must be the lowest priority, so its button events preempt no handler"
+#endif
+
+// Sources whose trigger time is known, so their latency can be measured.
+// The GPIO edges have no hardware timestamp, but they preempt everything
+// so their latency is bounded by the sections run with interrupts masked.
+// Timing YawIntHandler's entry against the previous edge's yawEdgeTime
+// gives the edge interval plus the difference of two latencies, which
+// cannot be told apart. Capturing the edges would need PB0/PB1's T2CCP
+// timer capture, and TIMER2 is the button debounce timer
+typedef enum {
+    INT_SRC_SYSTICK = 0, // SysTick count at entry
+    INT_SRC_ADC, // SysTick trigger to entry, including the conversion
+    INT_SRC_PACER, // timebase match to entry
+    INT_NUM_SRCS
+} intSource_t;
+
+/** Sets the priority of every interrupt source used by the program.
+    Must be called before interrupts are enabled.  */
+void initIntPriorities(void);
+
+/** Records the latency of one interrupt, measured by its handler on entry.
+    Only the handler of that source may call this.
+    @param source that interrupted.
+    @param latency since its trigger in clock cycles.  */
+void intLatencyRecord(intSource_t source, uint32_t latency);
+
+/** Returns the worst latency of a source since the last reset.
+    @param source to return the latency of.
+    @return latency in clock cycles.  */
+uint32_t intLatencyMax(intSource_t source);
+
+/** Returns the name of a source.
+    @param source to return the name of.
+    @return name of the source.  */
+const char* intSourceName(intSource_t source);
+
+/** Clears the worst latencies of every source.  */
+void intLatencyReset(void);
+
+#endif /* INTCFG_H_ */
@@ -0,0 +1,125 @@
+/** @file   lqr.c
+    @author Bailey Lissington, Dillon Pike, Joseph Ramirez
+    @date   21 May 2021
+    @brief  Functions related to state-feedback (LQR) control of the main and tail rotors.
+            Selected in place of PI control by defining LQR_CONTROL in main.c.
+*/
+
+// standard library includes
+#include <stdint.h>
+#include <stdbool.h>
+
+// library includes
+#include "pi.h"
+#include "lqr.h"
+
+// Macro function definitions
+#define TO_Q(x) ((int32_t)((x) * (1L << LQR_Q_BITS))) // Converts a double to fixed-point
+#define FROM_Q(x) ((double)(x) / (1L << LQR_Q_BITS)) // Converts fixed-point to a double
+#define MUL_Q(a, b) (((int64_t)(a) * (b)) >> LQR_Q_BITS) // Multiplies two fixed-point numbers
+#define CONSTRAIN(x, lo, hi) (((x) < (lo)) ? (lo) : (((x) > (hi)) ? (hi) : (x))) // Constrains x between lo and hi
+
+// Fixed-point states
+static int32_t altIntegral = 0;
+static int32_t yawIntegral = 0;
+static int32_t prevAltitude = 0;
+static int32_t prevYaw = 0;
+static int32_t altRate = 0;
+static int32_t yawRate = 0;
+static bool hasPrevSample = false;
+
+/** Calibrates a fixed-point yaw error to the shortest signed difference between input and setPoint.
+    @param yaw error in degrees.
+    @return yaw error between half a rotation and negative half a rotation.  */
+static int32_t lqrYawError(int32_t error)
+{
+    if (error < -((FULL_ROTATION_DEG / 2) << LQR_Q_BITS)) {
+        error += FULL_ROTATION_DEG << LQR_Q_BITS;
+    } else if (error > ((FULL_ROTATION_DEG / 2) << LQR_Q_BITS)) {
+        error -= FULL_ROTATION_DEG << LQR_Q_BITS;
+    }
+    return error;
+}
+
+/** Calculates the proportional and rate feedback of one rotor, excluding the integral states.  */
+static int64_t lqrStateFeedback(int32_t kAlt, int32_t kAltRate, int32_t kYaw, int32_t kYawRate,
+                                int32_t altError, int32_t yawError)
+{
+    return MUL_Q(kAlt, altError) - MUL_Q(kAltRate, altRate) + MUL_Q(kYaw, yawError) - MUL_Q(kYawRate, yawRate);
+}
+
+/** Calculates main and tail duty cycles from the altitude and yaw states.  */
+void lqrCompute(double altReference, int16_t altitude, double yawReference, int16_t yaw, double deltaT,
+                double* mainDuty, double* tailDuty)
+{
+    int32_t altQ = (int32_t)altitude << LQR_Q_BITS;
+    int32_t yawQ = (int32_t)yaw << LQR_Q_BITS;
+    int32_t deltaTQ = TO_Q(deltaT);
+    int32_t altError = TO_Q(altReference) - altQ;
+    int32_t yawError = lqrYawError(TO_Q(yawReference) - yawQ);
+
+    // Estimates the rates from the change in measurement since the last computation
+    if (hasPrevSample && (deltaTQ > 0)) {
+        altRate = (int32_t)(((int64_t)(altQ - prevAltitude) << LQR_Q_BITS) / deltaTQ);
+        yawRate = (int32_t)(((int64_t)lqrYawError(yawQ - prevYaw) << LQR_Q_BITS) / deltaTQ);
+    }
+    prevAltitude = altQ;
+    prevYaw = yawQ;
+    hasPrevSample = true;
+
+    int64_t mainControl = lqrStateFeedback(LQR_K_MAIN_ALT, LQR_K_MAIN_ALT_RATE, LQR_K_MAIN_YAW, LQR_K_MAIN_YAW_RATE,
+                                           altError, yawError)
+                          + MUL_Q(LQR_K_MAIN_ALT_INT, altIntegral) + MUL_Q(LQR_K_MAIN_YAW_INT, yawIntegral);
+    int64_t tailControl = lqrStateFeedback(LQR_K_TAIL_ALT, LQR_K_TAIL_ALT_RATE, LQR_K_TAIL_YAW, LQR_K_TAIL_YAW_RATE,
+                                           altError, yawError)
+                          + MUL_Q(LQR_K_TAIL_ALT_INT, altIntegral) + MUL_Q(LQR_K_TAIL_YAW_INT, yawIntegral);
+
+    int64_t mainConstrained = CONSTRAIN(mainControl, (int64_t)PI_MIN << LQR_Q_BITS, (int64_t)PI_MAX << LQR_Q_BITS);
+    int64_t tailConstrained = CONSTRAIN(tailControl, (int64_t)PI_MIN << LQR_Q_BITS, (int64_t)PI_MAX << LQR_Q_BITS);
+
+    // Adds to the error integrals only if neither output is constrained
+    if ((mainConstrained == mainControl) && (tailConstrained == tailControl)) {
+        altIntegral = CONSTRAIN(altIntegral + (int32_t)MUL_Q(altError, deltaTQ), -LQR_INT_MAX, LQR_INT_MAX);
+        yawIntegral = CONSTRAIN(yawIntegral + (int32_t)MUL_Q(yawError, deltaTQ), -LQR_INT_MAX, LQR_INT_MAX);
+    }
+
+    *mainDuty = FROM_Q(mainConstrained);
+    *tailDuty = FROM_Q(tailConstrained);
+}
+
+/** Initialises the error integral states so the next outputs continue from the current duty cycles.  */
+void lqrTransfer(double altReference, int16_t altitude, double yawReference, int16_t yaw,
+                 double mainDuty, double tailDuty)
+{
+    int32_t altError = TO_Q(altReference) - ((int32_t)altitude << LQR_Q_BITS);
+    int32_t yawError = lqrYawError(TO_Q(yawReference) - ((int32_t)yaw << LQR_Q_BITS));
+
+    // Restarts the rate estimates since the yaw frame can change on a transition
+    altRate = 0;
+    yawRate = 0;
+    hasPrevSample = false;
+
+    // Integral contributions each output needs to continue from its current duty cycle
+    int64_t mainRemainder = TO_Q(CONSTRAIN(mainDuty, PI_MIN, PI_MAX))
+        - lqrStateFeedback(LQR_K_MAIN_ALT, LQR_K_MAIN_ALT_RATE, LQR_K_MAIN_YAW, LQR_K_MAIN_YAW_RATE, altError, yawError);
+    int64_t tailRemainder = TO_Q(CONSTRAIN(tailDuty, PI_MIN, PI_MAX))
+        - lqrStateFeedback(LQR_K_TAIL_ALT, LQR_K_TAIL_ALT_RATE, LQR_K_TAIL_YAW, LQR_K_TAIL_YAW_RATE, altError, yawError);
+
+    // Solves the 2x2 integral gain system by Cramer's rule
+    int64_t det = (int64_t)LQR_K_MAIN_ALT_INT * LQR_K_TAIL_YAW_INT - (int64_t)LQR_K_MAIN_YAW_INT * LQR_K_TAIL_ALT_INT;
+    int64_t altNum = mainRemainder * LQR_K_TAIL_YAW_INT - tailRemainder * LQR_K_MAIN_YAW_INT;
+    int64_t yawNum = tailRemainder * LQR_K_MAIN_ALT_INT - mainRemainder * LQR_K_TAIL_ALT_INT;
+
+    altIntegral = (int32_t)CONSTRAIN((altNum << LQR_Q_BITS) / det, -LQR_INT_MAX, LQR_INT_MAX);
+    yawIntegral = (int32_t)CONSTRAIN((yawNum << LQR_Q_BITS) / det, -LQR_INT_MAX, LQR_INT_MAX);
+}
+
+/** Sets the error integral and rate states to 0.  */
+void lqrReset(void)
+{
+    altIntegral = 0;
+    yawIntegral = 0;
+    altRate = 0;
+    yawRate = 0;
+    hasPrevSample = false;
+}
@@ -0,0 +1,58 @@
+/** @file   lqr.h
+    @author Bailey Lissington, Dillon Pike, Joseph Ramirez
+    @date   21 May 2021
+    @brief  Functions related to state-feedback (LQR) control of the main and tail rotors.
+            Selected in place of PI control by defining LQR_CONTROL in main.c.
+*/
+
+#ifndef LQR_H_
+#define LQR_H_
+
+#include <stdint.h>
+
+#define LQR_Q_BITS 16 // fractional bits of the fixed-point gains and states
+
+// State-feedback gains in Q16 over [altitude, altitude rate, yaw, yaw rate,
+// altitude error integral, yaw error integral]. Units are %, degrees and seconds.
+// Generated by tools/lqr_gains.py for a 0.1 s control period
+#define LQR_K_MAIN_ALT 107112 // 1.6344
+#define LQR_K_MAIN_ALT_RATE 48649 // 0.7423
+#define LQR_K_MAIN_YAW -18350 // -0.2800
+#define LQR_K_MAIN_YAW_RATE -4243 // -0.0647
+#define LQR_K_MAIN_ALT_INT 37879 // 0.5780
+#define LQR_K_MAIN_YAW_INT -8106 // -0.1237
+#define LQR_K_TAIL_ALT 64464 // 0.9836
+#define LQR_K_TAIL_ALT_RATE 31678 // 0.4834
+#define LQR_K_TAIL_YAW 41836 // 0.6384
+#define LQR_K_TAIL_YAW_RATE 11983 // 0.1829
+#define LQR_K_TAIL_ALT_INT 21658 // 0.3305
+#define LQR_K_TAIL_YAW_INT 16820 // 0.2567
+
+// Limit of the error integral states so the fixed-point products cannot overflow
+#define LQR_INT_MAX (1000L << LQR_Q_BITS)
+
+/** Calculates main and tail duty cycles from the altitude and yaw states.
+    @param reference altitude percentage.
+    @param measured altitude percentage.
+    @param reference yaw in degrees.
+    @param measured yaw in degrees.
+    @param time since the last computation in seconds.
+    @param address to store the main duty cycle.
+    @param address to store the tail duty cycle.  */
+void lqrCompute(double altReference, int16_t altitude, double yawReference, int16_t yaw, double deltaT,
+                double* mainDuty, double* tailDuty);
+
+/** Initialises the error integral states so the next outputs continue from the current duty cycles.
+    @param reference altitude percentage.
+    @param measured altitude percentage.
+    @param reference yaw in degrees.
+    @param measured yaw in degrees.
+    @param current main duty cycle.
+    @param current tail duty cycle.  */
+void lqrTransfer(double altReference, int16_t altitude, double yawReference, int16_t yaw,
+                 double mainDuty, double tailDuty);
+
+/** Sets the error integral and rate states to 0.  */
+void lqrReset(void);
+
+#endif /* LQR_H_ */
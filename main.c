@@ -27,31 +27,48 @@
 #include "alt.h"
 #include "yaw.h"
 #include "pi.h"
+#include "traj.h"
+#include "setpoint.h"
+#include "lqr.h"
+#include "dob.h"
+#include "actuator.h"
+#include "command.h"
 #include "pwm.h"
+#include "timebase.h"
 #include "pacer.h"
+#include "sched.h"
+#include "profile.h"
+#include "intcfg.h"
+#include "clock.h"
 
 // Macro function definition
 #define MIN(a,b) (((a)<(b))?(a):(b)) // min of two numbers
 #define MAX(a,b) (((a)>(b))?(a):(b)) // max of two numbers
-#define CONSTRAIN_PERCENT(x) (MIN(MAX(0, (x)), 100)) // Constrains x to a valid percentage range  */
 
 // Constant definitions
 #define SYSTICK_RATE_HZ 500 // rate of the systick clock
 #define MAX_OLED_STR 17 // maximum allowable string for the OLED display
 #define DEBUG_STR_LEN 30 // buffer size for uart debugging strings. Needs additional characters for newline, escape, zero
-#define BACKGROUND_LOOP_FREQ_HZ 10  // frequency of background loop in main
 
 #define HOVER_DESIRED_ALT 10 // desired altitude when finding hover point
-#define DESIRED_YAW_STEP 15 // increment/decrement step of yaw in degrees
-#define DESIRED_ALT_STEP 10 // increment/decrement step of altitude in percentage
-#define LANDING_ALT_STEP 5 // decrement step of altitude when landing
 
 #define TAIL_DUTY_REF 45 // tail rotor duty cycle for finding reference point
+#define TAIL_THRUST_REF ACTUATOR_THRUST_FOR_DUTY(TAIL_DUTY_REF, ACTUATOR_TAIL_DEADBAND) // command shaped to TAIL_DUTY_REF, ~19 %
 
-#define BUTTON_POLLING_RATE_HZ 100 // rate of button polling in Hz
 
 // RUNNING MODES. UNCOMMENT TO ENABLE
 #define DEBUG // Debug mode. Displays useful info via serial
+//#define LQR_CONTROL // State-feedback control of both rotors in place of PI control, which settles slower on the model (tests/test_lqr.c)
+
+// Scheduler task rates in Hz. The inner rate loops of both rotors run in the rate task
+#define RATE_LOOP_HZ 100
+#ifdef LQR_CONTROL
+#define CONTROL_TASK_HZ 10 // control period the LQR gains were generated for
+#else
+#define CONTROL_TASK_HZ 50
+#endif
+#define TELEMETRY_TASK_HZ 20
+#define DISPLAY_TASK_HZ 5
 
 // Heli mode enumerator and matching strings for output
 enum heliMode {LANDED = 0, LAUNCHING, FLYING, LANDING};
@@ -60,148 +77,409 @@ static const char* heliModeStr[] = {"LANDED", "LAUNCHING", "FLYING", "LANDING"};
 // function prototypes
 void initClock(void);
 void SysTickIntHandler(void);
+void PendSVIntHandler(void);
+void buttonsChanged(void);
+void controlTask(void);
+void handleEvents(void);
+void applyGesture(uint8_t but, uint8_t gesture);
+void rateLoopTask(void);
+void telemetryTask(void);
+void displayTask(void);
+#ifdef PROFILING
+void profileTask(void);
+#endif
+void mainRateLoopUpdate(double deltaT);
+void tailRateLoopUpdate(double deltaT);
+void applyDuties(void);
 void ConfigureUART(void);
 void initProgram(void);
-void displayInfoOLED(int16_t altitudePercentage, int16_t yawDegrees, uint8_t tailDuty, uint8_t mainDuty);
-void displayInfoSerial(int16_t altitudePercentage, int16_t yawDegrees, uint8_t tailDuty, uint8_t mainDuty);
+void displayInfoOLED(int16_t altitudePercentage, int16_t yawDegrees, uint32_t tailDuty, uint32_t mainDuty);
+void displayInfoSerial(int16_t altitudePercentage, int16_t yawDegrees, uint32_t tailDuty, uint32_t mainDuty);
 
 //main.c variable declarations
 static uint32_t clockRate;
-static volatile uint8_t curHeliMode = LANDED;
-static volatile uint8_t desiredAltitude = 0;
-static volatile int16_t desiredYaw = 0;
-static volatile uint8_t dTCounter = 0;
-static volatile bool canLaunch = false;
-static volatile uint8_t sysTickButtonCounter = 0;
+static uint8_t curHeliMode = LANDED;
+static setpoint_t altSetpoint; // desired altitude in percentage
+static setpoint_t yawSetpoint; // desired yaw in degrees
+static butGesture_t gestures[SWITCH1]; // gesture state of the UP, DOWN, LEFT and RIGHT buttons
+static bool canLaunch = false;
+static bool switch1On = false; // latest SWITCH1 state reported by the PendSV handler
+static eventQueue_t inputEvents; // button and switch events, produced by PendSVIntHandler only
+static uint32_t mainDuty = 0; // Q16 % thrust command, written by the main rate loop while it is on, otherwise by the control task
+static uint32_t tailDuty = 0; // Q16 % thrust command, written by the tail rate loop while it is on, otherwise by the control task
+static uint32_t mainAppliedDuty = 0; // Q16 % duty the main rotor was last given, after shaping
+static uint32_t tailAppliedDuty = 0; // Q16 % duty the tail rotor was last given, after shaping
+static bool mainRateLoopOn = false; // is the inner main climb rate loop driving the main rotor?
+static bool tailRateLoopOn = false; // is the inner tail yaw rate loop driving the tail rotor?
+
+// control task state
+static int16_t altitudePercentage = 0;
+static int16_t yawDegrees = 0;
+static bool isHovering = false;
+static uint8_t prevHeliMode = LANDED;
+static bool wasHovering = false;
+static trajectory_t altTraj;
+static trajectory_t yawTraj;
+
+#ifndef LQR_CONTROL
+static bool mainRateLoopWasOn = false;
+static bool tailRateLoopWasOn = false;
+static float desiredClimbRate = 0; // climb rate command from the outer altitude loop in % per s
+static float climbFeedforward = 0; // main thrust feedforward of the altitude reference in %
+static float desiredYawRate = 0; // yaw rate command from the outer angle loop in degrees per s
+static bool mainDobOn = false; // is the disturbance observer compensating the main duty?
+static bool mainDobWasOn = false;
+static int32_t mainDisturbance = 0; // latest disturbance estimate in Q16 % duty
+#endif
 
 /** Main function of the MCU.  */
 int main(void)
 {
-    initProgram();
+    event_t event;
 
-    // local variable declarations
-    uint32_t averageADC = 0;
-    int16_t altitudePercentage = 0;
-    int16_t yawDegrees = 0;
-    uint8_t tailDuty = 0;
-    uint8_t mainDuty = 0;
-    bool isHovering = false;
+    initProgram();
 
-    initialAlt = altRead(); // Takes first reading as initial altitutde (constant)
+    // Takes the first full buffer as the initial altitude (constant)
+    while (!eventGet(&adcEvents, &event) || (event.type != EVENT_ADC_BLOCK_READY));
+    initialAlt = altRead();
+    setpointInit(&altSetpoint, 0, ALT_SETPOINT_MIN, ALT_SETPOINT_MAX, ALT_SETPOINT_COARSE_STEP, ALT_SETPOINT_FINE_STEP,
+                 ALT_SETPOINT_DOUBLE_STEP, 0);
+    setpointInit(&yawSetpoint, 0, 0, 0, YAW_SETPOINT_COARSE_STEP, YAW_SETPOINT_FINE_STEP,
+                 YAW_SETPOINT_DOUBLE_STEP, FULL_ROTATION_DEG);
+    for (uint8_t but = UP; but <= RIGHT; but++) {
+        initGesture(&gestures[but]);
+    }
+    trajInit(&altTraj, 0, ALT_TRAJ_MAX_RATE, ALT_TRAJ_MAX_ACCEL, 0);
+    trajSetNegativeRate(&altTraj, ALT_MAX_DESCENT_RATE);
+    trajInit(&yawTraj, 0, YAW_TRAJ_MAX_RATE, YAW_TRAJ_MAX_ACCEL, FULL_ROTATION_DEG);
+
+    // Lower priority numbers run first when several tasks are due
+    schedInit(pacerGetTime);
+    #ifndef LQR_CONTROL
+    schedAddTask("rate", rateLoopTask, pacerGetTickRate() / RATE_LOOP_HZ, 0);
+    #endif
+    schedAddTask("control", controlTask, pacerGetTickRate() / CONTROL_TASK_HZ, 1);
+    schedAddTask("telemetry", telemetryTask, pacerGetTickRate() / TELEMETRY_TASK_HZ, 2);
+    schedAddTask("display", displayTask, pacerGetTickRate() / DISPLAY_TASK_HZ, 3);
+    #ifdef PROFILING
+    schedAddTask("profile", profileTask, pacerGetTickRate() / PROFILE_REPORT_HZ, 4);
+    #endif
 
     while (1)
     {
-        averageADC = altRead();
-        altitudePercentage = altitudeCalc(averageADC);
-        yawDegrees = getYawDegrees();
-
-        if ((curHeliMode == LAUNCHING)) {
-            // Starts searching for reference yaw once heli is hovering
-            if ((!isHovering) && (altitudePercentage) > 0) {
-                isHovering = true;
-                tailDuty = TAIL_DUTY_REF;
-                enableRefYawInt();
+        // Sleeps until the next task is due once none are left to run
+        if (!schedRunNext()) {
+            pacerSleepUntil(schedNextRelease());
+        }
+    }
+}
+
+/** Steps the altitude or yaw setpoint for a gesture of a button.
+    A press steps coarsely, and the second press of a double press steps on by the
+    double press step. A long press and its repeats step finely.
+    @param button the gesture was on, UP, DOWN, LEFT or RIGHT.
+    @param gesture recognised.  */
+void applyGesture(uint8_t but, uint8_t gesture)
+{
+    setpoint_t* setpoint = ((but == UP) || (but == DOWN)) ? &altSetpoint : &yawSetpoint;
+    int8_t direction = ((but == UP) || (but == RIGHT)) ? 1 : -1;
+
+    if (gesture == GESTURE_PRESS) {
+        setpointStep(setpoint, direction, SETPOINT_COARSE);
+    } else if (gesture == GESTURE_DOUBLE_PRESS) {
+        setpointStep(setpoint, direction, SETPOINT_DOUBLE);
+    } else if ((gesture == GESTURE_LONG_PRESS) || (gesture == GESTURE_REPEAT)) {
+        setpointStep(setpoint, direction, SETPOINT_FINE);
+    }
+}
+
+/** Applies the button changes and switch changes queued by the PendSV handler,
+    discards ADC block events, then launches or lands the heli according to switch 1.  */
+void handleEvents(void)
+{
+    event_t event;
+    uint32_t nowMs = (uint32_t)(timebaseGetUs() / 1000);
+    uint8_t but;
+
+    while (eventGet(&inputEvents, &event)) {
+        if (event.type == EVENT_BUTTON_CHANGED) {
+            applyGesture(event.source, updateGesture(&gestures[event.source], event.value, nowMs));
+        } else if (event.type == EVENT_SWITCH_CHANGED) {
+            if (event.source == SWITCH1) {
+                switch1On = event.value;
+            } else if ((event.source == RESET) && (event.value)) {
+                SysCtlReset();
             }
-        } else if (curHeliMode == LANDING) {
-            if (yawDegrees == desiredYaw) {
-                if (altitudePercentage == 0) {
-                    curHeliMode = LANDED;
-                    mainDuty = 0;
-                    tailDuty = 0; // turns off the motors
-                    isHovering = false;
-                    resetErrorIntegrals(); // resets error integrals so they don't affect next flight
-                } else {
-                    // Gradually lowers altitude when heli is facing reference point
-                    desiredAltitude = CONSTRAIN_PERCENT(desiredAltitude - LANDING_ALT_STEP);
-                }
+        }
+    }
+
+    // Gives the long presses and repeats of held buttons
+    for (but = UP; but <= RIGHT; but++) {
+        applyGesture(but, updateGesture(&gestures[but], NO_CHANGE, nowMs));
+    }
+
+    // Blocks only gate the initial altitude read, so later ones are discarded
+    while (eventGet(&adcEvents, &event));
+
+    if ((switch1On) && (curHeliMode == LANDED)) {
+        // Only launches if switch 1 has been off while program is running
+        if (canLaunch) {
+            curHeliMode = LAUNCHING;
+        }
+    } else if (!switch1On) {
+        canLaunch = true;
+        if (curHeliMode == FLYING) {
+            curHeliMode = LANDING;
+            setpointSet(&yawSetpoint, 0);
+        }
+    }
+}
+
+/** Reads altitude and yaw, runs the helicopter mode logic and the outer controllers,
+    and sets the duty of any rotor its rate loop is not driving.  */
+void controlTask(void)
+{
+    uint32_t averageADC = 0;
+    uint8_t mainSetAltitude = 0;
+    double deltaT = 0;
+    double altReference = 0;
+    double yawReference = 0;
+    event_t event;
+    #ifdef LQR_CONTROL
+    double mainControl = 0;
+    double tailControl = 0;
+    #endif
+
+    handleEvents();
+
+    PROFILE_START(PROFILE_ALT_READ);
+    averageADC = altRead();
+    PROFILE_END(PROFILE_ALT_READ);
+    altitudePercentage = altitudeCalc(averageADC);
+    yawDegrees = getYawDegrees();
+
+    if ((curHeliMode == LAUNCHING)) {
+        // Starts searching for reference yaw once heli is hovering
+        if ((!isHovering) && (altitudePercentage) > 0) {
+            isHovering = true;
+            tailRateLoopOn = false;
+            tailDuty = PWM_DUTY_TO_Q(TAIL_THRUST_REF);
+            enableRefYawInt();
+        }
+    } else if (curHeliMode == LANDING) {
+        if (yawDegrees == setpointGet(&yawSetpoint)) {
+            if (altitudePercentage == 0) {
+                curHeliMode = LANDED;
+                mainRateLoopOn = false;
+                tailRateLoopOn = false;
+                mainDuty = 0;
+                tailDuty = 0; // turns off the motors
+                isHovering = false;
+            } else {
+                // Lowers altitude at no more than ALT_MAX_DESCENT_RATE when heli is facing reference point
+                setpointSet(&altSetpoint, 0);
             }
         }
+    }
 
-        // Sets current and desired yaw to 0 if flag set (heli at reference yaw)
-        // and sets heli to flying mode
-        if (refYawFlag) {
+    // Sets current and desired yaw to 0 once the heli is at the reference yaw
+    // and sets heli to flying mode
+    while (eventGet(&refYawEvents, &event)) {
+        if (event.type == EVENT_REF_YAW_FOUND) {
             yawDegrees = 0;
-            desiredYaw = 0;
+            setpointSet(&yawSetpoint, 0);
+            trajReset(&yawTraj, 0); // yaw reference restarts in the new frame
             curHeliMode = FLYING;
-            refYawFlag = false;
         }
+    }
 
-        if (curHeliMode != LANDED) {
-            if (curHeliMode != LAUNCHING) {
-                mainDuty = mainPiCompute(desiredAltitude, altitudePercentage, ((double)dTCounter)/SYSTICK_RATE_HZ);
-                tailDuty = tailPiCompute(desiredYaw, yawDegrees, ((double)dTCounter)/SYSTICK_RATE_HZ);
-            } else if (!isHovering) {
-                // Sets a desired altitude so heli can find a main duty that allows it to hover
-                mainDuty = mainPiCompute(HOVER_DESIRED_ALT, altitudePercentage, ((double)dTCounter)/SYSTICK_RATE_HZ);
-                tailDuty = tailPiCompute(desiredYaw, yawDegrees, ((double)dTCounter)/SYSTICK_RATE_HZ);
-            } else {
-                // Controls main duty to keep altitude at desired point while searching for reference yaw
-                mainDuty = mainPiCompute(desiredAltitude, altitudePercentage, ((double)dTCounter)/SYSTICK_RATE_HZ);
-            }
+    // Sets a desired altitude so heli can find a main duty that allows it to hover
+    if ((curHeliMode == LAUNCHING) && (!isHovering)) {
+        mainSetAltitude = HOVER_DESIRED_ALT;
+    } else {
+        mainSetAltitude = setpointGet(&altSetpoint);
+    }
+
+    PROFILE_START(PROFILE_CONTROL);
+    deltaT = (double)schedElapsed() / pacerGetTickRate(); // actual time since the last run
+
+    // Shapes the setpoints into rate and acceleration limited references,
+    // which rest on the measured altitude and yaw while landed
+    if (curHeliMode == LANDED) {
+        trajReset(&altTraj, altitudePercentage);
+        trajReset(&yawTraj, yawDegrees);
+        altReference = altitudePercentage;
+        yawReference = yawDegrees;
+    } else {
+        altReference = trajUpdate(&altTraj, mainSetAltitude, deltaT);
+        yawReference = trajUpdate(&yawTraj, setpointGet(&yawSetpoint), deltaT);
+    }
+
+    // Initialises the controllers on every mode transition so the duty cycles stay continuous
+    if ((curHeliMode != prevHeliMode) || (isHovering != wasHovering)) {
+        if (curHeliMode == LANDED) {
+            #ifdef LQR_CONTROL
+            lqrReset(); // resets error integrals so they don't affect next flight
+            #else
+            resetErrorIntegrals(); // resets error integrals so they don't affect next flight
+            #endif
         }
-        dTCounter = 0; // Reset dTCounter
-        setPWMDuty(mainDuty, MAIN);
-        setPWMDuty(tailDuty, TAIL);
+        #ifdef LQR_CONTROL
+        else {
+            lqrTransfer(altReference, altitudePercentage, yawReference, yawDegrees,
+                        PWM_DUTY_FROM_Q(mainDuty), PWM_DUTY_FROM_Q(tailDuty));
+        }
+        #endif
+        // The rate loops keep running across transitions and transfer themselves when turned on
+        prevHeliMode = curHeliMode;
+        wasHovering = isHovering;
+    }
 
-        #ifdef DEBUG
-        displayInfoSerial(altitudePercentage, yawDegrees, tailDuty, mainDuty);
+    if (curHeliMode != LANDED) {
+        #ifdef LQR_CONTROL
+        lqrCompute(altReference, altitudePercentage, yawReference, yawDegrees, deltaT, &mainControl, &tailControl);
+        mainDuty = PWM_DUTY_TO_Q(mainControl);
+        // Tail duty is held at TAIL_DUTY_REF while searching for reference yaw
+        if ((curHeliMode != LAUNCHING) || (!isHovering)) {
+            tailDuty = PWM_DUTY_TO_Q(tailControl);
+        }
+        #else
+        // Outer loops command the rate loops, feeding forward the reference rates
+        desiredClimbRate = mainAltitudeCompute(altReference, altitudePercentage, altTraj.velocity);
+        climbFeedforward = mainRateFeedforward(altTraj.velocity, altTraj.acceleration);
+        desiredYawRate = tailAngleCompute(yawReference, yawDegrees, yawTraj.velocity);
         #endif
-        displayInfoOLED(altitudePercentage, yawDegrees, tailDuty, mainDuty);
+    }
+    #ifndef LQR_CONTROL
+    // Tail duty is held at TAIL_DUTY_REF while searching for reference yaw, otherwise the
+    // rate loops drive the rotors while flying once the outer loops have commanded them
+    mainRateLoopOn = (curHeliMode != LANDED);
+    mainDobOn = (curHeliMode == FLYING);
+    tailRateLoopOn = (curHeliMode != LANDED) && ((curHeliMode != LAUNCHING) || (!isHovering));
+    #endif
+    PROFILE_END(PROFILE_CONTROL);
+
+    #ifdef LQR_CONTROL
+    applyDuties();
+    #endif
+}
+
+/** Shapes both rotor commands and applies them together at the next PWM period boundary.
+    Called from one task only, the rate task or the control task under LQR_CONTROL, so each
+    rotor is slew limited at the rate actuatorInit was given.  */
+void applyDuties(void)
+{
+    PROFILE_START(PROFILE_PWM);
+    mainAppliedDuty = actuatorShape(MAIN, mainDuty);
+    tailAppliedDuty = actuatorShape(TAIL, tailDuty);
+    setPWMDuty(mainAppliedDuty, MAIN);
+    setPWMDuty(tailAppliedDuty, TAIL);
+    pwmCommit();
+    PROFILE_END(PROFILE_PWM);
+}
+
+/** Prints the helicopter state to serial in debug mode and runs any serial commands received.  */
+void telemetryTask(void)
+{
+    #ifdef DEBUG
+    PROFILE_START(PROFILE_SERIAL);
+    displayInfoSerial(altitudePercentage, yawDegrees, tailAppliedDuty, mainAppliedDuty);
+    PROFILE_END(PROFILE_SERIAL);
+    #endif
+    commandPoll(); // e.g. "PWM M 500" changes the main rotor PWM frequency
+}
 
-        pacerWait();
+/** Shows the helicopter state on the OLED.  */
+void displayTask(void)
+{
+    if (OLEDUpdateBusy()) {
+        return; // previous frame is still being sent, so skip this one
     }
+
+    PROFILE_START(PROFILE_OLED);
+    displayInfoOLED(altitudePercentage, yawDegrees, tailAppliedDuty, mainAppliedDuty);
+    PROFILE_END(PROFILE_OLED);
+}
+
+#ifdef PROFILING
+/** Reports and clears the execution time statistics of the probed code sections.  */
+void profileTask(void)
+{
+    profileReport();
 }
+#endif
 
 /** Initialises the peripherals, interrupts, serial output, circular buffer, and yaw channel states.  */
 void initProgram(void)
 {
     initClock();
+    initTimebase();
     initADC();
     initButtons();
+    switch1On = getState(SWITCH1); // so a switch left on cannot launch until turned off and on
+    initButtonInts(buttonsChanged);
+    eventQueueInit(&inputEvents);
     initCircBuf(&circBufADC, BUF_SIZE);
     OLEDInitialise();
     initYawInt();
     initYawStates();
+    initYawRate();
+    #ifdef LQR_CONTROL
+    actuatorInit(CONTROL_TASK_HZ); // the control task applies the duties
+    #else
+    actuatorInit(RATE_LOOP_HZ); // the rate task applies the duties
+    dobInit(1.0 / RATE_LOOP_HZ);
+    #endif
     initRefYawInt();
     initPWMClock();
     initialisePWM();
     initialisePWMTail();
+    initPacer();
+    initIntPriorities();
     IntMasterEnable();
     ConfigureUART();
     SysTickEnable();
-    initPacer(BACKGROUND_LOOP_FREQ_HZ);
+    #ifdef PROFILING
+    profileInit();
+    #endif
 }
 
-/** Displays altitude, yaw, main and tail duty cycles, and the mode of the helicopter to the Orbit OLED.  */
-void displayInfoOLED(int16_t altitudePercentage, int16_t yawDegrees, uint8_t tailDuty, uint8_t mainDuty)
+/** Displays altitude, yaw, the main and tail duty cycles applied, and the mode of the helicopter to the Orbit OLED.  */
+void displayInfoOLED(int16_t altitudePercentage, int16_t yawDegrees, uint32_t tailDuty, uint32_t mainDuty)
 {
     char dispStr[MAX_OLED_STR];
 
-    usnprintf(dispStr, MAX_OLED_STR, "ALT: %4d [%4d]\n", altitudePercentage, desiredAltitude);
+    usnprintf(dispStr, MAX_OLED_STR, "ALT: %4d [%4d]\n", altitudePercentage, setpointGet(&altSetpoint));
     OLEDStringDraw(dispStr, 0, 0); // Display current altitude and desired altitude on line 0
 
-    usnprintf(dispStr, MAX_OLED_STR, "YAW: %4d [%4d]\n", yawDegrees, desiredYaw);
+    usnprintf(dispStr, MAX_OLED_STR, "YAW: %4d [%4d]\n", yawDegrees, setpointGet(&yawSetpoint));
     OLEDStringDraw(dispStr, 0, 1); // Display current yaw and desired yaw on line 1
 
-    usnprintf(dispStr, DEBUG_STR_LEN, "M: %2d T: %2d", mainDuty, tailDuty);
+    usnprintf(dispStr, MAX_OLED_STR, "M: %2d.%1d T: %2d.%1d", PWM_DUTY_WHOLE(mainDuty), PWM_DUTY_TENTHS(mainDuty),
+              PWM_DUTY_WHOLE(tailDuty), PWM_DUTY_TENTHS(tailDuty));
     OLEDStringDraw(dispStr, 0, 2); // Display main and tail duty cycles on line 2
 
     usnprintf(dispStr, MAX_OLED_STR, "MODE: %9s", heliModeStr[curHeliMode]);
     OLEDStringDraw(dispStr, 0, 3); // Display heli mode on line 3
 }
 
-/** Prints altitude, yaw, main and tail duty cycles, and the mode of the helicopter to serial.  */
-void displayInfoSerial(int16_t altitudePercentage, int16_t yawDegrees, uint8_t tailDuty, uint8_t mainDuty)
+/** Prints the time, altitude, yaw, the main and tail duty cycles applied, and the mode of the helicopter to serial.  */
+void displayInfoSerial(int16_t altitudePercentage, int16_t yawDegrees, uint32_t tailDuty, uint32_t mainDuty)
 {
     char debugStr[DEBUG_STR_LEN];
+    uint32_t timeMs = (uint32_t)(timebaseGetUs() / 1000);
+
+    usnprintf(debugStr, DEBUG_STR_LEN, "Time: %u.%03u\n", timeMs / 1000, timeMs % 1000);
+    UARTprintf(debugStr); // Display seconds since start up
 
-    usnprintf(debugStr, DEBUG_STR_LEN, "Alt: %4d [%4d]\n", altitudePercentage, desiredAltitude);
+    usnprintf(debugStr, DEBUG_STR_LEN, "Alt: %4d [%4d]\n", altitudePercentage, setpointGet(&altSetpoint));
     UARTprintf(debugStr); // Display current altitude and desired altitude
 
-    usnprintf(debugStr, DEBUG_STR_LEN, "Yaw: %4d [%4d]\n", yawDegrees, desiredYaw);
+    usnprintf(debugStr, DEBUG_STR_LEN, "Yaw: %4d [%4d]\n", yawDegrees, setpointGet(&yawSetpoint));
     UARTprintf(debugStr); // Display current yaw and desired yaw
 
-    usnprintf(debugStr, DEBUG_STR_LEN, "Main: %3d Tail: %3d\n", mainDuty, tailDuty);
+    usnprintf(debugStr, DEBUG_STR_LEN, "Main: %3d.%1d Tail: %3d.%1d\n", PWM_DUTY_WHOLE(mainDuty), PWM_DUTY_TENTHS(mainDuty),
+              PWM_DUTY_WHOLE(tailDuty), PWM_DUTY_TENTHS(tailDuty));
     UARTprintf(debugStr); // Display main and tail duty cycles
 
     usnprintf(debugStr, DEBUG_STR_LEN, "Mode: %s\n", heliModeStr[curHeliMode]);
@@ -226,66 +504,122 @@ void ConfigureUART(void)
     UARTClockSourceSet(UART0_BASE, UART_CLOCK_PIOSC);
 
     // Initialize the UART for console I/O.
-    UARTStdioConfig(0, 9600, 16000000);
+    // Buffered (uartstdio.h), so printing only queues the output for UARTStdioIntHandler
+    UARTIntRegister(UART0_BASE, UARTStdioIntHandler);
+    UARTStdioConfig(0, 115200, 16000000);
+    UARTEchoSet(false); // commands are taken as typed, by commandPoll
 }
 
 /** Initialisation of the clock and systick.  */
 void initClock(void)
 {
-    // Set the clock rate to 20 MHz
-    SysCtlClockSet(SYSCTL_SYSDIV_10 | SYSCTL_USE_PLL | SYSCTL_OSC_MAIN | SYSCTL_XTAL_16MHZ);
+    // Set the clock rate to SYS_CLOCK_HZ, 20 MHz
+    SysCtlClockSet(SYS_CLOCK_SYSDIV_CODE | SYSCTL_USE_PLL | SYSCTL_OSC_MAIN | SYSCTL_XTAL_16MHZ);
     clockRate = SysCtlClockGet();
     SysTickPeriodSet(clockRate / SYSTICK_RATE_HZ);
     SysTickIntRegister(SysTickIntHandler);
     SysTickIntEnable();
+
+    // Button events are posted from PendSV, pended by the button debounce timer
+    IntRegister(FAULT_PENDSV, PendSVIntHandler);
 }
 
-/** Sets the initial altitude to the current circular buffer mean if the left button has been pushed.
-    Cycles to the next altitude display mode if the up button has been pushed.  */
+/** Triggers an ADC conversion.  */
 void SysTickIntHandler(void)
 {
-    ADCProcessorTrigger(ADC0_BASE, 0);
-    // Checks buttons at a desired frequency
-    if (sysTickButtonCounter >= (SYSTICK_RATE_HZ/BUTTON_POLLING_RATE_HZ)) {
-        sysTickButtonCounter = 0;
-        updateButtons();
-        if (checkButton(LEFT) == PUSHED) {
-            desiredYaw -= DESIRED_YAW_STEP;
-            // Constrains yaw between half a rotation and negative half a rotation
-            if (desiredYaw > (FULL_ROTATION_DEG / 2)) {
-                desiredYaw -= FULL_ROTATION_DEG;
-            }
+    // SysTick counts down from its period, so the count shows how long ago it fired
+    intLatencyRecord(INT_SRC_SYSTICK, SysTickPeriodGet() - 1 - SysTickValueGet());
+    PROFILE_START(PROFILE_SYSTICK_ISR);
+    altTrigger();
+    PROFILE_END(PROFILE_SYSTICK_ISR);
+}
+
+/** Called from the button debounce timer interrupt when a button or switch has changed.
+    Pends the PendSV handler to post the change once every other interrupt has finished.  */
+void buttonsChanged(void)
+{
+    IntPendSet(FAULT_PENDSV);
+}
+
+/** Posts the button pushes and releases and any switch changes to the input event queue.  */
+void PendSVIntHandler(void)
+{
+    uint8_t but;
+
+    PROFILE_START(PROFILE_PENDSV_ISR);
+    for (but = UP; but <= RIGHT; but++) {
+        uint8_t state = checkButton(but);
+        if (state != NO_CHANGE) {
+            eventPost(&inputEvents, EVENT_BUTTON_CHANGED, but, state);
         }
-        if (checkButton(RIGHT) == PUSHED) {
-            desiredYaw += DESIRED_YAW_STEP;
-            // Constrains yaw between half a rotation and negative half a rotation
-            if (desiredYaw < (-(FULL_ROTATION_DEG / 2) - 1)) {
-                desiredYaw += FULL_ROTATION_DEG;
-            }
+    }
+    // Switches start in their state at start up, so only later changes are reported
+    for (but = SWITCH1; but <= RESET; but++) {
+        if (checkButton(but) != NO_CHANGE) {
+            eventPost(&inputEvents, EVENT_SWITCH_CHANGED, but, getState(but));
         }
-        if (checkButton(UP) == PUSHED) {
-            desiredAltitude = CONSTRAIN_PERCENT(desiredAltitude + DESIRED_ALT_STEP);
+    }
+    PROFILE_END(PROFILE_PENDSV_ISR);
+}
+
+#ifndef LQR_CONTROL
+/** Runs the inner rate loops of both rotors, then applies both duties, including
+    those the control task set while a rate loop is off.  */
+void rateLoopTask(void)
+{
+    double deltaT = (double)schedElapsed() / pacerGetTickRate(); // actual time since the last run
+
+    PROFILE_START(PROFILE_RATE_LOOPS);
+    mainRateLoopUpdate(deltaT);
+    tailRateLoopUpdate(deltaT);
+    PROFILE_END(PROFILE_RATE_LOOPS);
+    applyDuties();
+}
+
+/** Runs the inner climb rate loop of the cascaded main controller. Drives the main rotor
+    towards desiredClimbRate while mainRateLoopOn, adding climbFeedforward, starting from the
+    current main duty.
+    @param time since the last update in seconds.  */
+void mainRateLoopUpdate(double deltaT)
+{
+    double climbRate = getAltitudeRate();
+    double control;
+
+    if (mainRateLoopOn) {
+        // Rate loop takes over the disturbance compensation when the observer turns off
+        if ((!mainRateLoopWasOn) || (mainDobWasOn && !mainDobOn)) {
+            mainRatePiTransfer(desiredClimbRate, climbRate, PWM_DUTY_FROM_Q(mainDuty) - climbFeedforward);
         }
-        if (checkButton(DOWN) == PUSHED) {
-            desiredAltitude = CONSTRAIN_PERCENT(desiredAltitude - DESIRED_ALT_STEP);
+        // Cancels the estimated disturbance while flying, starting from a zero estimate.
+        // The PI constrains the compensated duty, so its integral sees the duty applied
+        if (mainDobOn && !mainDobWasOn) {
+            dobReset(DOB_TO_Q(PWM_DUTY_FROM_Q(mainDuty)), DOB_TO_Q(climbRate));
+            mainDisturbance = 0;
         }
-        bool sw1State = getState(SWITCH1);
-        if ((sw1State) && (curHeliMode == LANDED)) {
-            // Only launches if switch 1 has been off while program is running
-            if (canLaunch) {
-                curHeliMode = LAUNCHING;
-            }
-        } else if (!sw1State) {
-            canLaunch = true;
-            if (curHeliMode == FLYING) {
-                curHeliMode = LANDING;
-                desiredYaw = 0;
-            }
+        control = mainRatePiCompute(desiredClimbRate, climbRate,
+                                    climbFeedforward - (mainDobOn ? DOB_FROM_Q(mainDisturbance) : 0), deltaT);
+        if (mainDobOn) {
+            mainDisturbance = dobUpdate(DOB_TO_Q(control), DOB_TO_Q(climbRate));
         }
-        if (getState(RESET)) {
-            SysCtlReset();
+        mainDuty = PWM_DUTY_TO_Q(control);
+    }
+    mainRateLoopWasOn = mainRateLoopOn;
+    mainDobWasOn = mainDobOn && mainRateLoopOn;
+}
+
+/** Runs the inner yaw rate loop of the cascaded tail controller. Drives the tail rotor
+    towards desiredYawRate while tailRateLoopOn, starting from the current tail duty.
+    @param time since the last update in seconds.  */
+void tailRateLoopUpdate(double deltaT)
+{
+    double yawRate = getYawRate();
+
+    if (tailRateLoopOn) {
+        if (!tailRateLoopWasOn) {
+            tailRatePiTransfer(desiredYawRate, yawRate, PWM_DUTY_FROM_Q(tailDuty));
         }
+        tailDuty = PWM_DUTY_TO_Q(tailRatePiCompute(desiredYawRate, yawRate, deltaT));
     }
-    sysTickButtonCounter++;
-    dTCounter++; // increments timer to use as deltaT in PI control
+    tailRateLoopWasOn = tailRateLoopOn;
 }
+#endif
@@ -1,39 +1,96 @@
 /** @file   pacer.c
     @author Bailey Lissington, Dillon Pike, Joseph Ramirez
     @date   21 May 2021
-    @brief  Functions related to implementing a pacer loop.
+    @brief  Functions related to pacing the scheduler on the timebase.
 */
 
 // standard library includes
+#include <stdint.h>
 #include <stdbool.h>
 
 // library includes
 #include "pacer.h"
-#include "driverlib/sysctl.h"
-#include "driverlib/timer.h"
-#include "inc/hw_memmap.h"
-#include "inc/hw_types.h"
-#include "inc/hw_timer.h"
+#include "timebase.h"
+#include "driverlib/interrupt.h"
+#include "driverlib/cpu.h"
 
-static uint32_t pacerPeriod; // desired pacer period in timer increments
+#define PACER_MIN_SLEEP_US 20 // shortest wait worth sleeping for, covers the time to enter sleep
 
-/** Initialises the pacerPeriod and initialises TIMER0.  */
-void initPacer(uint16_t freq)
+static uint32_t pacerMinSleep; // PACER_MIN_SLEEP_US in timebase ticks
+
+// sleep statistics since the last reset
+static uint64_t statsStart; // full timebase ticks, so elapsed cannot wrap
+static uint64_t asleep;
+static uint32_t wakeups;
+static uint32_t latencyMax;
+static uint64_t latencyTotal;
+
+/** Initialises the pacer on the timebase, which must already be initialised.  */
+void initPacer(void)
 {
-    SysCtlPeripheralEnable(SYSCTL_PERIPH_TIMER0);
-    pacerPeriod = SysCtlClockGet() / freq;
+    pacerMinSleep = timebaseGetTickRate() / TIMEBASE_US_PER_S * PACER_MIN_SLEEP_US;
+    pacerResetSleepStats();
+}
 
-    while (!SysCtlPeripheralReady(SYSCTL_PERIPH_TIMER0));
+/** Returns the low 32 bits of the timebase, which wrap around every 2^32 ticks.  */
+uint32_t pacerGetTime(void)
+{
+    return timebaseGetCount();
+}
 
-    TimerConfigure(TIMER0_BASE, TIMER_CFG_ONE_SHOT_UP);
-    TimerEnable(TIMER0_BASE, TIMER_A);
+/** Returns the rate the timebase counts at.  */
+uint32_t pacerGetTickRate(void)
+{
+    return timebaseGetTickRate();
 }
 
-/** Waits until a time equal to pacerPeriod has elapsed since the last timer reset, then resets the timer.  */
-void pacerWait(void)
+/** Sleeps until the timebase reaches wakeTime or any interrupt occurs.  */
+void pacerSleepUntil(uint32_t wakeTime)
 {
-    while (TimerValueGet(TIMER0_BASE, TIMER_A) < pacerPeriod);
+    // Interrupts are masked so one arriving before the WFI still wakes it.
+    // Its handler then runs once they are unmasked
+    bool wasDisabled = IntMasterDisable();
+
+    timebaseSetMatch(wakeTime);
+    uint32_t start = pacerGetTime();
+
+    if ((int32_t)(wakeTime - start) > (int32_t)pacerMinSleep) {
+        CPUwfi();
+        uint32_t wake = pacerGetTime();
+        asleep += wake - start;
 
-    HWREG(TIMER0_BASE + TIMER_O_TBV) = 0;
-    HWREG(TIMER0_BASE + TIMER_O_TAV) = 0;
+        // Latency from the match to running again, when the match was the wake source
+        if (timebaseMatched()) {
+            uint32_t latency = wake - wakeTime;
+            wakeups++;
+            latencyTotal += latency;
+            if (latency > latencyMax) {
+                latencyMax = latency;
+            }
+        }
+    }
+
+    if (!wasDisabled) {
+        IntMasterEnable();
+    }
+}
+
+/** Returns the sleep statistics since they were last reset.  */
+void pacerGetSleepStats(pacerSleepStats_t* stats)
+{
+    stats->elapsed = timebaseGetTicks() - statsStart;
+    stats->asleep = asleep;
+    stats->wakeups = wakeups;
+    stats->latencyMax = latencyMax;
+    stats->latencyTotal = latencyTotal;
+}
+
+/** Clears the sleep statistics.  */
+void pacerResetSleepStats(void)
+{
+    statsStart = timebaseGetTicks();
+    asleep = 0;
+    wakeups = 0;
+    latencyMax = 0;
+    latencyTotal = 0;
 }
@@ -1,7 +1,7 @@
 /** @file   pacer.h
     @author Bailey Lissington, Dillon Pike, Joseph Ramirez
     @date   21 May 2021
-    @brief  Functions related to implementing a pacer loop.
+    @brief  Functions related to pacing the scheduler on the timebase.
 */
 
 #ifndef PACER_H_
@@ -9,10 +9,37 @@
 
 #include <stdint.h>
 
-/** Initialises the pacerPeriod and initialises TIMER0.  */
-void initPacer(uint16_t freq);
+// Sleep statistics since the last reset. Times are in timebase ticks, and 64 bit
+// so statistics left running past the 32 bit count's wrap, about 215 s, stay right
+typedef struct {
+    uint64_t elapsed; // time covered by the statistics
+    uint64_t asleep; // time spent asleep, elapsed minus this is the CPU load
+    uint32_t wakeups; // wakes by the timebase match rather than another interrupt
+    uint32_t latencyMax; // latency from the match to running again
+    uint64_t latencyTotal;
+} pacerSleepStats_t;
 
-/** Waits until a time equal to pacerPeriod has elapsed since the last timer reset, then resets the timer.  */
-void pacerWait(void);
+/** Initialises the pacer on the timebase, which must already be initialised.  */
+void initPacer(void);
+
+/** Returns the low 32 bits of the timebase, which wrap around every 2^32 ticks.
+    @return time in ticks.  */
+uint32_t pacerGetTime(void);
+
+/** Returns the rate the timebase counts at.
+    @return ticks per second.  */
+uint32_t pacerGetTickRate(void);
+
+/** Sleeps the processor with WFI until the timebase reaches wakeTime or any interrupt occurs,
+    whichever is first. Returns at once if wakeTime is too close to be worth sleeping for.
+    @param time to wake at in ticks.  */
+void pacerSleepUntil(uint32_t wakeTime);
+
+/** Returns the sleep statistics since they were last reset.
+    @param statistics to fill in.  */
+void pacerGetSleepStats(pacerSleepStats_t* stats);
+
+/** Clears the sleep statistics.  */
+void pacerResetSleepStats(void);
 
 #endif /* PACER_H_ */
@@ -9,58 +9,117 @@
 static double mainErrorIntegral = 0;
 static double tailErrorIntegral = 0;
 
-/** Calculates a PI control duty cycle to drive the main rotor based on a set and input altitude.  */
-double mainPiCompute(uint8_t setAltitude, int16_t inputAltitude, double deltaT)
+/** Constrains a control output between PI_MIN and PI_MAX.
+    @param unconstrained control output.
+    @return constrained control output.  */
+static double piConstrain(double control)
 {
-    double control;
-    double error = setAltitude - inputAltitude;
-    double deltaI = error * deltaT; // change in integral since last computation
-
-    control = error * MAIN_PI_KP + (mainErrorIntegral + deltaI) * MAIN_PI_KI;
-
-    // Constrains control between PI_MIN and PI_MAX
     if (control < PI_MIN) {
-        control = PI_MIN;
+        return PI_MIN;
     } else if (control > PI_MAX) {
-        control = PI_MAX;
-    } else {
-        mainErrorIntegral += deltaI; // adds to error integral if not constrained
+        return PI_MAX;
     }
-
     return control;
 }
 
-/** Calculates a PI control duty cycle to drive the tail rotor based on a set and input yaw.  */
-double tailPiCompute(double setPoint, double input, double deltaT)
+/** Calibrates a yaw error to the shortest signed difference between input and setPoint.
+    @param yaw error in degrees.
+    @return yaw error between half a rotation and negative half a rotation.  */
+static double yawError(double error)
 {
-    double control;
-    double error = setPoint - input;
-
-    // Calibrates error to the shortest signed difference between input and setPoint
-    // since input and setPoint are constrained between half a rotation and negative half
+    // input and setPoint are constrained between half a rotation and negative half
     // a rotation minus one and transitions from the min to the max when decreasing, and vice versa
     if (error < -(FULL_ROTATION_DEG / 2)) {
         error += FULL_ROTATION_DEG;
     } else if (error > (FULL_ROTATION_DEG / 2)) {
         error -= FULL_ROTATION_DEG;
     }
+    return error;
+}
+
+/** Calculates a climb rate command for the main rate loop based on a set and input altitude.
+    The outer altitude loop of the cascaded main controller.  */
+double mainAltitudeCompute(double setAltitude, double inputAltitude, double feedforwardRate)
+{
+    double rate = (setAltitude - inputAltitude) * MAIN_ALT_KP + feedforwardRate;
+
+    // Constrains rate between -ALT_MAX_DESCENT_RATE and ALT_MAX_CLIMB_RATE
+    if (rate < -ALT_MAX_DESCENT_RATE) {
+        rate = -ALT_MAX_DESCENT_RATE;
+    } else if (rate > ALT_MAX_CLIMB_RATE) {
+        rate = ALT_MAX_CLIMB_RATE;
+    }
+    return rate;
+}
 
-    double deltaI = error * deltaT; // change in integral since last computation
+/** Calculates a PI control duty cycle to drive the main rotor based on a set and input climb rate.
+    The inner rate loop of the cascaded main controller. compensation, e.g. the disturbance
+    observer's correction, is added before the duty is constrained so the integral unwinds
+    against the duty actually applied.  */
+double mainRatePiCompute(double setRate, double inputRate, double compensation, double deltaT)
+{
+    double error = setRate - inputRate;
+    double unconstrained = error * MAIN_RATE_KP + mainErrorIntegral * MAIN_RATE_KI + compensation;
+    double control = piConstrain(unconstrained);
 
-    control = error * TAIL_PI_KP + (tailErrorIntegral + deltaI) * TAIL_PI_KI;
+    // Back-calculation: feeds the saturation excess back into the integral so it
+    // unwinds at MAIN_RATE_KT instead of holding its value while saturated
+    mainErrorIntegral += (error + (control - unconstrained) * MAIN_RATE_KT / MAIN_RATE_KI) * deltaT;
 
-    // Constrains control between PI_MIN and PI_MAX
-    if (control < PI_MIN) {
-        control = PI_MIN;
-    } else if (control > PI_MAX) {
-        control = PI_MAX;
-    } else {
-        tailErrorIntegral += deltaI; // adds to error integral if not constrained
+    return control;
+}
+
+/** Calculates the main thrust feedforward for a reference climb rate and acceleration,
+    passed to mainRatePiCompute as compensation.  */
+double mainRateFeedforward(double climbRate, double climbAccel)
+{
+    return climbRate * MAIN_RATE_KFF_RATE + climbAccel * MAIN_RATE_KFF_ACCEL;
+}
+
+/** Calculates a yaw rate command for the tail rate loop based on a set and input yaw.
+    The outer angle loop of the cascaded tail controller.  */
+double tailAngleCompute(double setPoint, double input, double feedforwardRate)
+{
+    double rate = yawError(setPoint - input) * TAIL_ANGLE_KP + feedforwardRate;
+
+    // Constrains rate between -TAIL_MAX_YAW_RATE and TAIL_MAX_YAW_RATE
+    if (rate < -TAIL_MAX_YAW_RATE) {
+        rate = -TAIL_MAX_YAW_RATE;
+    } else if (rate > TAIL_MAX_YAW_RATE) {
+        rate = TAIL_MAX_YAW_RATE;
     }
+    return rate;
+}
+
+/** Calculates a PI control duty cycle to drive the tail rotor based on a set and input yaw rate.
+    The inner rate loop of the cascaded tail controller.  */
+double tailRatePiCompute(double setRate, double inputRate, double deltaT)
+{
+    double error = setRate - inputRate;
+    double unconstrained = error * TAIL_RATE_KP + tailErrorIntegral * TAIL_RATE_KI;
+    double control = piConstrain(unconstrained);
+
+    // Back-calculation: feeds the saturation excess back into the integral so it
+    // unwinds at TAIL_RATE_KT instead of holding its value while saturated
+    tailErrorIntegral += (error + (control - unconstrained) * TAIL_RATE_KT / TAIL_RATE_KI) * deltaT;
 
     return control;
 }
 
+/** Initialises the main rate error integral so the next output continues from currentDuty.  */
+void mainRatePiTransfer(double setRate, double inputRate, double currentDuty)
+{
+    double error = setRate - inputRate;
+    mainErrorIntegral = (piConstrain(currentDuty) - error * MAIN_RATE_KP) / MAIN_RATE_KI;
+}
+
+/** Initialises the tail rate error integral so the next output continues from currentDuty.  */
+void tailRatePiTransfer(double setRate, double inputRate, double currentDuty)
+{
+    double error = setRate - inputRate;
+    tailErrorIntegral = (piConstrain(currentDuty) - error * TAIL_RATE_KP) / TAIL_RATE_KI;
+}
+
 /** Sets main and tail error integrals to 0.  */
 void resetErrorIntegrals(void)
 {
@@ -9,12 +9,35 @@
 
 #include <stdint.h>
 
-// Proportional and integral coefficients for main and tail rotor PI control
-#define MAIN_PI_KP 0.6
-#define MAIN_PI_KI 0.4
+// Proportional and integral coefficients for main and tail rotor PI control.
+// Cascaded main control: the altitude loop commands a climb rate (% per s per %)
+// and the rate loop drives the main thrust command (% per % per s), which actuatorShape
+// turns into the main duty cycle so the gains hold across the thrust curve
+#define MAIN_ALT_KP 2.0
+#define MAIN_RATE_KP 0.3
+#define MAIN_RATE_KI 0.6
+#define ALT_MAX_CLIMB_RATE 30.0 // maximum climb rate commanded by the altitude loop in % per s
+#define ALT_MAX_DESCENT_RATE 10.0 // maximum descent rate commanded by the altitude loop in % per s
 
-#define TAIL_PI_KP 0.43
-#define TAIL_PI_KI 0.25
+// Feedforward of the altitude reference's climb rate (% per % per s) and acceleration
+// (% per % per s^2) into the main thrust, the identified model's rate time constant and
+// gain inverted, so the rate loop only corrects the model's error and the heli keeps up
+// with the trajectory instead of lagging and overshooting it
+#define MAIN_RATE_KFF_RATE 0.42 // 1 / (3.0 %/s^2 per % * 0.8 s)
+#define MAIN_RATE_KFF_ACCEL 0.33 // 1 / 3.0 %/s^2 per %
+
+// Cascaded tail control: the angle loop commands a yaw rate (degrees per s per degree)
+// and the rate loop drives the tail thrust command (% per degree per s)
+#define TAIL_ANGLE_KP 2.0
+#define TAIL_RATE_KP 0.2
+#define TAIL_RATE_KI 0.5
+#define TAIL_MAX_YAW_RATE 90.0 // maximum yaw rate commanded by the angle loop in degrees per s
+
+// Back-calculation tracking gains (1/s) for unwinding the error integrals while saturated.
+// A 40 ms tracking time constant, 4 rate loop periods, holds the unconstrained output near
+// the limit so the loop leaves saturation as soon as the error falls
+#define MAIN_RATE_KT 25.0
+#define TAIL_RATE_KT 25.0
 
 // Max and min duty cycles
 #define PI_MAX 98
@@ -22,11 +45,33 @@
 
 #define FULL_ROTATION_DEG 360 // degrees of a full rotation
 
-/** Calculates a PI control duty cycle to drive the main rotor based on a set and input altitude.  */
-double mainPiCompute(uint8_t setPoint, int16_t input, double deltaT);
+/** Calculates a climb rate command for the main rate loop based on a set and input altitude.
+    The outer altitude loop of the cascaded main controller.  */
+double mainAltitudeCompute(double setAltitude, double inputAltitude, double feedforwardRate);
+
+/** Calculates a PI control duty cycle to drive the main rotor based on a set and input climb rate.
+    The inner rate loop of the cascaded main controller. compensation, e.g. the disturbance
+    observer's correction, is added before the duty is constrained so the integral unwinds
+    against the duty actually applied.  */
+double mainRatePiCompute(double setRate, double inputRate, double compensation, double deltaT);
+
+/** Calculates the main thrust feedforward for a reference climb rate and acceleration,
+    passed to mainRatePiCompute as compensation.  */
+double mainRateFeedforward(double climbRate, double climbAccel);
+
+/** Calculates a yaw rate command for the tail rate loop based on a set and input yaw.
+    The outer angle loop of the cascaded tail controller.  */
+double tailAngleCompute(double setPoint, double input, double feedforwardRate);
+
+/** Calculates a PI control duty cycle to drive the tail rotor based on a set and input yaw rate.
+    The inner rate loop of the cascaded tail controller.  */
+double tailRatePiCompute(double setRate, double inputRate, double deltaT);
+
+/** Initialises the main rate error integral so the next output continues from currentDuty.  */
+void mainRatePiTransfer(double setRate, double inputRate, double currentDuty);
 
-/** Calculates a PI control duty cycle to drive the tail rotor based on a set and input yaw.  */
-double tailPiCompute(double setPoint, double input, double deltaT);
+/** Initialises the tail rate error integral so the next output continues from currentDuty.  */
+void tailRatePiTransfer(double setRate, double inputRate, double currentDuty);
 
 /** Sets main and tail error integrals to 0.  */
 void resetErrorIntegrals(void);
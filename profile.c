@@ -0,0 +1,152 @@
+/** @file   profile.c
+    @author Bailey Lissington, Dillon Pike, Joseph Ramirez
+    @date   21 May 2021
+    @brief  Functions related to profiling the execution time of code sections.
+*/
+
+#ifdef HOST_BUILD
+#define _POSIX_C_SOURCE 199309L // clock_gettime, before any system header
+#endif
+
+#include "profile.h"
+
+#ifdef PROFILING
+
+// standard library includes
+#include <stdint.h>
+#include <stdbool.h>
+
+// library includes
+#ifdef HOST_BUILD
+#include <stdio.h>
+#include <time.h>
+#define PROFILE_PRINTF printf
+#define PROFILE_TICKS_PER_US 1000 // nanosecond ticks
+#else
+#include "inc/hw_types.h"
+#include "driverlib/sysctl.h"
+#include "driverlib/interrupt.h"
+#include "utils/uartstdio.h"
+#define PROFILE_PRINTF UARTprintf
+#define PROFILE_TICKS_PER_US (SysCtlClockGet() / 1000000)
+
+// Cortex-M4 debug registers for the DWT cycle counter
+#define DEMCR 0xE000EDFC // Debug Exception and Monitor Control Register
+#define DEMCR_TRCENA 0x01000000 // enables the DWT unit
+#define DWT_CTRL 0xE0001000
+#define DWT_CTRL_CYCCNTENA 0x00000001
+#define DWT_CYCCNT 0xE0001004
+#endif
+
+static const char* probeNames[PROFILE_NUM_PROBES] = {
+    "SysTick ISR", "PendSV ISR", "ADC ISR", "Yaw ISR", "Rate loops", "altRead", "Control", "setPWMDuty", "Serial", "OLED"
+};
+
+typedef struct {
+    uint32_t count;
+    uint32_t min;
+    uint32_t max;
+    uint64_t total;
+    uint32_t hist[PROFILE_HIST_BINS];
+} profileStats_t;
+
+static profileStats_t stats[PROFILE_NUM_PROBES];
+static uint32_t ticksPerUs;
+
+/** Clears the statistics of every probe.  */
+static void profileClear(void)
+{
+    for (uint8_t i = 0; i < PROFILE_NUM_PROBES; i++) {
+        stats[i].count = 0;
+        stats[i].min = UINT32_MAX;
+        stats[i].max = 0;
+        stats[i].total = 0;
+        for (uint8_t bin = 0; bin < PROFILE_HIST_BINS; bin++) {
+            stats[i].hist[bin] = 0;
+        }
+    }
+}
+
+/** Enables the cycle counter and clears the statistics.  */
+void profileInit(void)
+{
+    #ifndef HOST_BUILD
+    HWREG(DEMCR) |= DEMCR_TRCENA;
+    HWREG(DWT_CYCCNT) = 0;
+    HWREG(DWT_CTRL) |= DWT_CTRL_CYCCNTENA;
+    #endif
+    ticksPerUs = PROFILE_TICKS_PER_US;
+    profileClear();
+}
+
+/** Returns the current cycle count, or nanoseconds in a host build.  */
+uint32_t profileNow(void)
+{
+    #ifdef HOST_BUILD
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint32_t)((uint64_t)now.tv_sec * 1000000000 + now.tv_nsec);
+    #else
+    return HWREG(DWT_CYCCNT);
+    #endif
+}
+
+/** Records one execution of a probed section.  */
+void profileRecord(profileProbe_t probe, uint32_t ticks)
+{
+    profileStats_t* probeStats = &stats[probe];
+
+    probeStats->count++;
+    probeStats->total += ticks;
+    if (ticks < probeStats->min) {
+        probeStats->min = ticks;
+    }
+    if (ticks > probeStats->max) {
+        probeStats->max = ticks;
+    }
+
+    // Bin k holds times under 2^k us, the last bin everything longer
+    uint32_t us = ticks / ticksPerUs;
+    uint8_t bin = 0;
+    while ((us > 0) && (bin < (PROFILE_HIST_BINS - 1))) {
+        us >>= 1;
+        bin++;
+    }
+    probeStats->hist[bin]++;
+}
+
+/** Prints the count, min/mean/max time, worst case in ticks and histogram of each probe that ran, then clears them.  */
+void profileReport(void)
+{
+    profileStats_t copy[PROFILE_NUM_PROBES];
+
+    // Takes a consistent copy, as the interrupt probes record at any time
+    #ifndef HOST_BUILD
+    bool wasDisabled = IntMasterDisable();
+    #endif
+    for (uint8_t i = 0; i < PROFILE_NUM_PROBES; i++) {
+        copy[i] = stats[i];
+    }
+    profileClear();
+    #ifndef HOST_BUILD
+    if (!wasDisabled) {
+        IntMasterEnable();
+    }
+    #endif
+
+    PROFILE_PRINTF("Profile (us): count min/mean/max (max ticks) | <1 <2 <4 <8 <16 <32 <64 >=64\n");
+    for (uint8_t i = 0; i < PROFILE_NUM_PROBES; i++) {
+        profileStats_t* s = &copy[i];
+        if (s->count == 0) {
+            continue;
+        }
+        PROFILE_PRINTF("%s: %u %u/%u/%u (%u) |", probeNames[i], s->count, s->min / ticksPerUs,
+                       (uint32_t)(s->total / s->count) / ticksPerUs, s->max / ticksPerUs, s->max);
+        for (uint8_t bin = 0; bin < PROFILE_HIST_BINS; bin++) {
+            PROFILE_PRINTF(" %u", s->hist[bin]);
+        }
+        PROFILE_PRINTF("\n");
+    }
+}
+
+#endif /* PROFILING */
@@ -0,0 +1,65 @@
+/** @file   profile.h
+    @author Bailey Lissington, Dillon Pike, Joseph Ramirez
+    @date   21 May 2021
+    @brief  Functions related to profiling the execution time of code sections.
+            Probes compile to nothing unless PROFILING is defined. On the target they
+            count cycles with the DWT cycle counter, and in a HOST_BUILD they use clock_gettime.
+*/
+
+#ifndef PROFILE_H_
+#define PROFILE_H_
+
+#include <stdint.h>
+
+// RUNNING MODE. UNCOMMENT TO ENABLE
+//#define PROFILING // Measures the probed sections and reports them via serial
+
+#define PROFILE_HIST_BINS 8 // execution time histogram bins: <1, <2, <4 ... <64, >=64 us
+#define PROFILE_REPORT_HZ 1 // rate the statistics are reported and cleared at
+
+// Probed code sections
+typedef enum {
+    PROFILE_SYSTICK_ISR = 0,
+    PROFILE_PENDSV_ISR,
+    PROFILE_ADC_ISR,
+    PROFILE_YAW_ISR,
+    PROFILE_RATE_LOOPS,
+    PROFILE_ALT_READ,
+    PROFILE_CONTROL,
+    PROFILE_PWM,
+    PROFILE_SERIAL,
+    PROFILE_OLED,
+    PROFILE_NUM_PROBES
+} profileProbe_t;
+
+#ifdef PROFILING
+
+/** Starts a probe. Must be matched by PROFILE_END with the same probe in the same scope.  */
+#define PROFILE_START(probe) uint32_t profileStart_##probe = profileNow()
+
+/** Ends a probe and records the time since the matching PROFILE_START.  */
+#define PROFILE_END(probe) profileRecord((probe), profileNow() - profileStart_##probe)
+
+/** Enables the cycle counter and clears the statistics.  */
+void profileInit(void);
+
+/** Returns the current cycle count, or nanoseconds in a host build.
+    @return time in profiler ticks, wrapping at 2^32.  */
+uint32_t profileNow(void);
+
+/** Records one execution of a probed section.
+    @param probe the time belongs to.
+    @param execution time in profiler ticks.  */
+void profileRecord(profileProbe_t probe, uint32_t ticks);
+
+/** Prints the count, min/mean/max time, worst case in ticks and histogram of each probe that ran, then clears them.  */
+void profileReport(void);
+
+#else
+
+#define PROFILE_START(probe)
+#define PROFILE_END(probe)
+
+#endif /* PROFILING */
+
+#endif /* PROFILE_H_ */
@@ -13,6 +13,7 @@
 #include <stdbool.h>
 #include "inc/hw_memmap.h"
 #include "inc/hw_types.h"
+#include "inc/hw_pwm.h"
 #include "driverlib/pin_map.h" //Needed for pin configure
 #include "driverlib/debug.h"
 #include "driverlib/gpio.h"
@@ -21,6 +22,7 @@
 #include "driverlib/interrupt.h"
 #include "buttons4.h"
 #include "OrbitOLED/OrbitOLEDInterface.h" // Obtained from mdp46
+#include "clock.h"
 #include "pwm.h"
 
 /**********************************************************
@@ -28,19 +30,28 @@
  **********************************************************/
 
 // PWM configuration
-#define PWM_FIXED_HZ       250
+#define PWM_START_HZ       250 // frequency of both rotors at start up
+#define PWM_MAX_HZ         10000 // keeps duty steps at or below 0.1% at PWM_DIVIDER 1
 #define PWM_START_DUTY     60
 #define PWM_TAIL_DUTY      10
 #define PWM_DUTY_STEP      5
-#define PWM_DUTY_MIN       2
-#define PWM_DUTY_MAX       98
-#define PWM_DIVIDER_CODE   SYSCTL_PWMDIV_4
-#define PWM_DIVIDER        4
+#define PWM_DIVIDER        1  // 1, 2, 4, 8, 16, 32 or 64. Smaller gives finer duty steps
+#define PWM_DIVIDER_CODE   PWM_DIVIDER_TO_CODE(PWM_DIVIDER)
+#define PWM_MAX_PERIOD     131070 // 16-bit load register holds half the up/down period
+
+#define PWM_DIVIDER_TO_CODE(div)  PWM_DIVIDER_TO_CODE_(div)
+#define PWM_DIVIDER_TO_CODE_(div) SYSCTL_PWMDIV_ ## div
+
+#if (SYS_CLOCK_HZ / PWM_DIVIDER / PWM_START_HZ) > PWM_MAX_PERIOD
+#error "PWM period does not fit the generator load register, increase PWM_DIVIDER"
+#endif
 
 //  PWM Hardware Details M0PWM7 (gen 3)
 //  ---Main Rotor PWM: PC5, J4-05
 #define PWM_MAIN_BASE        PWM0_BASE
 #define PWM_MAIN_GEN         PWM_GEN_3
+#define PWM_MAIN_GENBIT      PWM_GEN_3_BIT
+#define PWM_MAIN_CMP_REG     (PWM_MAIN_BASE + PWM_O_3_CMPB)
 #define PWM_MAIN_OUTNUM      PWM_OUT_7
 #define PWM_MAIN_OUTBIT      PWM_OUT_7_BIT
 #define PWM_MAIN_PERIPH_PWM  SYSCTL_PERIPH_PWM0
@@ -53,6 +64,8 @@
 //  ---Tail Rotor PWM: PF1,
 #define PWM_TAIL_BASE        PWM1_BASE
 #define PWM_TAIL_GEN         PWM_GEN_2
+#define PWM_TAIL_GENBIT      PWM_GEN_2_BIT
+#define PWM_TAIL_CMP_REG     (PWM_TAIL_BASE + PWM_O_2_CMPB)
 #define PWM_TAIL_OUTNUM      PWM_OUT_5
 #define PWM_TAIL_OUTBIT      PWM_OUT_5_BIT
 #define PWM_TAIL_PERIPH_PWM  SYSCTL_PERIPH_PWM1
@@ -61,14 +74,56 @@
 #define PWM_TAIL_GPIO_CONFIG GPIO_PF1_M1PWM5
 #define PWM_TAIL_GPIO_PIN    GPIO_PIN_1
 
+/**********************************************************
+ * Variables
+ **********************************************************/
+
+// Both generators count up/down, so the load value is half the period.
+// Cached whenever a rotor's frequency is set so a duty update is one
+// compare register write. Indexed by rotor.
+static uint32_t pwmClockHz;
+static uint32_t pwmPeriod[2];
+static uint32_t pwmLoad[2];
+static uint32_t pwmDutyScale[2]; // half-period counts per Q16 percent, scaled by 2^32
+static uint32_t pwmDuty[2]; // last duty set, in Q16 percent
+
+/***********************************************************
+ * Caches the period of a rotor for the given frequency.
+ * Returns false if the period does not fit the generator.
+ ***********************************************************/
+static bool
+pwmCachePeriod (rotor chosenRotor, uint32_t freqHz)
+{
+    uint32_t period;
+
+    if ((freqHz == 0) || (freqHz > PWM_MAX_HZ)) {
+        return false;
+    }
+    period = pwmClockHz / freqHz;
+    if (period > PWM_MAX_PERIOD) {
+        return false;
+    }
+
+    pwmPeriod[chosenRotor] = period;
+    pwmLoad[chosenRotor] = period / 2;
+    pwmDutyScale[chosenRotor] = (pwmLoad[chosenRotor] << 16) / 100;
+    return true;
+}
+
 /***********************************************************
  * Initialisation function for PWM Clock.
+ * Also computes the start up period of both rotors.
  ***********************************************************/
 void
 initPWMClock (void)
 {
     // Set the PWM clock rate (using the prescaler)
     SysCtlPWMClockSet(PWM_DIVIDER_CODE);
+
+    // Calculate the PWM period corresponding to the freq.
+    pwmClockHz = SysCtlClockGet() / PWM_DIVIDER;
+    pwmCachePeriod(MAIN, PWM_START_HZ);
+    pwmCachePeriod(TAIL, PWM_START_HZ);
 }
 
 /*********************************************************
@@ -85,10 +140,14 @@ initialisePWM (void)
     GPIOPinConfigure(PWM_MAIN_GPIO_CONFIG);
     GPIOPinTypePWM(PWM_MAIN_GPIO_BASE, PWM_MAIN_GPIO_PIN);
 
+    // Compare and load updates are held until committed with PWMSyncUpdate
     PWMGenConfigure(PWM_MAIN_BASE, PWM_MAIN_GEN,
-                    PWM_GEN_MODE_UP_DOWN | PWM_GEN_MODE_NO_SYNC);
+                    PWM_GEN_MODE_UP_DOWN | PWM_GEN_MODE_SYNC);
     // Set the initial PWM parameters
-    setPWMDuty(PWM_START_DUTY, MAIN);
+    PWMGenPeriodSet(PWM_MAIN_BASE, PWM_MAIN_GEN, pwmPeriod[MAIN]);
+    setPWMDuty(PWM_DUTY_TO_Q(PWM_START_DUTY), MAIN);
+
+    PWMSyncUpdate(PWM_MAIN_BASE, PWM_MAIN_GENBIT);
 
     PWMGenEnable(PWM_MAIN_BASE, PWM_MAIN_GEN);
 
@@ -110,10 +169,14 @@ initialisePWMTail (void)
     GPIOPinConfigure(PWM_TAIL_GPIO_CONFIG);
     GPIOPinTypePWM(PWM_TAIL_GPIO_BASE, PWM_TAIL_GPIO_PIN);
 
+    // Compare and load updates are held until committed with PWMSyncUpdate
     PWMGenConfigure(PWM_TAIL_BASE, PWM_TAIL_GEN,
-                    PWM_GEN_MODE_UP_DOWN | PWM_GEN_MODE_NO_SYNC);
+                    PWM_GEN_MODE_UP_DOWN | PWM_GEN_MODE_SYNC);
     // Set the initial PWM parameters
-    setPWMDuty(PWM_TAIL_DUTY, TAIL);
+    PWMGenPeriodSet(PWM_TAIL_BASE, PWM_TAIL_GEN, pwmPeriod[TAIL]);
+    setPWMDuty(PWM_DUTY_TO_Q(PWM_TAIL_DUTY), TAIL);
+
+    PWMSyncUpdate(PWM_TAIL_BASE, PWM_TAIL_GENBIT);
 
     PWMGenEnable(PWM_TAIL_BASE, PWM_TAIL_GEN);
 
@@ -124,21 +187,73 @@ initialisePWMTail (void)
 /********************************************************
  * Function to set the duty cycle of M0PWM7.
  * Modified to also set duty cycle of M1PWM5.
+ * Duty is a Q16 percentage (see PWM_DUTY_TO_Q). Matches
+ * PWMPulseWidthSet in up/down mode, using the cached period.
+ * The new duty is only staged until pwmCommit is called.
  ********************************************************/
 void
-setPWMDuty (double duty, rotor chosenRotor)
+setPWMDuty (uint32_t dutyQ, rotor chosenRotor)
 {
-    // Calculate the PWM period corresponding to the freq.
-    uint32_t ui32Period =
-        SysCtlClockGet() / PWM_DIVIDER / PWM_FIXED_HZ;
+    uint32_t load = pwmLoad[chosenRotor];
+    uint32_t halfWidth = (uint32_t)(((uint64_t)dutyQ * pwmDutyScale[chosenRotor]) >> 32);
+
+    if (halfWidth > load) {
+        halfWidth = load;
+    }
+    pwmDuty[chosenRotor] = dutyQ;
 
     if (chosenRotor == MAIN) {
-        PWMGenPeriodSet(PWM_MAIN_BASE, PWM_MAIN_GEN, ui32Period);
-        PWMPulseWidthSet(PWM_MAIN_BASE, PWM_MAIN_OUTNUM,
-                         (uint32_t)(ui32Period * duty / 100));
+        HWREG(PWM_MAIN_CMP_REG) = load - halfWidth;
     } else {
-        PWMGenPeriodSet(PWM_TAIL_BASE, PWM_TAIL_GEN, ui32Period);
-        PWMPulseWidthSet(PWM_TAIL_BASE, PWM_TAIL_OUTNUM,
-                         (uint32_t)(ui32Period * duty / 100));
+        HWREG(PWM_TAIL_CMP_REG) = load - halfWidth;
+    }
+}
+
+/********************************************************
+ * Commits the staged duty cycles of both rotors. Each
+ * generator applies them at its next period boundary
+ * (counter zero). The rotors are on separate PWM modules,
+ * so the two modules are triggered back to back.
+ ********************************************************/
+void
+pwmCommit (void)
+{
+    PWMSyncUpdate(PWM_MAIN_BASE, PWM_MAIN_GENBIT);
+    PWMSyncUpdate(PWM_TAIL_BASE, PWM_TAIL_GENBIT);
+}
+
+/********************************************************
+ * Changes the PWM frequency of one rotor, keeping its
+ * duty cycle. The new period and the matching compare
+ * value are committed together, so the change happens
+ * cleanly at the next period boundary. Returns false
+ * and leaves the rotor unchanged if freqHz is out of range.
+ ********************************************************/
+bool
+setPWMFrequency (rotor chosenRotor, uint32_t freqHz)
+{
+    // Called from the telemetry task. The duties are only written by
+    // applyDuties in another task, so nothing can write a compare
+    // value between the period and compare updates here
+    bool valid = pwmCachePeriod(chosenRotor, freqHz);
+
+    if (valid) {
+        if (chosenRotor == MAIN) {
+            PWMGenPeriodSet(PWM_MAIN_BASE, PWM_MAIN_GEN, pwmPeriod[MAIN]);
+        } else {
+            PWMGenPeriodSet(PWM_TAIL_BASE, PWM_TAIL_GEN, pwmPeriod[TAIL]);
+        }
+        setPWMDuty(pwmDuty[chosenRotor], chosenRotor);
+        pwmCommit();
     }
+    return valid;
+}
+
+/********************************************************
+ * Returns the PWM frequency of a rotor in Hz.
+ ********************************************************/
+uint32_t
+getPWMFrequency (rotor chosenRotor)
+{
+    return pwmClockHz / pwmPeriod[chosenRotor];
 }
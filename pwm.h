@@ -12,10 +12,23 @@
 #ifndef PWM_H_
 #define PWM_H_
 
+#include <stdint.h>
+#include <stdbool.h>
+
 typedef enum {MAIN = 0, TAIL} rotor; // rotor enumerator
 
+// Duty cycles are passed as Q16 fixed-point percentages
+#define PWM_DUTY_Q_BITS 16
+#define PWM_DUTY_TO_Q(pct) ((uint32_t)((pct) * (1UL << PWM_DUTY_Q_BITS)))
+#define PWM_DUTY_FROM_Q(q) ((double)(q) / (1UL << PWM_DUTY_Q_BITS))
+#define PWM_DUTY_WHOLE(q) ((q) >> PWM_DUTY_Q_BITS) // whole percent part of a Q16 duty
+#define PWM_DUTY_MIN 2 // limits of the duty applied to either rotor in %
+#define PWM_DUTY_MAX 98
+#define PWM_DUTY_TENTHS(q) ((((q) & ((1UL << PWM_DUTY_Q_BITS) - 1)) * 10) >> PWM_DUTY_Q_BITS) // tenths of a percent part
+
 /***********************************************************
  * Initialisation function for PWM Clock.
+ * Must be called before initialisePWM and initialisePWMTail.
  ***********************************************************/
 void initPWMClock (void);
 
@@ -35,7 +48,28 @@ void initialisePWMTail (void);
 /********************************************************
  * Function to set the duty cycle of M0PWM7.
  * Modified to also set duty cycle of M1PWM5.
+ * dutyQ is a Q16 percentage; one compare register write.
+ * The new duty is only staged until pwmCommit is called.
+ ********************************************************/
+void setPWMDuty (uint32_t dutyQ, rotor chosenRotor);
+
+/********************************************************
+ * Commits the staged duty cycles of both rotors, which
+ * take effect at the next PWM period boundary.
+ ********************************************************/
+void pwmCommit (void);
+
+/********************************************************
+ * Changes the PWM frequency of one rotor at runtime,
+ * keeping its duty cycle. Takes effect at the next
+ * period boundary. Returns false if freqHz is out of
+ * range for the PWM clock.
+ ********************************************************/
+bool setPWMFrequency (rotor chosenRotor, uint32_t freqHz);
+
+/********************************************************
+ * Returns the PWM frequency of a rotor in Hz.
  ********************************************************/
-void setPWMDuty (double duty, rotor chosenRotor);
+uint32_t getPWMFrequency (rotor chosenRotor);
 
 #endif /* PWM_H_ */
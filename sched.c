@@ -0,0 +1,163 @@
+/** @file   sched.c
+    @author Bailey Lissington, Dillon Pike, Joseph Ramirez
+    @date   21 May 2021
+    @brief  Functions related to the cooperative multi-rate task scheduler.
+*/
+
+// standard library includes
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// library includes
+#include "sched.h"
+
+// Macro function definition
+#define IS_DUE(now, release) ((int32_t)((now) - (release)) >= 0) // wrap-safe comparison of times
+
+static schedTask_t tasks[SCHED_MAX_TASKS]; // kept sorted by priority
+static uint8_t taskCount = 0;
+static uint32_t (*schedGetTime)(void);
+static uint32_t elapsed; // schedElapsed of the running task
+
+/** Clears the statistics of one task.  */
+static void resetTaskStats(schedTask_t* task)
+{
+    task->runs = 0;
+    task->minExec = UINT32_MAX;
+    task->maxExec = 0;
+    task->totalExec = 0;
+    task->maxLateness = 0;
+    task->overruns = 0;
+    task->maxOverrun = 0;
+    task->totalOverrun = 0;
+    task->skipped = 0;
+}
+
+/** Removes all tasks and sets the timebase the scheduler runs from.  */
+void schedInit(uint32_t (*getTime)(void))
+{
+    schedGetTime = getTime;
+    taskCount = 0;
+}
+
+/** Adds a periodic task, first released immediately.  */
+bool schedAddTask(const char* name, void (*run)(void), uint32_t period, uint8_t priority)
+{
+    if (taskCount >= SCHED_MAX_TASKS) {
+        return false;
+    }
+
+    // Inserts after any tasks of the same or higher priority
+    uint8_t i = taskCount;
+    while ((i > 0) && (tasks[i - 1].priority > priority)) {
+        tasks[i] = tasks[i - 1];
+        i--;
+    }
+    tasks[i].name = name;
+    tasks[i].run = run;
+    tasks[i].period = period;
+    tasks[i].priority = priority;
+    tasks[i].nextRelease = schedGetTime();
+    tasks[i].started = false;
+    resetTaskStats(&tasks[i]);
+    taskCount++;
+
+    return true;
+}
+
+/** Runs the highest priority task that is due, if any.  */
+bool schedRunNext(void)
+{
+    uint32_t now = schedGetTime();
+
+    for (uint8_t i = 0; i < taskCount; i++) {
+        schedTask_t* task = &tasks[i];
+
+        if (IS_DUE(now, task->nextRelease)) {
+            elapsed = task->started ? (now - task->lastStart) : task->period;
+            task->lastStart = now;
+            task->started = true;
+
+            task->run();
+            uint32_t end = schedGetTime();
+
+            uint32_t exec = end - now;
+            task->runs++;
+            task->totalExec += exec;
+            if (exec < task->minExec) {
+                task->minExec = exec;
+            }
+            if (exec > task->maxExec) {
+                task->maxExec = exec;
+            }
+            uint32_t lateness = now - task->nextRelease;
+            if (lateness > task->maxLateness) {
+                task->maxLateness = lateness;
+            }
+
+            // Next release stays on the period grid, so it is also this run's deadline
+            task->nextRelease += task->period;
+            if (IS_DUE(end, task->nextRelease)) {
+                uint32_t overrun = end - task->nextRelease;
+                task->overruns++;
+                task->totalOverrun += overrun;
+                if (overrun > task->maxOverrun) {
+                    task->maxOverrun = overrun;
+                }
+                // Runs once more to catch up, dropping any releases beyond that
+                while (IS_DUE(end, task->nextRelease + task->period)) {
+                    task->nextRelease += task->period;
+                    task->skipped++;
+                }
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
+/** Returns the time between the start of the running task and its previous start.  */
+uint32_t schedElapsed(void)
+{
+    return elapsed;
+}
+
+/** Returns the time the next task is due at, for sleeping until then.  */
+uint32_t schedNextRelease(void)
+{
+    if (taskCount == 0) {
+        return schedGetTime();
+    }
+
+    uint32_t earliest = tasks[0].nextRelease;
+    for (uint8_t i = 1; i < taskCount; i++) {
+        if ((int32_t)(tasks[i].nextRelease - earliest) < 0) {
+            earliest = tasks[i].nextRelease;
+        }
+    }
+    return earliest;
+}
+
+/** Returns the number of tasks added.  */
+uint8_t schedTaskCount(void)
+{
+    return taskCount;
+}
+
+/** Returns a task and its statistics.  */
+const schedTask_t* schedGetTask(uint8_t index)
+{
+    if (index >= taskCount) {
+        return NULL;
+    }
+    return &tasks[index];
+}
+
+/** Clears the execution, lateness and overrun statistics of all tasks.  */
+void schedResetStats(void)
+{
+    for (uint8_t i = 0; i < taskCount; i++) {
+        resetTaskStats(&tasks[i]);
+    }
+}
@@ -0,0 +1,77 @@
+/** @file   sched.h
+    @author Bailey Lissington, Dillon Pike, Joseph Ramirez
+    @date   21 May 2021
+    @brief  Functions related to the cooperative multi-rate task scheduler.
+            The scheduler only sees time through the function given to schedInit,
+            so it has no hardware dependencies.
+*/
+
+#ifndef SCHED_H_
+#define SCHED_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define SCHED_MAX_TASKS 8 // maximum number of tasks that can be added
+
+// A periodic task and its execution statistics. Times are in timebase ticks.
+typedef struct {
+    const char* name;
+    void (*run)(void);
+    uint32_t period;
+    uint8_t priority; // 0 is the highest. Runs first when several tasks are due
+    uint32_t nextRelease; // time the task is next due at
+    uint32_t lastStart; // time the task last started running
+    bool started; // has the task run since it was added?
+    uint32_t runs;
+    uint32_t minExec;
+    uint32_t maxExec;
+    uint64_t totalExec;
+    uint32_t maxLateness; // longest wait from a release to starting
+    uint32_t overruns; // runs that finished after their next release (their deadline)
+    uint32_t maxOverrun; // furthest a run finished past its deadline
+    uint64_t totalOverrun;
+    uint32_t skipped; // releases dropped because the task fell more than a period behind
+} schedTask_t;
+
+/** Removes all tasks and sets the timebase the scheduler runs from.
+    @param function returning the current time in ticks. May wrap around at 2^32.  */
+void schedInit(uint32_t (*getTime)(void));
+
+/** Adds a periodic task, first released immediately.
+    @param name of the task for statistics output.
+    @param function run on each release.
+    @param release period in ticks.
+    @param priority, 0 being the highest.
+    @return true if the task was added, false if the task table is full.  */
+bool schedAddTask(const char* name, void (*run)(void), uint32_t period, uint8_t priority);
+
+/** Runs the highest priority task that is due, if any. Releases are kept on an absolute
+    grid of the task period, so a late task does not drift. A task that overruns its
+    deadline runs once more straight away to catch up, and any further releases it
+    has fallen behind by are skipped.
+    @return true if a task was run.  */
+bool schedRunNext(void);
+
+/** Returns the time between the start of the running task and its previous start,
+    to use as the time step of a controller. The task period on its first run.
+    @return elapsed time in ticks.  */
+uint32_t schedElapsed(void);
+
+/** Returns the time the next task is due at, for sleeping until then.
+    @return earliest release time of all tasks, or the current time if there are none.  */
+uint32_t schedNextRelease(void);
+
+/** Returns the number of tasks added.
+    @return number of tasks.  */
+uint8_t schedTaskCount(void);
+
+/** Returns a task and its statistics.
+    @param index of the task in priority order.
+    @return task, or NULL if index is out of range.  */
+const schedTask_t* schedGetTask(uint8_t index);
+
+/** Clears the execution, lateness and overrun statistics of all tasks.  */
+void schedResetStats(void);
+
+#endif /* SCHED_H_ */
@@ -0,0 +1,58 @@
+/** @file   setpoint.c
+    @author Bailey Lissington, Dillon Pike, Joseph Ramirez
+    @date   21 May 2021
+    @brief  Functions related to the desired altitude and yaw set with the buttons.
+*/
+
+// standard library includes
+#include <stdint.h>
+#include <stdbool.h>
+
+// library includes
+#include "setpoint.h"
+
+/** Initialises a setpoint.  */
+void setpointInit(setpoint_t* setpoint, int16_t value, int16_t min, int16_t max,
+                  int16_t coarseStep, int16_t fineStep, int16_t doubleStep, int16_t wrapRange)
+{
+    setpoint->min = min;
+    setpoint->max = max;
+    setpoint->coarseStep = coarseStep;
+    setpoint->fineStep = fineStep;
+    setpoint->doubleStep = doubleStep;
+    setpoint->wrapRange = wrapRange;
+    setpointSet(setpoint, value);
+}
+
+/** Sets the value of a setpoint, wrapping it between negative and positive half of
+    its wrap range, or otherwise limiting it between its min and max.  */
+void setpointSet(setpoint_t* setpoint, int16_t value)
+{
+    if (setpoint->wrapRange > 0) {
+        if (value < -(setpoint->wrapRange / 2)) {
+            value += setpoint->wrapRange;
+        } else if (value >= (setpoint->wrapRange / 2)) {
+            value -= setpoint->wrapRange;
+        }
+    } else if (value < setpoint->min) {
+        value = setpoint->min;
+    } else if (value > setpoint->max) {
+        value = setpoint->max;
+    }
+    setpoint->value = value;
+}
+
+/** Steps a setpoint up or down by its fine, coarse or double press step.  */
+void setpointStep(setpoint_t* setpoint, int8_t direction, setpointMode_t mode)
+{
+    int16_t step = (mode == SETPOINT_FINE) ? setpoint->fineStep
+                   : (mode == SETPOINT_DOUBLE) ? setpoint->doubleStep : setpoint->coarseStep;
+
+    setpointSet(setpoint, setpoint->value + direction * step);
+}
+
+/** Returns the value of a setpoint.  */
+int16_t setpointGet(const setpoint_t* setpoint)
+{
+    return setpoint->value;
+}
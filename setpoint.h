@@ -0,0 +1,70 @@
+/** @file   setpoint.h
+    @author Bailey Lissington, Dillon Pike, Joseph Ramirez
+    @date   21 May 2021
+    @brief  Functions related to the desired altitude and yaw set with the buttons.
+*/
+
+#ifndef SETPOINT_H_
+#define SETPOINT_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Altitude setpoint limits and steps in percentage
+#define ALT_SETPOINT_MIN 0
+#define ALT_SETPOINT_MAX 100
+#define ALT_SETPOINT_COARSE_STEP 10
+#define ALT_SETPOINT_FINE_STEP 2
+#define ALT_SETPOINT_DOUBLE_STEP 40 // after the coarse step of its first press, 50 in all
+
+// Yaw setpoint steps in degrees
+#define YAW_SETPOINT_COARSE_STEP 15
+#define YAW_SETPOINT_FINE_STEP 3
+#define YAW_SETPOINT_DOUBLE_STEP 75 // after the coarse step of its first press, 90 in all
+
+typedef enum {
+    SETPOINT_COARSE = 0,
+    SETPOINT_FINE,
+    SETPOINT_DOUBLE // the second press of a double press
+} setpointMode_t;
+
+// Setpoint stepped up and down in fine, coarse or double press increments
+typedef struct {
+    int16_t value;
+    int16_t min;        // lowest value when not wrapping
+    int16_t max;        // highest value when not wrapping
+    int16_t coarseStep;
+    int16_t fineStep;
+    int16_t doubleStep;
+    int16_t wrapRange;  // range value wraps around in (e.g. a full rotation), or 0 to not wrap
+} setpoint_t;
+
+/** Initialises a setpoint.
+    @param address of setpoint.
+    @param initial value.
+    @param lowest value when not wrapping.
+    @param highest value when not wrapping.
+    @param coarse step.
+    @param fine step.
+    @param double press step.
+    @param range value wraps around in, or 0 to limit it between min and max.  */
+void setpointInit(setpoint_t* setpoint, int16_t value, int16_t min, int16_t max,
+                  int16_t coarseStep, int16_t fineStep, int16_t doubleStep, int16_t wrapRange);
+
+/** Sets the value of a setpoint, limiting or wrapping it.
+    @param address of setpoint.
+    @param new value.  */
+void setpointSet(setpoint_t* setpoint, int16_t value);
+
+/** Steps a setpoint up or down by its fine, coarse or double press step.
+    @param address of setpoint.
+    @param 1 to step up, -1 to step down.
+    @param size of the step.  */
+void setpointStep(setpoint_t* setpoint, int8_t direction, setpointMode_t mode);
+
+/** Returns the value of a setpoint.
+    @param address of setpoint.
+    @return value.  */
+int16_t setpointGet(const setpoint_t* setpoint);
+
+#endif /* SETPOINT_H_ */
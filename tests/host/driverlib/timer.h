@@ -0,0 +1 @@
+#include "../tivaware.h"
@@ -0,0 +1,592 @@
+/** @file   tivaware.c
+    @author Bailey Lissington, Dillon Pike, Joseph Ramirez
+    @date   21 May 2021
+    @brief  Stand-ins for the parts of TivaWare the host tests link against.
+*/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "tivaware.h"
+
+#define HOST_REGISTERS 64 // distinct register addresses a test can touch
+
+static uint32_t registerAddress[HOST_REGISTERS];
+static volatile uint32_t registerValue[HOST_REGISTERS];
+static uint8_t registerCount;
+
+#define HOST_GPIO_PORTS 6
+#define HOST_TIMERS 3 // TIMER0 to TIMER2, 0x1000 apart
+#define TIMER_INDEX(base) (((base) - TIMER0_BASE) / 0x1000)
+
+#define HOST_PWM_GENS 4
+#define PWM_GEN_INDEX(gen) ((gen) / 0x40 - 1) // generator offsets are 0x40 apart from 0x40
+#define PWM_MODULE_INDEX(base) ((base) == PWM1_BASE)
+
+uint32_t hostClockHz = 20000000;
+
+uint8_t hostIntPriority[NUM_INTERRUPTS];
+bool hostIntEnabled[NUM_INTERRUPTS];
+bool hostIntMasked;
+uint32_t hostIntMaskCount;
+void (*hostIntDisableHook)(uint32_t interrupt);
+
+static void (*intPending[NUM_INTERRUPTS])(void); // handler of each interrupt raised but not yet run
+static bool intActive[NUM_INTERRUPTS]; // handler running
+static uint32_t intPendingCount; // interrupts raised but not yet run
+
+static hostPwmGen_t pwmActive[2][HOST_PWM_GENS]; // indexed by module and generator
+static bool pwmSyncPending[2][HOST_PWM_GENS];
+
+// Input levels and edge interrupts of a GPIO port
+typedef struct {
+    uint8_t levels;
+    uint8_t intEnabled;
+    uint8_t intStatus;
+    void (*handler)(void);
+} hostGpioPort_t;
+
+static hostGpioPort_t gpioPorts[HOST_GPIO_PORTS]; // A to F
+
+// One-shot timer A of a timer module
+typedef struct {
+    uint32_t load;
+    uint32_t value;
+    bool enabled;
+    void (*handler)(void);
+} hostTimer_t;
+
+static hostTimer_t timers[HOST_TIMERS];
+
+uint32_t hostWfiCount;
+void (*hostWfiHook)(void);
+
+uint32_t hostAdcValue;
+uint32_t hostAdcTriggers;
+void (*hostAdcHandler)(void);
+
+// uDMA channel 15, copying to the SSI3 data register
+typedef struct {
+    const uint8_t* source;
+    uint32_t remaining;
+    uint32_t mode;
+    bool enabled;
+} hostDma_t;
+
+static hostDma_t dma;
+static void (*ssiHandler)(void);
+void (*hostSsiTxHook)(uint8_t byte);
+
+/** Returns the register at an address, adding it to the table reading 0 the first time.  */
+volatile uint32_t* hostRegister(uint32_t address)
+{
+    for (uint8_t i = 0; i < registerCount; i++) {
+        if (registerAddress[i] == address) {
+            return &registerValue[i];
+        }
+    }
+    if (registerCount >= HOST_REGISTERS) {
+        fprintf(stderr, "tivaware: more than %d registers used\n", HOST_REGISTERS);
+        exit(1);
+    }
+    registerAddress[registerCount] = address;
+    registerValue[registerCount] = 0;
+    return &registerValue[registerCount++];
+}
+
+void SysCtlPeripheralEnable(uint32_t peripheral)
+{
+    (void)peripheral;
+}
+
+bool SysCtlPeripheralReady(uint32_t peripheral)
+{
+    (void)peripheral;
+    return true;
+}
+
+uint32_t SysCtlClockGet(void)
+{
+    return hostClockHz;
+}
+
+void SysCtlPWMClockSet(uint32_t config)
+{
+    (void)config;
+}
+
+/** Runs the handler of a raised interrupt if it is enabled, unmasked and not already
+    running, as it would preempt the caller.  */
+static void intDeliver(uint32_t interrupt)
+{
+    while (intPending[interrupt] && hostIntEnabled[interrupt] && !hostIntMasked && !intActive[interrupt]) {
+        void (*handler)(void) = intPending[interrupt];
+        intPending[interrupt] = NULL;
+        intPendingCount--;
+        intActive[interrupt] = true;
+        handler();
+        intActive[interrupt] = false;
+    }
+}
+
+/** Raises an interrupt, running its handler now or once it can run.  */
+static void intRaise(uint32_t interrupt, void (*handler)(void))
+{
+    intPendingCount += (intPending[interrupt] == NULL);
+    intPending[interrupt] = handler;
+    intDeliver(interrupt);
+}
+
+void IntPrioritySet(uint32_t interrupt, uint8_t priority)
+{
+    hostIntPriority[interrupt] = priority;
+}
+
+bool IntMasterDisable(void)
+{
+    bool wasMasked = hostIntMasked;
+    hostIntMasked = true;
+    hostIntMaskCount++;
+    return wasMasked;
+}
+
+bool IntMasterEnable(void)
+{
+    bool wasMasked = hostIntMasked;
+    hostIntMasked = false;
+    for (uint32_t interrupt = 0; (interrupt < NUM_INTERRUPTS) && intPendingCount; interrupt++) {
+        intDeliver(interrupt);
+    }
+    return wasMasked;
+}
+
+void IntEnable(uint32_t interrupt)
+{
+    hostIntEnabled[interrupt] = true;
+    intDeliver(interrupt);
+}
+
+void IntDisable(uint32_t interrupt)
+{
+    hostIntEnabled[interrupt] = false;
+    if (hostIntDisableHook) {
+        hostIntDisableHook(interrupt);
+    }
+}
+
+void CPUwfi(void)
+{
+    hostWfiCount++;
+    if (hostWfiHook) {
+        hostWfiHook();
+    }
+}
+
+void ADCSequenceConfigure(uint32_t base, uint32_t sequence, uint32_t trigger, uint32_t priority)
+{
+    (void)base; (void)sequence; (void)trigger; (void)priority;
+}
+
+void ADCSequenceStepConfigure(uint32_t base, uint32_t sequence, uint32_t step, uint32_t config)
+{
+    (void)base; (void)sequence; (void)step; (void)config;
+}
+
+void ADCSequenceEnable(uint32_t base, uint32_t sequence)
+{
+    (void)base; (void)sequence;
+}
+
+void ADCIntRegister(uint32_t base, uint32_t sequence, void (*handler)(void))
+{
+    (void)base; (void)sequence;
+    hostAdcHandler = handler;
+}
+
+void ADCIntEnable(uint32_t base, uint32_t sequence)
+{
+    (void)base; (void)sequence;
+}
+
+void ADCIntClear(uint32_t base, uint32_t sequence)
+{
+    (void)base; (void)sequence;
+}
+
+int32_t ADCSequenceDataGet(uint32_t base, uint32_t sequence, uint32_t* buffer)
+{
+    (void)base; (void)sequence;
+    *buffer = hostAdcValue;
+    return 1;
+}
+
+void ADCProcessorTrigger(uint32_t base, uint32_t sequence)
+{
+    (void)base; (void)sequence;
+    hostAdcTriggers++;
+}
+
+void GPIOPinConfigure(uint32_t pinConfig)
+{
+    (void)pinConfig;
+}
+
+void GPIOPinTypePWM(uint32_t port, uint8_t pins)
+{
+    (void)port; (void)pins;
+}
+
+/** Returns the model state of a GPIO port.  */
+// Interrupt of each GPIO port, A to F
+static const uint32_t gpioInterrupts[HOST_GPIO_PORTS] = {INT_GPIOA, INT_GPIOB, INT_GPIOC, INT_GPIOD, INT_GPIOE, INT_GPIOF};
+
+static hostGpioPort_t* gpioPort(uint32_t port)
+{
+    const uint32_t bases[HOST_GPIO_PORTS] = {GPIO_PORTA_BASE, GPIO_PORTB_BASE, GPIO_PORTC_BASE,
+                                             GPIO_PORTD_BASE, GPIO_PORTE_BASE, GPIO_PORTF_BASE};
+    for (uint8_t i = 0; i < HOST_GPIO_PORTS; i++) {
+        if (bases[i] == port) {
+            return &gpioPorts[i];
+        }
+    }
+    fprintf(stderr, "tivaware: no GPIO port at 0x%08lx\n", (unsigned long)port);
+    exit(1);
+}
+
+void hostGpioSet(uint32_t port, uint8_t pins, bool high)
+{
+    hostGpioPort_t* p = gpioPort(port);
+    uint8_t levels = high ? (p->levels | pins) : (p->levels & ~pins);
+
+    p->intStatus |= (levels ^ p->levels) & p->intEnabled;
+    p->levels = levels;
+    if (p->intStatus && p->handler) {
+        intRaise(gpioInterrupts[p - gpioPorts], p->handler);
+    }
+}
+
+void GPIOPinTypeSSI(uint32_t port, uint8_t pins)
+{
+    (void)port; (void)pins;
+}
+
+void GPIOPinTypeGPIOOutput(uint32_t port, uint8_t pins)
+{
+    (void)port; (void)pins;
+}
+
+void GPIOPinWrite(uint32_t port, uint8_t pins, uint8_t value)
+{
+    hostGpioPort_t* p = gpioPort(port);
+    p->levels = (p->levels & ~pins) | (value & pins);
+}
+
+void GPIOPinTypeGPIOInput(uint32_t port, uint8_t pins)
+{
+    (void)port; (void)pins;
+}
+
+void GPIOPadConfigSet(uint32_t port, uint8_t pins, uint32_t strength, uint32_t pinType)
+{
+    (void)port; (void)pins; (void)strength; (void)pinType;
+}
+
+int32_t GPIOPinRead(uint32_t port, uint8_t pins)
+{
+    return gpioPort(port)->levels & pins;
+}
+
+void GPIOIntTypeSet(uint32_t port, uint8_t pins, uint32_t intType)
+{
+    (void)port; (void)pins; (void)intType;
+}
+
+void GPIOIntRegister(uint32_t port, void (*handler)(void))
+{
+    hostGpioPort_t* p = gpioPort(port);
+    p->handler = handler;
+    IntEnable(gpioInterrupts[p - gpioPorts]); // as TivaWare's does
+}
+
+void GPIOIntEnable(uint32_t port, uint32_t intFlags)
+{
+    gpioPort(port)->intEnabled |= intFlags;
+}
+
+void GPIOIntDisable(uint32_t port, uint32_t intFlags)
+{
+    gpioPort(port)->intEnabled &= ~intFlags;
+}
+
+uint32_t GPIOIntStatus(uint32_t port, bool masked)
+{
+    hostGpioPort_t* p = gpioPort(port);
+    return masked ? (p->intStatus & p->intEnabled) : p->intStatus;
+}
+
+void GPIOIntClear(uint32_t port, uint32_t intFlags)
+{
+    gpioPort(port)->intStatus &= ~intFlags;
+}
+
+void hostTimersAdvance(uint32_t cycles)
+{
+    for (uint8_t i = 0; i < HOST_TIMERS; i++) {
+        hostTimer_t* t = &timers[i];
+        if (!t->enabled) {
+            continue;
+        }
+        if (t->value > cycles) {
+            t->value -= cycles;
+        } else {
+            t->enabled = false;
+            if (t->handler) {
+                intRaise(INT_TIMER0A + 2 * i, t->handler); // timer A interrupts are 2 apart
+            }
+        }
+    }
+}
+
+bool hostTimerRunning(uint32_t base)
+{
+    return timers[TIMER_INDEX(base)].enabled;
+}
+
+void TimerConfigure(uint32_t base, uint32_t config)
+{
+    (void)base; (void)config;
+}
+
+void TimerLoadSet(uint32_t base, uint32_t timer, uint32_t value)
+{
+    (void)timer;
+    timers[TIMER_INDEX(base)].load = value;
+}
+
+void TimerEnable(uint32_t base, uint32_t timer)
+{
+    hostTimer_t* t = &timers[TIMER_INDEX(base)];
+    (void)timer;
+    t->value = t->load;
+    t->enabled = true;
+}
+
+void TimerDisable(uint32_t base, uint32_t timer)
+{
+    (void)timer;
+    timers[TIMER_INDEX(base)].enabled = false;
+}
+
+void TimerIntRegister(uint32_t base, uint32_t timer, void (*handler)(void))
+{
+    (void)timer;
+    timers[TIMER_INDEX(base)].handler = handler;
+    IntEnable(INT_TIMER0A + 2 * TIMER_INDEX(base)); // as TivaWare's does
+}
+
+void TimerIntEnable(uint32_t base, uint32_t intFlags)
+{
+    (void)base; (void)intFlags;
+}
+
+void TimerIntClear(uint32_t base, uint32_t intFlags)
+{
+    (void)base; (void)intFlags;
+}
+
+/** Sends a byte on SSI3.  */
+static void ssiSend(uint8_t byte)
+{
+    if (hostSsiTxHook) {
+        hostSsiTxHook(byte);
+    }
+}
+
+uint32_t hostDmaAdvance(uint32_t bytes)
+{
+    uint32_t moved = 0;
+
+    if (!dma.enabled) {
+        return 0;
+    }
+    while ((moved < bytes) && (dma.remaining > 0)) {
+        ssiSend(*dma.source++);
+        dma.remaining--;
+        moved++;
+    }
+    if (dma.remaining == 0) {
+        dma.enabled = false;
+        dma.mode = UDMA_MODE_STOP;
+        intRaise(INT_SSI3, ssiHandler);
+    }
+    return moved;
+}
+
+bool hostDmaBusy(void)
+{
+    return dma.enabled;
+}
+
+void SSIClockSourceSet(uint32_t base, uint32_t source)
+{
+    (void)base; (void)source;
+}
+
+void SSIConfigSetExpClk(uint32_t base, uint32_t clock, uint32_t protocol, uint32_t mode,
+                        uint32_t bitRate, uint32_t width)
+{
+    (void)base; (void)clock; (void)protocol; (void)mode; (void)bitRate; (void)width;
+}
+
+void SSIEnable(uint32_t base)
+{
+    (void)base;
+}
+
+void SSIDMAEnable(uint32_t base, uint32_t dmaFlags)
+{
+    (void)base; (void)dmaFlags;
+}
+
+void SSIIntRegister(uint32_t base, void (*handler)(void))
+{
+    (void)base;
+    ssiHandler = handler;
+    IntEnable(INT_SSI3);
+}
+
+void SSIIntClear(uint32_t base, uint32_t intFlags)
+{
+    (void)base; (void)intFlags;
+}
+
+bool SSIBusy(uint32_t base)
+{
+    (void)base;
+    return false;
+}
+
+void SSIDataPut(uint32_t base, uint32_t data)
+{
+    (void)base;
+    ssiSend((uint8_t)data);
+}
+
+void SSIDataGet(uint32_t base, uint32_t* data)
+{
+    (void)base;
+    *data = 0;
+}
+
+int32_t SSIDataGetNonBlocking(uint32_t base, uint32_t* data)
+{
+    (void)base; (void)data;
+    return 0;
+}
+
+void uDMAEnable(void)
+{
+}
+
+void uDMAControlBaseSet(void* controlTable)
+{
+    (void)controlTable;
+}
+
+void uDMAChannelAssign(uint32_t mapping)
+{
+    (void)mapping;
+}
+
+void uDMAChannelAttributeDisable(uint32_t channel, uint32_t attributes)
+{
+    (void)channel; (void)attributes;
+}
+
+void uDMAChannelControlSet(uint32_t channel, uint32_t control)
+{
+    (void)channel; (void)control;
+}
+
+void uDMAChannelTransferSet(uint32_t channel, uint32_t mode, void* source, void* destination,
+                            uint32_t size)
+{
+    (void)channel;
+    if ((uintptr_t)destination != SSI3_BASE + SSI_O_DR) {
+        fprintf(stderr, "tivaware: uDMA to %p rather than the SSI3 data register\n", destination);
+        exit(1);
+    }
+    if (dma.enabled) {
+        fprintf(stderr, "tivaware: uDMA transfer set while one is under way\n");
+        exit(1);
+    }
+    dma.source = source;
+    dma.remaining = size;
+    dma.mode = mode;
+}
+
+void uDMAChannelEnable(uint32_t channel)
+{
+    (void)channel;
+    dma.enabled = true;
+}
+
+uint32_t uDMAChannelModeGet(uint32_t channel)
+{
+    (void)channel;
+    return dma.mode;
+}
+
+/** Returns the model state of a generator.  */
+static hostPwmGen_t* pwmGen(uint32_t base, uint32_t generator)
+{
+    return &pwmActive[PWM_MODULE_INDEX(base)][PWM_GEN_INDEX(generator)];
+}
+
+void hostPwmBoundary(uint32_t base, uint32_t generator)
+{
+    hostPwmGen_t* gen = pwmGen(base, generator);
+    bool* pending = &pwmSyncPending[PWM_MODULE_INDEX(base)][PWM_GEN_INDEX(generator)];
+
+    if (*pending) {
+        gen->load = HWREG(base + generator + PWM_O_X_LOAD);
+        gen->compare = HWREG(base + generator + PWM_O_X_CMPB);
+        *pending = false;
+    }
+}
+
+hostPwmGen_t hostPwmActive(uint32_t base, uint32_t generator)
+{
+    return *pwmGen(base, generator);
+}
+
+void PWMGenConfigure(uint32_t base, uint32_t generator, uint32_t config)
+{
+    (void)base; (void)generator; (void)config;
+}
+
+void PWMGenPeriodSet(uint32_t base, uint32_t generator, uint32_t period)
+{
+    HWREG(base + generator + PWM_O_X_LOAD) = period / 2; // up/down counting
+}
+
+void PWMSyncUpdate(uint32_t base, uint32_t generatorBits)
+{
+    for (uint32_t i = 0; i < HOST_PWM_GENS; i++) {
+        if (generatorBits & (1 << i)) {
+            pwmSyncPending[PWM_MODULE_INDEX(base)][i] = true;
+        }
+    }
+}
+
+void PWMGenEnable(uint32_t base, uint32_t generator)
+{
+    pwmGen(base, generator)->enabled = true;
+}
+
+void PWMOutputState(uint32_t base, uint32_t outputBits, bool enable)
+{
+    (void)base; (void)outputBits; (void)enable;
+}
@@ -0,0 +1,278 @@
+/** @file   tivaware.h
+    @author Bailey Lissington, Dillon Pike, Joseph Ramirez
+    @date   21 May 2021
+    @brief  Stand-ins for the parts of TivaWare the host tests link against. The
+            inc/ and driverlib/ headers beside this one all include it, so modules
+            build unchanged. Peripherals are modelled only as far as the tests need:
+            registers are a table keyed by address, and the host* variables let a
+            test drive inputs and see what a module did.
+*/
+
+#ifndef TIVAWARE_H_
+#define TIVAWARE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Registers, read and written through a table keyed by address
+#define HWREG(x) (*hostRegister(x))
+volatile uint32_t* hostRegister(uint32_t address);
+
+// Memory map
+#define GPIO_PORTA_BASE 0x40004000
+#define GPIO_PORTB_BASE 0x40005000
+#define GPIO_PORTC_BASE 0x40006000
+#define GPIO_PORTD_BASE 0x40007000
+#define GPIO_PORTE_BASE 0x40024000
+#define GPIO_PORTF_BASE 0x40025000
+#define TIMER0_BASE 0x40030000
+#define TIMER1_BASE 0x40031000
+#define TIMER2_BASE 0x40032000
+#define PWM0_BASE 0x40028000
+#define PWM1_BASE 0x40029000
+#define ADC0_BASE 0x40038000
+#define SSI3_BASE ((uintptr_t)0x4000B000) // pointer sized, as OrbitOled.c gives the uDMA its data register
+
+// System control
+#define SYSCTL_PERIPH_ADC0 0xF0003800
+#define SYSCTL_PERIPH_GPIOA 0xF0000800
+#define SYSCTL_PERIPH_GPIOB 0xF0000801
+#define SYSCTL_PERIPH_GPIOC 0xF0000802
+#define SYSCTL_PERIPH_GPIOD 0xF0000803
+#define SYSCTL_PERIPH_GPIOE 0xF0000804
+#define SYSCTL_PERIPH_GPIOF 0xF0000805
+#define SYSCTL_PERIPH_TIMER0 0xF0000400
+#define SYSCTL_PERIPH_TIMER1 0xF0000401
+#define SYSCTL_PERIPH_TIMER2 0xF0000402
+#define SYSCTL_PERIPH_PWM0 0xF0004000
+#define SYSCTL_PERIPH_PWM1 0xF0004001
+#define SYSCTL_PERIPH_SSI3 0xF0001C03
+#define SYSCTL_PERIPH_UDMA 0xF0000C00
+#define SYSCTL_PWMDIV_1 0x00000000
+#define SYSCTL_PWMDIV_2 0x00100000
+#define SYSCTL_PWMDIV_4 0x00120000
+#define SYSCTL_PWMDIV_8 0x00140000
+#define SYSCTL_PWMDIV_16 0x00160000
+#define SYSCTL_PWMDIV_32 0x00180000
+#define SYSCTL_PWMDIV_64 0x001A0000
+
+extern uint32_t hostClockHz; // rate SysCtlClockGet returns
+
+void SysCtlPeripheralEnable(uint32_t peripheral);
+bool SysCtlPeripheralReady(uint32_t peripheral);
+uint32_t SysCtlClockGet(void);
+void SysCtlPWMClockSet(uint32_t config);
+
+// Interrupts
+#define FAULT_PENDSV 14
+#define FAULT_SYSTICK 15
+#define INT_GPIOA 16
+#define INT_GPIOB 17
+#define INT_GPIOC 18
+#define INT_GPIOD 19
+#define INT_GPIOE 20
+#define INT_UART0 21
+#define INT_ADC0SS0 30
+#define INT_TIMER0A 35
+#define INT_TIMER1A 37
+#define INT_TIMER2A 39
+#define INT_GPIOF 46
+#define INT_SSI3 74
+#define INT_WTIMER0A 110
+#define NUM_INTERRUPTS 155
+
+extern uint8_t hostIntPriority[NUM_INTERRUPTS]; // priorities set by IntPrioritySet
+extern bool hostIntEnabled[NUM_INTERRUPTS]; // between IntEnable and IntDisable
+extern bool hostIntMasked; // true between IntMasterDisable and IntMasterEnable
+extern uint32_t hostIntMaskCount; // calls to IntMasterDisable
+extern void (*hostIntDisableHook)(uint32_t interrupt); // called once IntDisable has disabled an interrupt, e.g. to raise it meanwhile
+
+void IntPrioritySet(uint32_t interrupt, uint8_t priority);
+bool IntMasterDisable(void);
+bool IntMasterEnable(void);
+void IntEnable(uint32_t interrupt);
+void IntDisable(uint32_t interrupt);
+
+// CPU
+extern uint32_t hostWfiCount; // calls to CPUwfi
+extern void (*hostWfiHook)(void); // called by CPUwfi in place of sleeping, e.g. to advance a fake clock
+
+void CPUwfi(void);
+
+// ADC
+#define ADC_TRIGGER_PROCESSOR 0x00000000
+#define ADC_CTL_IE 0x00000040
+#define ADC_CTL_END 0x00000020
+#define ADC_CTL_CH0 0x00000000
+#define ADC_CTL_CH9 0x00000009
+
+extern uint32_t hostAdcValue; // result of every conversion
+extern uint32_t hostAdcTriggers; // conversions started
+extern void (*hostAdcHandler)(void); // handler ADCIntRegister registered
+
+void ADCSequenceConfigure(uint32_t base, uint32_t sequence, uint32_t trigger, uint32_t priority);
+void ADCSequenceStepConfigure(uint32_t base, uint32_t sequence, uint32_t step, uint32_t config);
+void ADCSequenceEnable(uint32_t base, uint32_t sequence);
+void ADCIntRegister(uint32_t base, uint32_t sequence, void (*handler)(void));
+void ADCIntEnable(uint32_t base, uint32_t sequence);
+void ADCIntClear(uint32_t base, uint32_t sequence);
+int32_t ADCSequenceDataGet(uint32_t base, uint32_t sequence, uint32_t* buffer);
+void ADCProcessorTrigger(uint32_t base, uint32_t sequence);
+
+// Debug
+#define ASSERT(expr)
+
+// GPIO
+#define GPIO_PIN_0 0x00000001
+#define GPIO_PIN_1 0x00000002
+#define GPIO_PIN_2 0x00000004
+#define GPIO_PIN_3 0x00000008
+#define GPIO_PIN_4 0x00000010
+#define GPIO_PIN_5 0x00000020
+#define GPIO_PIN_6 0x00000040
+#define GPIO_PIN_7 0x00000080
+#define GPIO_PC5_M0PWM7 0x00021404
+#define GPIO_PF1_M1PWM5 0x00050405
+#define GPIO_STRENGTH_2MA 0x00000001
+#define GPIO_PIN_TYPE_STD_WPU 0x0000000A
+#define GPIO_PIN_TYPE_STD_WPD 0x0000000C
+#define GPIO_FALLING_EDGE 0x00000000
+#define GPIO_BOTH_EDGES 0x00000001
+#define GPIO_INT_PIN_0 0x00000001
+#define GPIO_INT_PIN_1 0x00000002
+#define GPIO_INT_PIN_4 0x00000010
+#define GPIO_O_LOCK 0x00000520
+#define GPIO_O_CR 0x00000524
+
+// PF0 unlock registers, as inc/tm4c123gh6pm.h names them
+#define GPIO_PORTF_LOCK_R HWREG(0x40025520)
+#define GPIO_PORTF_CR_R HWREG(0x40025524)
+#define GPIO_LOCK_KEY 0x4C4F434B
+#define GPIO_LOCK_M 0xFFFFFFFF
+
+/** Sets the level of input pins. Raises the port's interrupt if any pin with its edge
+    interrupt enabled changed, running its handler straight away unless the interrupt
+    is disabled or masked, as it would preempt the caller.  */
+void hostGpioSet(uint32_t port, uint8_t pins, bool high);
+
+void GPIOPinConfigure(uint32_t pinConfig);
+void GPIOPinTypeSSI(uint32_t port, uint8_t pins);
+void GPIOPinTypeGPIOOutput(uint32_t port, uint8_t pins);
+void GPIOPinWrite(uint32_t port, uint8_t pins, uint8_t value);
+void GPIOPinTypePWM(uint32_t port, uint8_t pins);
+void GPIOPinTypeGPIOInput(uint32_t port, uint8_t pins);
+void GPIOPadConfigSet(uint32_t port, uint8_t pins, uint32_t strength, uint32_t pinType);
+int32_t GPIOPinRead(uint32_t port, uint8_t pins);
+void GPIOIntTypeSet(uint32_t port, uint8_t pins, uint32_t intType);
+void GPIOIntRegister(uint32_t port, void (*handler)(void));
+void GPIOIntEnable(uint32_t port, uint32_t intFlags);
+void GPIOIntDisable(uint32_t port, uint32_t intFlags);
+uint32_t GPIOIntStatus(uint32_t port, bool masked);
+void GPIOIntClear(uint32_t port, uint32_t intFlags);
+
+// Timers. Only one-shot down counting of timer A is modelled: an enabled timer counts
+// down from its load as hostTimersAdvance moves time on, then stops and raises its interrupt
+#define TIMER_A 0x000000FF
+#define TIMER_CFG_ONE_SHOT 0x00000021
+#define TIMER_TIMA_TIMEOUT 0x00000001
+
+/** Moves every enabled timer on by some clock cycles, raising the interrupt of each that times out.  */
+void hostTimersAdvance(uint32_t cycles);
+/** Returns whether a timer is counting.  */
+bool hostTimerRunning(uint32_t base);
+
+void TimerConfigure(uint32_t base, uint32_t config);
+void TimerLoadSet(uint32_t base, uint32_t timer, uint32_t value);
+void TimerEnable(uint32_t base, uint32_t timer);
+void TimerDisable(uint32_t base, uint32_t timer);
+void TimerIntRegister(uint32_t base, uint32_t timer, void (*handler)(void));
+void TimerIntEnable(uint32_t base, uint32_t intFlags);
+void TimerIntClear(uint32_t base, uint32_t intFlags);
+
+// SSI3, sending bytes to hostSsiTxHook as soon as they are put, fed by uDMA
+// channel 15. A transfer moves as hostDmaAdvance moves time on, and its completion
+// raises INT_SSI3, which runs the handler straight away if the interrupt is enabled
+// and unmasked, or else once it is
+#define SSI_O_DR 0x00000008
+#define SSI_CLOCK_SYSTEM 0x00000000
+#define SSI_FRF_MOTO_MODE_0 0x00000000
+#define SSI_MODE_MASTER 0x00000000
+#define SSI_DMA_TX 0x00000002
+#define SSI_RXOR 0x00000001
+
+#define UDMA_CH15_SSI3TX 0x0002000F
+#define UDMA_PRI_SELECT 0x00000000
+#define UDMA_ATTR_ALL 0x0000000F
+#define UDMA_SIZE_8 0x00000000
+#define UDMA_SRC_INC_8 0x00000000
+#define UDMA_DST_INC_NONE 0xC0000000
+#define UDMA_ARB_4 0x00008000
+#define UDMA_MODE_STOP 0x00000000
+#define UDMA_MODE_BASIC 0x00000001
+
+extern void (*hostSsiTxHook)(uint8_t byte); // called with each byte SSI3 sends
+
+/** Moves the uDMA transfer on by up to some bytes, completing it if none are left.
+    @return bytes moved.  */
+uint32_t hostDmaAdvance(uint32_t bytes);
+/** Returns whether a uDMA transfer is under way.  */
+bool hostDmaBusy(void);
+
+void SSIClockSourceSet(uint32_t base, uint32_t source);
+void SSIConfigSetExpClk(uint32_t base, uint32_t clock, uint32_t protocol, uint32_t mode,
+                        uint32_t bitRate, uint32_t width);
+void SSIEnable(uint32_t base);
+void SSIDMAEnable(uint32_t base, uint32_t dmaFlags);
+void SSIIntRegister(uint32_t base, void (*handler)(void));
+void SSIIntClear(uint32_t base, uint32_t intFlags);
+bool SSIBusy(uint32_t base);
+void SSIDataPut(uint32_t base, uint32_t data);
+void SSIDataGet(uint32_t base, uint32_t* data);
+int32_t SSIDataGetNonBlocking(uint32_t base, uint32_t* data);
+
+void uDMAEnable(void);
+void uDMAControlBaseSet(void* controlTable);
+void uDMAChannelAssign(uint32_t mapping);
+void uDMAChannelAttributeDisable(uint32_t channel, uint32_t attributes);
+void uDMAChannelControlSet(uint32_t channel, uint32_t control);
+void uDMAChannelTransferSet(uint32_t channel, uint32_t mode, void* source, void* destination,
+                            uint32_t size);
+void uDMAChannelEnable(uint32_t channel);
+uint32_t uDMAChannelModeGet(uint32_t channel);
+
+// PWM. Each generator counts up/down, staging its load and compare registers
+// until PWMSyncUpdate, which the model applies at hostPwmBoundary
+#define PWM_GEN_2 0x000000C0
+#define PWM_GEN_3 0x00000100
+#define PWM_GEN_2_BIT 0x00000004
+#define PWM_GEN_3_BIT 0x00000008
+#define PWM_O_X_LOAD 0x00000010
+#define PWM_O_X_CMPB 0x0000001C
+#define PWM_O_2_CMPB (PWM_GEN_2 + PWM_O_X_CMPB)
+#define PWM_O_3_CMPB (PWM_GEN_3 + PWM_O_X_CMPB)
+#define PWM_OUT_5 0x00000145
+#define PWM_OUT_7 0x00000187
+#define PWM_OUT_5_BIT 0x00000020
+#define PWM_OUT_7_BIT 0x00000080
+#define PWM_GEN_MODE_UP_DOWN 0x00000002
+#define PWM_GEN_MODE_SYNC 0x00000038
+
+// Load and compare a generator is counting with, since its last boundary
+typedef struct {
+    uint32_t load;
+    uint32_t compare;
+    bool enabled;
+} hostPwmGen_t;
+
+/** Applies any synchronised update of a generator, as its counter reaching zero does.  */
+void hostPwmBoundary(uint32_t base, uint32_t generator);
+/** Returns the load and compare a generator is counting with.  */
+hostPwmGen_t hostPwmActive(uint32_t base, uint32_t generator);
+
+void PWMGenConfigure(uint32_t base, uint32_t generator, uint32_t config);
+void PWMGenPeriodSet(uint32_t base, uint32_t generator, uint32_t period);
+void PWMSyncUpdate(uint32_t base, uint32_t generatorBits);
+void PWMGenEnable(uint32_t base, uint32_t generator);
+void PWMOutputState(uint32_t base, uint32_t outputBits, bool enable);
+
+#endif /* TIVAWARE_H_ */
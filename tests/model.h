@@ -0,0 +1,101 @@
+/** @file   model.h
+    @author Bailey Lissington, Dillon Pike, Joseph Ramirez
+    @date   21 May 2021
+    @brief  Identified helirig model for the host closed-loop simulations. The
+            parameters match tools/lqr_gains.py, which the LQR gains come from.
+            The controllers command thrust, which actuatorShape turns into the duty
+            that reaches each rotor, and each rotor's thrust rises with the square of
+            that duty above its deadband, so the simulations run the same shaping
+            and thrust curve as the rig.
+*/
+
+#ifndef MODEL_H_
+#define MODEL_H_
+
+#include <stdint.h>
+
+#include "actuator.h"
+
+#define MODEL_ALT_TAU 0.8 // altitude rate time constant (s)
+#define MODEL_ALT_GAIN 3.0 // altitude acceleration per % main thrust (%/s^2)
+#define MODEL_YAW_TAU 0.5 // yaw rate time constant (s)
+#define MODEL_YAW_GAIN 20.0 // yaw acceleration per % tail thrust (deg/s^2)
+#define MODEL_YAW_COUPLING 15.0 // yaw acceleration per % main thrust from main rotor torque (deg/s^2)
+#define MODEL_MAIN_HOVER 40.0 // main thrust that holds the altitude in % of full thrust
+#define MODEL_TAIL_HOVER 30.0 // tail thrust that holds the yaw at the hover main thrust in % of full thrust
+
+// Helirig state. Thrusts beyond the hover thrusts accelerate it.
+typedef struct {
+    double altitude; // %
+    double climbRate; // % per s
+    double yaw; // degrees, not wrapped
+    double yawRate; // degrees per s
+} model_t;
+
+/** Thrust of a rotor at a duty, rising with the square of the duty above the deadband.
+    @param duty reaching the rotor in %.
+    @param deadband of the rotor in %.
+    @return thrust in % of full thrust.  */
+static double modelThrust(double duty, double deadband)
+{
+    return (duty > deadband) ? ACTUATOR_THRUST_FOR_DUTY(duty, deadband) : 0;
+}
+
+/** Shapes the thrust commands into the duties that reach the rotors, as applyDuties does.
+    @param main thrust command in %.
+    @param tail thrust command in %.
+    @param address to store the main duty in %.
+    @param address to store the tail duty in %.  */
+static void modelShape(double mainCommand, double tailCommand, double* mainDuty, double* tailDuty)
+{
+    *mainDuty = PWM_DUTY_FROM_Q(actuatorShape(MAIN, PWM_DUTY_TO_Q(mainCommand)));
+    *tailDuty = PWM_DUTY_FROM_Q(actuatorShape(TAIL, PWM_DUTY_TO_Q(tailCommand)));
+}
+
+/** Sets the rate the rotors are shaped at and lets the slew limits settle on the
+    given commands, so a simulation can start from hover.
+    @param rate modelShape is called at in Hz.
+    @param main thrust command in %.
+    @param tail thrust command in %.  */
+static void modelShapeInit(uint32_t updateHz, double mainCommand, double tailCommand)
+{
+    double mainDuty, tailDuty;
+
+    actuatorInit(updateHz);
+    modelShape(0, 0, &mainDuty, &tailDuty);
+    for (uint32_t i = 0; i < updateHz; i++) { // 1 s covers the full duty range at either slew rate
+        modelShape(mainCommand, tailCommand, &mainDuty, &tailDuty);
+    }
+}
+
+/** Advances the model by deltaT with the given thrusts.
+    @param address of model.
+    @param main thrust in %.
+    @param tail thrust in %.
+    @param main thrust lost to a disturbance, e.g. a gust or added weight, in %.
+    @param time step in s.  */
+static void modelStepThrust(model_t* m, double mainThrust, double tailThrust, double mainDisturbance, double deltaT)
+{
+    double lift = mainThrust - mainDisturbance - MODEL_MAIN_HOVER;
+    double torque = mainThrust - MODEL_MAIN_HOVER;
+    double tail = tailThrust - MODEL_TAIL_HOVER;
+
+    m->climbRate += (MODEL_ALT_GAIN * lift - m->climbRate / MODEL_ALT_TAU) * deltaT;
+    m->yawRate += (MODEL_YAW_GAIN * tail - MODEL_YAW_COUPLING * torque - m->yawRate / MODEL_YAW_TAU) * deltaT;
+    m->altitude += m->climbRate * deltaT;
+    m->yaw += m->yawRate * deltaT;
+}
+
+/** Advances the model by deltaT with the duties that reach the rotors.
+    @param address of model.
+    @param main duty in %, e.g. from modelShape.
+    @param tail duty in %.
+    @param main thrust lost to a disturbance in %.
+    @param time step in s.  */
+static void modelStep(model_t* m, double mainDuty, double tailDuty, double mainDisturbance, double deltaT)
+{
+    modelStepThrust(m, modelThrust(mainDuty, ACTUATOR_MAIN_DEADBAND), modelThrust(tailDuty, ACTUATOR_TAIL_DEADBAND),
+                    mainDisturbance, deltaT);
+}
+
+#endif /* MODEL_H_ */
@@ -0,0 +1,62 @@
+/** @file   test.h
+    @author Bailey Lissington, Dillon Pike, Joseph Ramirez
+    @date   21 May 2021
+    @brief  Minimal checks for the host unit tests. A failed check prints where it
+            failed and the test carries on, so one run reports every failure.
+*/
+
+#ifndef TEST_H_
+#define TEST_H_
+
+#include <stdio.h>
+#include <stdint.h>
+#include <math.h>
+#ifdef _POSIX_C_SOURCE
+#include <time.h>
+#endif
+
+static int testChecks = 0;
+static int testFailures = 0;
+
+// Checks a condition is true
+#define CHECK(cond) do { \
+        testChecks++; \
+        if (!(cond)) { \
+            testFailures++; \
+            printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+        } \
+    } while (0)
+
+// Checks two numbers are within tol of each other
+#define CHECK_NEAR(a, b, tol) do { \
+        double checkA = (a), checkB = (b); \
+        testChecks++; \
+        if (!(fabs(checkA - checkB) <= (tol))) { \
+            testFailures++; \
+            printf("%s:%d: check failed: %s = %g, %s = %g, tolerance %g\n", \
+                   __FILE__, __LINE__, #a, checkA, #b, checkB, (double)(tol)); \
+        } \
+    } while (0)
+
+/** Prints the number of checks run and failed.
+    @param name of the test.
+    @return exit status of the test, 0 if every check passed.  */
+static int testReport(const char* name)
+{
+    printf("%s: %d checks, %d failed\n", name, testChecks, testFailures);
+    return testFailures ? 1 : 0;
+}
+
+#ifdef _POSIX_C_SOURCE
+/** Returns the host's monotonic clock for benchmarks. A test that benchmarks defines
+    _POSIX_C_SOURCE before its first include.
+    @return time in ns.  */
+static uint64_t testNowNs(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000ULL + (uint64_t)now.tv_nsec;
+}
+#endif
+
+#endif /* TEST_H_ */
@@ -0,0 +1,110 @@
+/** @file   test_actuator.c
+    @author Bailey Lissington, Dillon Pike, Joseph Ramirez
+    @date   21 May 2021
+    @brief  Host tests of the actuator shaping: fixed duties expressed in thrust units
+            reach the rotor as that duty, the thrust table is monotonic, slew limits
+            follow the rate given to actuatorInit, and a benchmark of the shaping cost.
+*/
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "actuator.h"
+#include "test.h"
+
+#define UPDATE_HZ 100 // rate task rate the rotors are shaped at
+#define TAIL_DUTY_REF 45 // reference search tail duty, as in main.c
+#define BENCH_CALLS 1000000
+
+/** Shapes a command until the slew limit has let it settle.
+    @return duty applied in %.  */
+static double settle(rotor chosenRotor, double thrust)
+{
+    uint32_t duty = 0;
+    for (int i = 0; i < 2 * UPDATE_HZ; i++) {
+        duty = actuatorShape(chosenRotor, PWM_DUTY_TO_Q(thrust));
+    }
+    return PWM_DUTY_FROM_Q(duty);
+}
+
+/** The reference search tail thrust shapes to the 45% duty it was tuned at, and fixed
+    duties through the upper half of the range come back within the table's accuracy.  */
+static void testThrustForDuty(void)
+{
+    double thrust = ACTUATOR_THRUST_FOR_DUTY(TAIL_DUTY_REF, ACTUATOR_TAIL_DEADBAND);
+    double duty = settle(TAIL, thrust);
+    printf("tail reference: %.2f%% thrust shapes to %.2f%% duty\n", thrust, duty);
+    CHECK_NEAR(duty, TAIL_DUTY_REF, 0.1);
+
+    double worst = 0;
+    for (int target = 30; target <= PWM_DUTY_MAX; target++) {
+        worst = fmax(worst, fabs(settle(MAIN, ACTUATOR_THRUST_FOR_DUTY(target, ACTUATOR_MAIN_DEADBAND)) - target));
+    }
+    printf("fixed main duties of 30%% and above shape to within %.3f%%\n", worst);
+    CHECK(worst < 0.5);
+}
+
+/** More thrust never gives less duty, and the duty stays within the PWM range.  */
+static void testMonotonic(void)
+{
+    uint32_t previous = 0;
+    actuatorInit(1); // slew limit far above any step here
+    for (uint32_t command = 1; command <= PWM_DUTY_TO_Q(100); command += 997) {
+        actuatorShape(MAIN, 0);
+        uint32_t duty = actuatorShape(MAIN, command);
+        CHECK(duty >= previous);
+        CHECK((duty >= PWM_DUTY_TO_Q(PWM_DUTY_MIN)) && (duty <= PWM_DUTY_TO_Q(PWM_DUTY_MAX)));
+        previous = duty;
+    }
+    actuatorInit(UPDATE_HZ);
+}
+
+/** A step rises at the slew rate spread over the update rate, and a zero command stops
+    the rotor at once.  */
+static void testSlew(void)
+{
+    const uint32_t rates[] = {50, 100};
+
+    for (unsigned i = 0; i < sizeof(rates) / sizeof(rates[0]); i++) {
+        actuatorInit(rates[i]);
+        actuatorShape(MAIN, 0);
+        uint32_t duty = actuatorShape(MAIN, PWM_DUTY_TO_Q(100));
+        CHECK_NEAR(PWM_DUTY_FROM_Q(duty), (double)ACTUATOR_MAIN_SLEW_RATE / rates[i], 0.01);
+
+        int updates = 1;
+        while ((duty < PWM_DUTY_TO_Q(PWM_DUTY_MAX)) && (updates < 1000)) {
+            duty = actuatorShape(MAIN, PWM_DUTY_TO_Q(100));
+            updates++;
+        }
+        // PWM_DUTY_MAX at the slew rate takes the same time at either update rate
+        CHECK_NEAR((double)updates / rates[i], (double)PWM_DUTY_MAX / ACTUATOR_MAIN_SLEW_RATE, 1.0 / rates[i]);
+        CHECK(actuatorShape(MAIN, 0) == 0);
+    }
+    actuatorInit(UPDATE_HZ);
+}
+
+/** Host time per shaping call, to compare changes to the table and slew code.  */
+static void benchShape(void)
+{
+    volatile uint32_t sink; // every result is stored, so no call can be optimised away
+    uint64_t start = testNowNs();
+    for (uint32_t i = 0; i < BENCH_CALLS; i++) {
+        sink = actuatorShape(i & 1, (i * 2654435761u) % PWM_DUTY_TO_Q(100) + 1);
+    }
+    uint64_t elapsed = testNowNs() - start;
+    (void)sink;
+    printf("actuatorShape: %.1f ns per call on the host\n", (double)elapsed / BENCH_CALLS);
+}
+
+int main(void)
+{
+    actuatorInit(UPDATE_HZ);
+    testThrustForDuty();
+    testMonotonic();
+    testSlew();
+    benchShape();
+    return testReport("test_actuator");
+}
@@ -0,0 +1,301 @@
+/** @file   test_alt.c
+    @author Bailey Lissington, Dillon Pike, Joseph Ramirez
+    @date   21 May 2021
+    @brief  Host tests of the climb rate estimate, fed sample by sample through
+            ADCIntHandler: update rate, delay, bandwidth and noise against the
+            estimate it replaced, which updated every BUF_SIZE samples, and the
+            cascaded altitude controller flying the identified model on each.
+*/
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <math.h>
+
+#include "tivaware.h"
+#include "alt.h"
+#include "pi.h"
+#include "test.h"
+#include "model.h"
+
+#define SAMPLE_S (1.0 / ADC_SAMPLE_RATE_HZ)
+#define RATE_LOOP_SAMPLES 5 // samples per rate loop period, 100 Hz
+#define OUTER_LOOP_SAMPLES 10 // samples per outer loop period, 50 Hz
+#define GROUND_ADC 2500 // ADC reading at 0% altitude
+#define NOISE_COUNTS 3 // ADC noise is uniform within this many counts either side
+#define TWO_PI 6.283185307179586
+#define RUN_S 25
+#define DISTURBANCE_S 15.0 // time main thrust is lost to a disturbance at in the closed-loop flights
+#define DISTURBANCE_THRUST 10.0 // main thrust lost, in %
+
+// Estimator the per-sample one replaced: adcSum recorded every BUF_SIZE samples,
+// differenced over OLD_HISTORY records, filtered with a weight of 1/4 per record
+#define OLD_HISTORY 5
+#define OLD_FILTER_DIV 4
+
+typedef enum {RATE_TRUE = 0, RATE_NEW, RATE_OLD} rateSource_t;
+static const char* rateSourceNames[] = {"true rate", "per-sample estimate", "old estimate"};
+
+static uint32_t hostTime; // pacer time, advanced a tick per sample
+static uint32_t noiseState = 1;
+
+static uint32_t oldSamples[BUF_SIZE], oldSum, oldHistory[OLD_HISTORY];
+static uint8_t oldSampleIndex, oldHistoryIndex, oldSampleCount;
+static double oldRate;
+
+uint32_t pacerGetTime(void)
+{
+    return hostTime;
+}
+
+/** Uniform noise in [-NOISE_COUNTS, NOISE_COUNTS] from a fixed-seed generator.  */
+static int32_t noise(void)
+{
+    noiseState = noiseState * 1103515245 + 12345;
+    return (int32_t)((noiseState >> 16) % (2 * NOISE_COUNTS + 1)) - NOISE_COUNTS;
+}
+
+/** Runs the old estimator on a sample, in floating point.  */
+static void oldRateUpdate(uint32_t adc)
+{
+    oldSum += adc - oldSamples[oldSampleIndex];
+    oldSamples[oldSampleIndex] = adc;
+    oldSampleIndex = (oldSampleIndex + 1) % BUF_SIZE;
+    if (++oldSampleCount < BUF_SIZE) {
+        return;
+    }
+    oldSampleCount = 0;
+    double change = (double)oldSum - oldHistory[oldHistoryIndex];
+    oldHistory[oldHistoryIndex] = oldSum;
+    oldHistoryIndex = (oldHistoryIndex + 1) % OLD_HISTORY;
+    oldRate += (change - oldRate) / OLD_FILTER_DIV;
+}
+
+static double oldGetRate(void)
+{
+    return -oldRate / BUF_SIZE * 100 / MAX_ALT * ADC_SAMPLE_RATE_HZ / (BUF_SIZE * OLD_HISTORY);
+}
+
+/** Converts and handles one sample of an altitude, as SysTick and ADCIntHandler do.
+    @param altitude in %.
+    @param true to add ADC noise.  */
+static void sample(double altitude, bool noisy)
+{
+    int32_t adc = (int32_t)lround(GROUND_ADC - altitude / 100 * MAX_ALT) + (noisy ? noise() : 0);
+    hostAdcValue = (uint32_t)adc;
+    altTrigger();
+    hostTime++;
+    hostAdcHandler();
+    oldRateUpdate(hostAdcValue);
+}
+
+/** Holds an altitude until both estimates have settled on zero.  */
+static void hold(double altitude)
+{
+    for (int i = 0; i < ADC_SAMPLE_RATE_HZ * 2; i++) {
+        sample(altitude, false);
+    }
+}
+
+/** Both estimates follow a climb rate once it has filled their history.  */
+static void testRamp(void)
+{
+    const double rate = 20.0;
+    double altitude = 10.0;
+
+    hold(altitude);
+    for (int i = 0; i < ADC_SAMPLE_RATE_HZ; i++) {
+        altitude += rate * SAMPLE_S;
+        sample(altitude, false);
+    }
+    CHECK_NEAR(getAltitudeRate(), rate, 0.2);
+    CHECK_NEAR(oldGetRate(), rate, 0.2);
+}
+
+/** A climb rate step reaches the per-sample estimate sooner, and moves it every sample.  */
+static void testStepDelay(void)
+{
+    const double rate = 20.0;
+    double altitude = 10.0;
+    double newHalf = -1, oldHalf = -1;
+    double previous = 0;
+    int newUpdates = 0, oldUpdates = 0;
+    double previousOld = 0;
+
+    hold(altitude);
+    for (int i = 1; i <= ADC_SAMPLE_RATE_HZ / 2; i++) {
+        altitude += rate * SAMPLE_S;
+        sample(altitude, false);
+
+        double t = i * SAMPLE_S;
+        if ((newHalf < 0) && (getAltitudeRate() >= rate / 2)) {
+            newHalf = t;
+        }
+        if ((oldHalf < 0) && (oldGetRate() >= rate / 2)) {
+            oldHalf = t;
+        }
+        if (i <= 50) { // counts updates over the first 100 ms of the climb
+            newUpdates += (getAltitudeRate() != previous);
+            oldUpdates += (oldGetRate() != previousOld);
+        }
+        previous = getAltitudeRate();
+        previousOld = oldGetRate();
+    }
+    printf("climb rate step: per-sample estimate reaches half in %.0f ms, updating %d times in 100 ms; "
+           "old estimate %.0f ms, %d times\n", newHalf * 1000, newUpdates, oldHalf * 1000, oldUpdates);
+    CHECK(newHalf > 0);
+    CHECK(newHalf < oldHalf);
+    CHECK(newUpdates >= 45);
+}
+
+/** Gain of an estimate to a sinusoidal altitude.
+    @param frequency in Hz.
+    @param true for the per-sample estimate, false for the old one.
+    @return peak estimate over peak climb rate.  */
+static double gainAt(double frequency, bool perSample)
+{
+    const double amplitude = 5.0;
+    double peak = 0;
+
+    hold(30.0);
+    for (int i = 0; i < ADC_SAMPLE_RATE_HZ * 3; i++) {
+        double t = i * SAMPLE_S;
+        sample(30.0 + amplitude * sin(TWO_PI * frequency * t), false);
+        if (t >= 1.0) {
+            peak = fmax(peak, fabs(perSample ? getAltitudeRate() : oldGetRate()));
+        }
+    }
+    return peak / (amplitude * TWO_PI * frequency);
+}
+
+/** Lowest frequency an estimate's gain falls below -3 dB at, in Hz.  */
+static double bandwidth(bool perSample)
+{
+    double frequency;
+    for (frequency = 0.25; frequency < 20.0; frequency += 0.25) {
+        if (gainAt(frequency, perSample) < sqrt(0.5)) {
+            break;
+        }
+    }
+    return frequency;
+}
+
+/** The per-sample estimate passes a wider band of climb rates.  */
+static void testBandwidth(void)
+{
+    double newBandwidth = bandwidth(true);
+    double oldBandwidth = bandwidth(false);
+    printf("-3 dB bandwidth: per-sample estimate %.2f Hz, old estimate %.2f Hz\n", newBandwidth, oldBandwidth);
+    CHECK(newBandwidth > oldBandwidth);
+}
+
+/** Spread of each estimate while hovering with ADC noise.  */
+static void testNoise(void)
+{
+    double newSquares = 0, oldSquares = 0;
+    int n = ADC_SAMPLE_RATE_HZ * 4;
+
+    hold(30.0);
+    for (int i = 0; i < n; i++) {
+        sample(30.0, true);
+        newSquares += getAltitudeRate() * getAltitudeRate();
+        oldSquares += oldGetRate() * oldGetRate();
+    }
+    printf("hover with +-%d counts of ADC noise: per-sample estimate %.2f %%/s rms, old estimate %.2f %%/s rms\n",
+           NOISE_COUNTS, sqrt(newSquares / n), sqrt(oldSquares / n));
+    CHECK(sqrt(newSquares / n) < 1.0);
+}
+
+// Response of the altitude controller to a step and then a disturbance
+typedef struct {
+    double settle; // time until the altitude stays within 1% of the target, in s
+    double overshoot; // largest altitude past the target, in %
+    double dip; // largest altitude error after the disturbance, in %
+    double rateError; // rms error of the climb rate fed to the rate loop, in % per s
+} flight_t;
+
+/** Flies the cascaded altitude controller on the model from hover at 0 to a target,
+    with ADC noise, feeding the rate loop the given climb rate. Main thrust is lost to a
+    disturbance at DISTURBANCE_S.
+    @param climb rate the rate loop is fed.
+    @param target altitude in %.
+    @param address to store the response.  */
+static void flyAltitude(rateSource_t source, double target, flight_t* flight)
+{
+    model_t heli = {0};
+    double setRate = 0, mainDuty, tailDuty;
+    double squares = 0;
+    int rateSamples = 0;
+    flight->settle = -1;
+    flight->overshoot = flight->dip = 0;
+
+    hold(0);
+    initialAlt = altRead();
+    resetErrorIntegrals();
+    mainRatePiTransfer(0, 0, MODEL_MAIN_HOVER);
+    modelShapeInit(ADC_SAMPLE_RATE_HZ / RATE_LOOP_SAMPLES, MODEL_MAIN_HOVER, MODEL_TAIL_HOVER);
+    modelShape(MODEL_MAIN_HOVER, MODEL_TAIL_HOVER, &mainDuty, &tailDuty);
+
+    for (int i = 0; i < ADC_SAMPLE_RATE_HZ * RUN_S; i++) {
+        double t = i * SAMPLE_S;
+        sample(heli.altitude, true);
+        if ((i % OUTER_LOOP_SAMPLES) == 0) {
+            setRate = mainAltitudeCompute(target, altitudeCalc(altRead()), 0);
+        }
+        if ((i % RATE_LOOP_SAMPLES) == 0) {
+            double climbRate = (source == RATE_TRUE) ? heli.climbRate
+                             : (source == RATE_NEW) ? getAltitudeRate() : oldGetRate();
+            modelShape(mainRatePiCompute(setRate, climbRate, 0, RATE_LOOP_SAMPLES * SAMPLE_S), MODEL_TAIL_HOVER,
+                       &mainDuty, &tailDuty);
+            squares += (climbRate - heli.climbRate) * (climbRate - heli.climbRate);
+            rateSamples++;
+        }
+        modelStep(&heli, mainDuty, tailDuty, (t >= DISTURBANCE_S) ? DISTURBANCE_THRUST : 0, SAMPLE_S);
+
+        if (t < DISTURBANCE_S) {
+            flight->overshoot = fmax(flight->overshoot, heli.altitude - target);
+            if (fabs(heli.altitude - target) > 1.0) {
+                flight->settle = -1;
+            } else if (flight->settle < 0) {
+                flight->settle = t;
+            }
+        } else {
+            flight->dip = fmax(flight->dip, fabs(heli.altitude - target));
+        }
+    }
+    flight->rateError = sqrt(squares / rateSamples);
+}
+
+/** The rate loop on the per-sample estimate flies as the rate loop on the true rate
+    does, and is fed a closer climb rate than the old estimate gave it.  */
+static void testClosedLoop(void)
+{
+    flight_t flight[3];
+
+    for (int source = RATE_TRUE; source <= RATE_OLD; source++) {
+        flyAltitude(source, 20.0, &flight[source]);
+        printf("20%% altitude step on the %s: settles in %.2f s, overshoot %.2f%%, "
+               "%.0f%% main thrust lost dips %.2f%%, climb rate error %.2f %%/s rms\n",
+               rateSourceNames[source], flight[source].settle, flight[source].overshoot, DISTURBANCE_THRUST,
+               flight[source].dip, flight[source].rateError);
+    }
+    CHECK(flight[RATE_NEW].settle > 0);
+    CHECK(fabs(flight[RATE_NEW].settle - flight[RATE_TRUE].settle) < 1.0);
+    CHECK(fabs(flight[RATE_NEW].overshoot - flight[RATE_TRUE].overshoot) < 0.5);
+    CHECK(fabs(flight[RATE_NEW].dip - flight[RATE_TRUE].dip) < 0.5);
+    CHECK(flight[RATE_NEW].rateError < flight[RATE_OLD].rateError);
+}
+
+int main(void)
+{
+    initCircBuf(&circBufADC, BUF_SIZE);
+    initADC();
+    CHECK(hostAdcHandler == ADCIntHandler);
+
+    testRamp();
+    testStepDelay();
+    testBandwidth();
+    testNoise();
+    testClosedLoop();
+    return testReport("test_alt");
+}
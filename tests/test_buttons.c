@@ -0,0 +1,454 @@
+/** @file   test_buttons.c
+    @author Bailey Lissington, Dillon Pike, Joseph Ramirez
+    @date   21 May 2021
+    @brief  Host tests of the button debouncing in buttons4.c: the polled vertical
+            counters against a counter per button, as the loop they replaced kept, on
+            random bouncing traces of every button at once, a switch left on at start
+            up, and the cost of a poll.
+            Then the edge interrupt debouncing: when a bouncing press is taken, that a
+            glitch is not, and the latency from a press to the altitude setpoint
+            stepping against the polled debouncing it replaced.
+*/
+
+#define _POSIX_C_SOURCE 199309L // benchmark clock
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "tivaware.h"
+#include "buttons4.h"
+#include "setpoint.h"
+#include "test.h"
+
+#define TRACE_POLLS 200000
+#define BENCH_POLLS 1000000
+
+#define STEP_US 50 // simulation step of the interrupt tests
+#define STEP_CYCLES (20000000 / 1000000 * STEP_US) // at the stand-ins' 20 MHz clock
+#define POLL_US 10000 // polled debouncing rate, 100 Hz
+#define CONTROL_US 20000 // control task period, 50 Hz
+#define MAX_BOUNCE_US 4000 // longest a contact bounces for
+#define PRESSES 500
+
+// Pin of a button and its level when not pushed
+typedef struct {
+    uint32_t port;
+    uint8_t pin;
+    bool normal;
+} buttonPin_t;
+
+static const buttonPin_t buttonPins[NUM_BUTS] = {
+    {UP_BUT_PORT_BASE, UP_BUT_PIN, UP_BUT_NORMAL},
+    {DOWN_BUT_PORT_BASE, DOWN_BUT_PIN, DOWN_BUT_NORMAL},
+    {LEFT_BUT_PORT_BASE, LEFT_BUT_PIN, LEFT_BUT_NORMAL},
+    {RIGHT_BUT_PORT_BASE, RIGHT_BUT_PIN, RIGHT_BUT_NORMAL},
+    {SWITCH1_BUT_PORT_BASE, SWITCH1_BUT_PIN, SWITCH1_BUT_NORMAL},
+    {RESET_BUT_PORT_BASE, RESET_BUT_PIN, RESET_BUT_NORMAL},
+};
+
+// Debouncer with a counter per button, as updateButtons was before the vertical counters
+static bool refState[NUM_BUTS];
+static uint8_t refCount[NUM_BUTS];
+static bool refFlag[NUM_BUTS];
+
+static uint32_t randomState = 1;
+
+// Interrupt test state
+static bool polled; // debounced by updateButtons rather than the edge interrupts
+static bool controlOn; // control task taking UP's changes
+static uint32_t nowUs;
+static uint32_t nextPollUs, nextControlUs;
+static uint32_t lastEdgeUs; // time of the last change of the UP pin
+static uint32_t changeUs; // time of the last onChange call
+static uint32_t changeCount;
+static setpoint_t altSetpoint;
+static butGesture_t upGesture;
+
+/** Returns a pseudo-random number from a fixed-seed generator.  */
+static uint32_t randomNext(void)
+{
+    randomState = randomState * 1103515245 + 12345;
+    return randomState >> 16;
+}
+
+/** Sets a button's pin high or low.  */
+static void setPin(uint8_t but, bool high)
+{
+    hostGpioSet(buttonPins[but].port, buttonPins[but].pin, high);
+}
+
+/** Puts every pin at its level when not pushed, and starts both debouncers there.  */
+static void resetButtons(void)
+{
+    for (uint8_t but = 0; but < NUM_BUTS; but++) {
+        setPin(but, buttonPins[but].normal);
+        refState[but] = buttonPins[but].normal;
+        refCount[but] = 0;
+        refFlag[but] = false;
+    }
+    initButtons();
+}
+
+/** Polls the reference debouncer once.  */
+static void refUpdate(void)
+{
+    for (uint8_t but = 0; but < NUM_BUTS; but++) {
+        uint8_t polls = ((but == SWITCH1) || (but == RESET)) ? NUM_SWITCH_POLLS : NUM_BUT_POLLS;
+        bool value = GPIOPinRead(buttonPins[but].port, buttonPins[but].pin) != 0;
+
+        if (value != refState[but]) {
+            if (++refCount[but] >= polls) {
+                refState[but] = value;
+                refFlag[but] = true;
+                refCount[but] = 0;
+            }
+        } else {
+            refCount[but] = 0;
+        }
+    }
+}
+
+/** Returns the reference debouncer's change of a button, as checkButton does.  */
+static uint8_t refCheck(uint8_t but)
+{
+    if (!refFlag[but]) {
+        return NO_CHANGE;
+    }
+    refFlag[but] = false;
+    return (refState[but] == buttonPins[but].normal) ? RELEASED : PUSHED;
+}
+
+/** Moves each button's contacts on one poll. A button settled in one position
+    sometimes starts to change, then bounces for a random number of polls, each
+    reading a random level, before settling in the other position.  */
+static void stepContacts(bool target[NUM_BUTS], uint8_t bouncing[NUM_BUTS])
+{
+    for (uint8_t but = 0; but < NUM_BUTS; but++) {
+        if (bouncing[but] > 0) {
+            bouncing[but]--;
+            setPin(but, (bouncing[but] == 0) ? target[but] : (randomNext() & 1));
+        } else if ((randomNext() % 20) == 0) {
+            target[but] = !target[but];
+            bouncing[but] = randomNext() % 8;
+            setPin(but, (bouncing[but] == 0) ? target[but] : (randomNext() & 1));
+        }
+    }
+}
+
+/** On random bouncing traces of every button at once, including bounces shorter
+    than, equal to and longer than the poll counts, the vertical counters change
+    state and report changes on exactly the same polls as a counter per button.  */
+static void testMatchesReference(void)
+{
+    bool target[NUM_BUTS];
+    uint8_t bouncing[NUM_BUTS] = {0};
+    uint32_t stateMismatches = 0, checkMismatches = 0, changes = 0;
+
+    resetButtons();
+    for (uint8_t but = 0; but < NUM_BUTS; but++) {
+        target[but] = buttonPins[but].normal;
+    }
+
+    for (uint32_t poll = 0; poll < TRACE_POLLS; poll++) {
+        stepContacts(target, bouncing);
+        updateButtons();
+        refUpdate();
+
+        // Reads the changes only every few polls sometimes, so flags are held a while
+        bool check = (randomNext() % 3) != 0;
+        for (uint8_t but = 0; but < NUM_BUTS; but++) {
+            stateMismatches += (getState(but) != refState[but]);
+            if (check) {
+                uint8_t result = checkButton(but);
+                checkMismatches += (result != refCheck(but));
+                changes += (result != NO_CHANGE);
+            }
+        }
+    }
+    printf("%d polls of bouncing contacts: %lu changes reported, %lu state and %lu checkButton mismatches\n",
+           TRACE_POLLS, (unsigned long)changes, (unsigned long)stateMismatches, (unsigned long)checkMismatches);
+    CHECK(changes > 1000);
+    CHECK(stateMismatches == 0);
+    CHECK(checkMismatches == 0);
+}
+
+/** A button changes on its NUM_BUT_POLLS-th differing poll and a switch on its
+    NUM_SWITCH_POLLS-th, and a poll reading its old level starts the count again.  */
+static void testPollCounts(void)
+{
+    resetButtons();
+    setPin(UP, !UP_BUT_NORMAL);
+    setPin(SWITCH1, !SWITCH1_BUT_NORMAL);
+    for (uint8_t poll = 1; poll <= NUM_SWITCH_POLLS; poll++) {
+        updateButtons();
+        CHECK(checkButton(UP) == ((poll == NUM_BUT_POLLS) ? PUSHED : NO_CHANGE));
+        CHECK(checkButton(SWITCH1) == ((poll == NUM_SWITCH_POLLS) ? PUSHED : NO_CHANGE));
+    }
+
+    // A bounce back one poll before the count restarts it
+    setPin(UP, UP_BUT_NORMAL);
+    for (uint8_t poll = 1; poll < NUM_BUT_POLLS; poll++) {
+        updateButtons();
+    }
+    setPin(UP, !UP_BUT_NORMAL);
+    updateButtons();
+    setPin(UP, UP_BUT_NORMAL);
+    for (uint8_t poll = 1; poll < NUM_BUT_POLLS; poll++) {
+        updateButtons();
+        CHECK(checkButton(UP) == NO_CHANGE);
+    }
+    updateButtons();
+    CHECK(checkButton(UP) == RELEASED);
+    CHECK(getState(UP) == UP_BUT_NORMAL);
+}
+
+/** A switch already on at start up starts on, and is not reported as turned on, so
+    it cannot launch until it is turned off and on again.  */
+static void testOnAtStartUp(void)
+{
+    resetButtons();
+    setPin(SWITCH1, !SWITCH1_BUT_NORMAL);
+    initButtons();
+    CHECK(getState(SWITCH1) == !SWITCH1_BUT_NORMAL);
+    for (uint8_t poll = 0; poll < NUM_SWITCH_POLLS * 2; poll++) {
+        updateButtons();
+        CHECK(checkButton(SWITCH1) == NO_CHANGE);
+        CHECK(checkButton(UP) == NO_CHANGE);
+    }
+
+    setPin(SWITCH1, SWITCH1_BUT_NORMAL);
+    for (uint8_t poll = 0; poll < NUM_SWITCH_POLLS; poll++) {
+        updateButtons();
+    }
+    CHECK(checkButton(SWITCH1) == RELEASED);
+    setPin(SWITCH1, !SWITCH1_BUT_NORMAL);
+    for (uint8_t poll = 0; poll < NUM_SWITCH_POLLS; poll++) {
+        updateButtons();
+    }
+    CHECK(checkButton(SWITCH1) == PUSHED);
+    resetButtons();
+}
+
+/** Called from the debounce timer interrupt when a button has changed.  */
+static void onChange(void)
+{
+    changeUs = nowUs;
+    changeCount++;
+}
+
+/** Applies UP's changes to the altitude setpoint, as the control task does.  */
+static void controlTask(void)
+{
+    uint8_t state = checkButton(UP);
+
+    if (updateGesture(&upGesture, state, nowUs / 1000) == GESTURE_PRESS) {
+        setpointStep(&altSetpoint, 1, SETPOINT_COARSE);
+    }
+}
+
+/** Moves time on by one step, running the debounce timers, the polls and the control task.  */
+static void step(void)
+{
+    nowUs += STEP_US;
+    hostTimersAdvance(STEP_CYCLES);
+    if (polled && (nowUs >= nextPollUs)) {
+        nextPollUs += POLL_US;
+        updateButtons();
+    }
+    if (controlOn && (nowUs >= nextControlUs)) {
+        nextControlUs += CONTROL_US;
+        controlTask();
+    }
+}
+
+/** Moves time on.  */
+static void runFor(uint32_t us)
+{
+    for (uint32_t t = 0; t < us; t += STEP_US) {
+        step();
+    }
+}
+
+/** Sets UP's pin, noting the time if it changed.  */
+static void movePin(bool high)
+{
+    if ((GPIOPinRead(UP_BUT_PORT_BASE, UP_BUT_PIN) != 0) != high) {
+        setPin(UP, high);
+        lastEdgeUs = nowUs;
+    }
+}
+
+/** Moves UP's contacts to a position, bouncing for a random time first.
+    @param true to push, false to release.  */
+static void bounceTo(bool pushed)
+{
+    bool level = pushed ? !UP_BUT_NORMAL : UP_BUT_NORMAL;
+    uint32_t endUs = nowUs + randomNext() % (MAX_BOUNCE_US + 1);
+    bool bounce = level;
+
+    while (nowUs < endUs) {
+        movePin(bounce);
+        runFor(STEP_US * (2 + randomNext() % 10)); // 100 to 550 us between edges
+        bounce = !bounce;
+    }
+    movePin(level);
+}
+
+// Latency from a press starting until the setpoint steps, in us
+typedef struct {
+    uint32_t max;
+    double mean;
+    uint32_t missed; // presses that did not step the setpoint once
+} latency_t;
+
+/** Presses UP PRESSES times, each bouncing for a random time and held 200 ms, and
+    released for long enough that the next is not a double press.  */
+static void measureLatency(latency_t* latency)
+{
+    uint64_t total = 0;
+    latency->max = latency->missed = 0;
+
+    controlOn = true;
+    nextControlUs = nowUs + CONTROL_US;
+    setpointInit(&altSetpoint, 0, 0, INT16_MAX, 1, 1, 1, 0);
+    initGesture(&upGesture);
+    for (int press = 0; press < PRESSES; press++) {
+        int16_t before = setpointGet(&altSetpoint);
+        uint32_t startUs = nowUs;
+        uint32_t steppedUs = 0;
+
+        bounceTo(true);
+        while ((nowUs - startUs) < 200000) {
+            step();
+            if ((steppedUs == 0) && (setpointGet(&altSetpoint) != before)) {
+                steppedUs = nowUs;
+            }
+        }
+        bounceTo(false);
+        runFor(BUT_DOUBLE_PRESS_MS * 1000 + 100000 + randomNext() % CONTROL_US);
+
+        if (setpointGet(&altSetpoint) != before + 1) {
+            latency->missed++;
+        } else {
+            total += steppedUs - startUs;
+            if ((steppedUs - startUs) > latency->max) {
+                latency->max = steppedUs - startUs;
+            }
+        }
+    }
+    latency->mean = (double)total / (PRESSES - latency->missed);
+    controlOn = false;
+}
+
+/** Polled at 100 Hz, every press steps the setpoint once.  */
+static void testPolledLatency(latency_t* latency)
+{
+    resetButtons();
+    polled = true;
+    nextPollUs = nowUs + POLL_US;
+    measureLatency(latency);
+    polled = false;
+    CHECK(latency->missed == 0);
+}
+
+/** With the edge interrupts on, a press is taken BUT_DEBOUNCE_MS after its last
+    bounce, and only once however long it bounced.  */
+static void testEdgeDebounce(void)
+{
+    uint32_t wrongTimes = 0, wrongCounts = 0;
+
+    for (int press = 0; press < 100; press++) {
+        changeCount = 0;
+        bounceTo(press % 2 == 0);
+        runFor(50000);
+        wrongTimes += ((changeUs - lastEdgeUs) < BUT_DEBOUNCE_MS * 1000)
+                      || ((changeUs - lastEdgeUs) > BUT_DEBOUNCE_MS * 1000 + STEP_US);
+        wrongCounts += (changeCount != 1);
+        CHECK(checkButton(UP) == ((press % 2 == 0) ? PUSHED : RELEASED));
+    }
+    CHECK(wrongTimes == 0);
+    CHECK(wrongCounts == 0);
+    CHECK(!hostTimerRunning(BUT_DEBOUNCE_TIMER_BASE));
+}
+
+/** A glitch shorter than the debounce time is not taken, and a switch edge waits
+    for the switch debounce time.  */
+static void testGlitch(void)
+{
+    changeCount = 0;
+    setPin(UP, !UP_BUT_NORMAL);
+    runFor(1000);
+    setPin(UP, UP_BUT_NORMAL);
+    runFor(50000);
+    CHECK(changeCount == 0);
+    CHECK(checkButton(UP) == NO_CHANGE);
+
+    uint32_t edgeUs = nowUs;
+    setPin(SWITCH1, !SWITCH1_BUT_NORMAL);
+    runFor(50000);
+    CHECK(changeCount == 1);
+    CHECK((changeUs - edgeUs) >= SWITCH_DEBOUNCE_MS * 1000);
+    CHECK((changeUs - edgeUs) <= SWITCH_DEBOUNCE_MS * 1000 + STEP_US);
+    CHECK(checkButton(SWITCH1) == PUSHED);
+    setPin(SWITCH1, SWITCH1_BUT_NORMAL);
+    runFor(50000);
+    CHECK(checkButton(SWITCH1) == RELEASED);
+}
+
+/** With the edge interrupts on, every press steps the setpoint once, sooner than polling did.  */
+static void testEdgeLatency(const latency_t* polledLatency)
+{
+    latency_t latency;
+
+    measureLatency(&latency);
+    printf("press to setpoint step, contacts bouncing up to %d ms, 50 Hz control task: "
+           "edge interrupts mean %.1f ms, max %.1f ms; 100 Hz polling mean %.1f ms, max %.1f ms\n",
+           MAX_BOUNCE_US / 1000, latency.mean / 1000, latency.max / 1000.0,
+           polledLatency->mean / 1000, polledLatency->max / 1000.0);
+    CHECK(latency.missed == 0);
+    CHECK(latency.max <= MAX_BOUNCE_US + 550 + BUT_DEBOUNCE_MS * 1000 + CONTROL_US + STEP_US);
+    CHECK(latency.mean < polledLatency->mean);
+}
+
+/** Time a poll takes with the vertical counters and with a counter per button.  */
+static void testBench(void)
+{
+    resetButtons();
+    uint64_t start = testNowNs();
+    for (uint32_t poll = 0; poll < BENCH_POLLS; poll++) {
+        setPin(poll % NUM_BUTS, poll & 8);
+        updateButtons();
+    }
+    double verticalNs = (double)(testNowNs() - start) / BENCH_POLLS;
+
+    start = testNowNs();
+    for (uint32_t poll = 0; poll < BENCH_POLLS; poll++) {
+        setPin(poll % NUM_BUTS, poll & 8);
+        refUpdate();
+    }
+    double referenceNs = (double)(testNowNs() - start) / BENCH_POLLS;
+
+    printf("poll of %d buttons, with a pin change: vertical counters %.1f ns, counter per button %.1f ns\n",
+           NUM_BUTS, verticalNs, referenceNs);
+    CHECK(verticalNs > 0);
+}
+
+int main(void)
+{
+    testPollCounts();
+    testOnAtStartUp();
+    testMatchesReference();
+    testBench();
+
+    latency_t polledLatency;
+    testPolledLatency(&polledLatency);
+
+    initButtonInts(onChange);
+    runFor(SWITCH_DEBOUNCE_MS * 1000 * 2); // takes the levels at start up
+    checkButton(UP); // drops any change left from the polled tests
+    testEdgeDebounce();
+    testGlitch();
+    testEdgeLatency(&polledLatency);
+    return testReport("test_buttons");
+}
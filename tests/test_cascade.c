@@ -0,0 +1,243 @@
+/** @file   test_cascade.c
+    @author Bailey Lissington, Dillon Pike, Joseph Ramirez
+    @date   21 May 2021
+    @brief  Host simulation of the cascaded main and tail controllers on the identified
+            model: step responses, and rejection of a torque disturbance on the tail
+            against the single-loop PI controllers they replaced, and the limit cycle
+            at hover with the duty truncated to whole percent against Q16.
+*/
+
+#include <stdio.h>
+#include <stdbool.h>
+
+#include "pi.h"
+#include "test.h"
+#include "model.h"
+
+#define RATE_STEP_S 0.01 // inner rate loop period
+#define OUTER_STEPS 2 // rate loop periods per outer loop period, 50 Hz
+#define SINGLE_LOOP_STEPS 10 // rate loop periods per single-loop PI period, the old 10 Hz background loop
+#define RUN_S 20.0
+#define DISTURBANCE_S 5.0 // time the disturbance is applied at
+#define MAIN_TORQUE_STEP 10.0 // main thrust step that disturbs the yaw through rotor torque, in %
+#define YAW_BAND 2.0 // yaw error counted as settled, in degrees
+#define ALT_BAND 1.0 // altitude error counted as settled, in %
+#define HOVER_S 60.0 // time held at hover, the oscillation measured over the second half
+#define HOVER_ALT 20.0 // altitude held at hover in %
+
+// Single-loop position PI gains the cascade replaced
+#define SINGLE_MAIN_KP 0.6
+#define SINGLE_MAIN_KI 0.4
+#define SINGLE_TAIL_KP 0.43
+#define SINGLE_TAIL_KI 0.25
+
+// Response of one loop to a step or a disturbance
+typedef struct {
+    double settle; // time until the error stays within the band, in s
+    double overshoot; // largest error past the target
+    double peak; // largest error after the disturbance
+} response_t;
+
+static double singleMainIntegral, singleTailIntegral;
+
+/** The single-loop PI with conditional integration the cascade replaced.  */
+static double singlePiCompute(double error, double kp, double ki, double* integral, double deltaT)
+{
+    double deltaI = error * deltaT;
+    double control = error * kp + (*integral + deltaI) * ki;
+
+    if (control < PI_MIN) {
+        control = PI_MIN;
+    } else if (control > PI_MAX) {
+        control = PI_MAX;
+    } else {
+        *integral += deltaI;
+    }
+    return control;
+}
+
+/** Records the error of one sample in a response.  */
+static void recordError(response_t* r, double t, double error, double target, double band, bool disturbed)
+{
+    if (fabs(error) > band) {
+        r->settle = -1;
+    } else if (r->settle < 0) {
+        r->settle = t;
+    }
+    if ((target != 0) && (-error * target / fabs(target) > r->overshoot)) {
+        r->overshoot = -error * target / fabs(target);
+    }
+    if (disturbed && (fabs(error) > r->peak)) {
+        r->peak = fabs(error);
+    }
+}
+
+/** Flies the model from hover at 0 to an altitude and yaw target, then steps the
+    main thrust to disturb the yaw at DISTURBANCE_S if asked.
+    @param true for the cascade, false for the single-loop PI controllers.
+    @param altitude target in %.
+    @param yaw target in degrees.
+    @param true to step the main thrust by MAIN_TORQUE_STEP at DISTURBANCE_S.
+    @param address to store the altitude response.
+    @param address to store the yaw response. Settling is timed from the disturbance if there is one.  */
+static void fly(bool cascade, double altTarget, double yawTarget, bool disturb, response_t* alt, response_t* yaw)
+{
+    model_t heli = {0};
+    double setClimbRate = 0, setYawRate = 0;
+    double mainCommand = MODEL_MAIN_HOVER, tailCommand = MODEL_TAIL_HOVER, mainDuty, tailDuty;
+    alt->settle = yaw->settle = -1;
+    alt->overshoot = yaw->overshoot = alt->peak = yaw->peak = 0;
+
+    mainRatePiTransfer(0, 0, MODEL_MAIN_HOVER);
+    tailRatePiTransfer(0, 0, MODEL_TAIL_HOVER);
+    singleMainIntegral = MODEL_MAIN_HOVER / SINGLE_MAIN_KI;
+    singleTailIntegral = MODEL_TAIL_HOVER / SINGLE_TAIL_KI;
+    modelShapeInit((uint32_t)(1 / RATE_STEP_S), MODEL_MAIN_HOVER, MODEL_TAIL_HOVER);
+
+    for (int i = 0; i < (int)(RUN_S / RATE_STEP_S); i++) {
+        double t = i * RATE_STEP_S;
+        bool disturbed = disturb && (t >= DISTURBANCE_S);
+
+        if (cascade) {
+            if ((i % OUTER_STEPS) == 0) {
+                setClimbRate = mainAltitudeCompute(altTarget, heli.altitude, 0);
+                setYawRate = tailAngleCompute(yawTarget, heli.yaw, 0);
+            }
+            mainCommand = mainRatePiCompute(setClimbRate, heli.climbRate, 0, RATE_STEP_S);
+            tailCommand = tailRatePiCompute(setYawRate, heli.yawRate, RATE_STEP_S);
+        } else if ((i % SINGLE_LOOP_STEPS) == 0) {
+            double deltaT = SINGLE_LOOP_STEPS * RATE_STEP_S;
+            mainCommand = singlePiCompute(altTarget - heli.altitude, SINGLE_MAIN_KP, SINGLE_MAIN_KI, &singleMainIntegral, deltaT);
+            tailCommand = singlePiCompute(yawTarget - heli.yaw, SINGLE_TAIL_KP, SINGLE_TAIL_KI, &singleTailIntegral, deltaT);
+        }
+        // Both rotors are shaped every rate loop period, as the rate task does. The disturbance
+        // adds main rotor torque, but is taken off the lift so the altitude holds
+        modelShape(mainCommand, tailCommand, &mainDuty, &tailDuty);
+        if (disturbed) {
+            modelStepThrust(&heli, modelThrust(mainDuty, ACTUATOR_MAIN_DEADBAND) + MAIN_TORQUE_STEP,
+                            modelThrust(tailDuty, ACTUATOR_TAIL_DEADBAND), MAIN_TORQUE_STEP, RATE_STEP_S);
+        } else {
+            modelStep(&heli, mainDuty, tailDuty, 0, RATE_STEP_S);
+        }
+
+        double tFrom = disturb ? t - DISTURBANCE_S : t;
+        recordError(alt, tFrom, altTarget - heli.altitude, altTarget, ALT_BAND, disturbed);
+        if (!disturb || disturbed) {
+            recordError(yaw, tFrom, yawTarget - heli.yaw, yawTarget, YAW_BAND, disturbed);
+        }
+    }
+}
+
+/** Holds the model at hover, with the duties that reach the rotors truncated to whole
+    percent as the uint8_t duties in main.c were, or carried at Q16.
+    @param true for the cascade, false for the single-loop PI controllers.
+    @param true to truncate the duties to whole percent.
+    @param address to store the peak to peak altitude in %.
+    @param address to store the peak to peak yaw in degrees.  */
+static void hover(bool cascade, bool wholePercent, double* altSwing, double* yawSwing)
+{
+    model_t heli = {.altitude = HOVER_ALT};
+    double setClimbRate = 0, setYawRate = 0;
+    double mainCommand = MODEL_MAIN_HOVER, tailCommand = MODEL_TAIL_HOVER, mainDuty, tailDuty;
+    double altMin = HOVER_ALT, altMax = HOVER_ALT, yawMin = 0, yawMax = 0;
+
+    mainRatePiTransfer(0, 0, MODEL_MAIN_HOVER);
+    tailRatePiTransfer(0, 0, MODEL_TAIL_HOVER);
+    singleMainIntegral = MODEL_MAIN_HOVER / SINGLE_MAIN_KI;
+    singleTailIntegral = MODEL_TAIL_HOVER / SINGLE_TAIL_KI;
+    modelShapeInit((uint32_t)(1 / RATE_STEP_S), MODEL_MAIN_HOVER, MODEL_TAIL_HOVER);
+
+    for (int i = 0; i < (int)(HOVER_S / RATE_STEP_S); i++) {
+        if (cascade) {
+            if ((i % OUTER_STEPS) == 0) {
+                setClimbRate = mainAltitudeCompute(HOVER_ALT, heli.altitude, 0);
+                setYawRate = tailAngleCompute(0, heli.yaw, 0);
+            }
+            mainCommand = mainRatePiCompute(setClimbRate, heli.climbRate, 0, RATE_STEP_S);
+            tailCommand = tailRatePiCompute(setYawRate, heli.yawRate, RATE_STEP_S);
+        } else if ((i % SINGLE_LOOP_STEPS) == 0) {
+            double deltaT = SINGLE_LOOP_STEPS * RATE_STEP_S;
+            mainCommand = singlePiCompute(HOVER_ALT - heli.altitude, SINGLE_MAIN_KP, SINGLE_MAIN_KI, &singleMainIntegral, deltaT);
+            tailCommand = singlePiCompute(-heli.yaw, SINGLE_TAIL_KP, SINGLE_TAIL_KI, &singleTailIntegral, deltaT);
+        }
+        modelShape(mainCommand, tailCommand, &mainDuty, &tailDuty);
+        if (wholePercent) {
+            mainDuty = floor(mainDuty);
+            tailDuty = floor(tailDuty);
+        }
+        modelStep(&heli, mainDuty, tailDuty, 0, RATE_STEP_S);
+
+        if (i >= (int)(HOVER_S / RATE_STEP_S / 2)) {
+            altMin = fmin(altMin, heli.altitude);
+            altMax = fmax(altMax, heli.altitude);
+            yawMin = fmin(yawMin, heli.yaw);
+            yawMax = fmax(yawMax, heli.yaw);
+        }
+    }
+    *altSwing = altMax - altMin;
+    *yawSwing = yawMax - yawMin;
+}
+
+/** Both cascaded loops settle on a step sooner, and overshoot less, than the single loops.  */
+static void testStepResponse(void)
+{
+    response_t alt, yaw, singleAlt, singleYaw;
+
+    fly(true, 20.0, 60.0, false, &alt, &yaw);
+    fly(false, 20.0, 60.0, false, &singleAlt, &singleYaw);
+    printf("20%% altitude step: cascade settles in %.2f s, overshoot %.2f%%; single loop %.2f s, %.2f%%\n",
+           alt.settle, alt.overshoot, singleAlt.settle, singleAlt.overshoot);
+    printf("60 degree yaw step: cascade settles in %.2f s, overshoot %.2f degrees; single loop %.2f s, %.2f degrees\n",
+           yaw.settle, yaw.overshoot, singleYaw.settle, singleYaw.overshoot);
+    CHECK(alt.settle > 0);
+    CHECK(yaw.settle > 0);
+    CHECK(alt.settle < singleAlt.settle);
+    CHECK(yaw.settle < singleYaw.settle);
+    CHECK(alt.overshoot < singleAlt.overshoot);
+    CHECK(yaw.overshoot < singleYaw.overshoot);
+}
+
+/** A main rotor torque step disturbs the yaw less, and for less time, with the inner rate loop.  */
+static void testDisturbanceRejection(void)
+{
+    response_t alt, yaw, singleAlt, singleYaw;
+
+    fly(true, 0, 0, true, &alt, &yaw);
+    fly(false, 0, 0, true, &singleAlt, &singleYaw);
+    printf("%.0f%% main torque step: cascade yaw peaks at %.2f degrees, recovers in %.2f s; "
+           "single loop peaks at %.2f degrees, recovers in %.2f s\n",
+           MAIN_TORQUE_STEP, yaw.peak, yaw.settle, singleYaw.peak, singleYaw.settle);
+    CHECK(yaw.settle >= 0);
+    CHECK(yaw.peak < singleYaw.peak);
+    CHECK(yaw.settle < singleYaw.settle);
+}
+
+/** Duties truncated to whole percent cannot give the hover thrusts, so the integrators
+    hunt between the steps either side and the altitude and yaw cycle around the target.
+    Carried at Q16, the duties reach the hover thrusts and the cycle dies away, with the
+    single-loop controllers the truncation was written for and with the cascade, whose
+    100 Hz rate loop dithers between the steps and keeps the cycle small either way.  */
+static void testHoverLimitCycle(void)
+{
+    const char* names[] = {"single loop", "cascade"};
+
+    for (unsigned cascade = 0; cascade < 2; cascade++) {
+        double altSwing, yawSwing, wholeAltSwing, wholeYawSwing;
+
+        hover(cascade, false, &altSwing, &yawSwing);
+        hover(cascade, true, &wholeAltSwing, &wholeYawSwing);
+        printf("%s hover at %.0f%%: whole percent duty cycles %.4f%% altitude, %.4f degrees yaw peak to peak; "
+               "Q16 duty %.4f%%, %.4f degrees\n",
+               names[cascade], HOVER_ALT, wholeAltSwing, wholeYawSwing, altSwing, yawSwing);
+        CHECK(altSwing < wholeAltSwing / 10);
+        CHECK(yawSwing < wholeYawSwing / 10);
+    }
+}
+
+int main(void)
+{
+    testStepResponse();
+    testDisturbanceRejection();
+    testHoverLimitCycle();
+    return testReport("test_cascade");
+}
@@ -0,0 +1,148 @@
+/** @file   test_dob.c
+    @author Bailey Lissington, Dillon Pike, Joseph Ramirez
+    @date   21 May 2021
+    @brief  Host simulation of the disturbance observer on the cascaded main controller:
+            recovery from a disturbance that saturates the main duty, with the observer's
+            compensation constrained inside the rate PI against the subtraction after it
+            that wound the integral up, and step and ramp disturbances with the observer
+            on and off.
+*/
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <math.h>
+
+#include "dob.h"
+#include "pi.h"
+#include "test.h"
+#include "model.h"
+
+#define RATE_STEP_S 0.01 // rate loop period the observer is updated at
+#define OUTER_STEPS 2 // rate loop periods per altitude loop period, 50 Hz
+#define MODEL_STEPS 10 // model steps per rate loop period
+#define TARGET_ALT 20.0
+#define RUN_S 20.0
+#define DISTURBANCE_S 5.0 // time the disturbance starts at
+#define SATURATE_END_S 8.0 // time the saturating disturbance is removed at
+#define RAMP_S 5.0 // time the ramp disturbance takes to reach its size
+#define SETTLE_BAND 1.0 // altitude error counted as recovered, in %
+
+typedef enum {DOB_OFF = 0, DOB_AFTER_PI, DOB_IN_PI} dobMode_t;
+static const char* dobModeNames[] = {"observer off", "subtracted after the PI", "compensated in the PI"};
+
+typedef enum {DISTURBANCE_SATURATING = 0, DISTURBANCE_STEP, DISTURBANCE_RAMP} disturbance_t;
+
+// Altitude response to a disturbance
+typedef struct {
+    double peak; // largest error from the target, in %
+    double overshoot; // largest altitude above the target, in %
+    double recovery; // time from the end of the disturbance's change until the error stays in the band, in s
+} response_t;
+
+/** Main thrust lost to a disturbance at a time, in %.  */
+static double disturbanceAt(disturbance_t disturbance, double t)
+{
+    switch (disturbance) {
+    case DISTURBANCE_SATURATING: // needs more thrust than PI_MAX for a while
+        return ((t >= DISTURBANCE_S) && (t < SATURATE_END_S)) ? 62.0 : 0;
+    case DISTURBANCE_STEP:
+        return (t >= DISTURBANCE_S) ? 10.0 : 0;
+    default:
+        return (t < DISTURBANCE_S) ? 0 : 10.0 * fmin((t - DISTURBANCE_S) / RAMP_S, 1.0);
+    }
+}
+
+/** Holds the model at TARGET_ALT with the cascaded main controller through a disturbance.
+    @param how the observer's estimate reaches the duty.
+    @param disturbance to apply.
+    @param address to store the response.  */
+static void hold(dobMode_t mode, disturbance_t disturbance, response_t* r)
+{
+    model_t heli = {TARGET_ALT, 0, 0, 0};
+    double setRate = 0, duty = MODEL_MAIN_HOVER, mainDuty, tailDuty;
+    int32_t estimate = 0;
+    double settledFrom = (disturbance == DISTURBANCE_SATURATING) ? SATURATE_END_S
+                       : (disturbance == DISTURBANCE_RAMP) ? DISTURBANCE_S + RAMP_S : DISTURBANCE_S;
+    r->peak = r->overshoot = 0;
+    r->recovery = -1;
+
+    mainRatePiTransfer(0, 0, duty);
+    dobInit(RATE_STEP_S);
+    dobReset(DOB_TO_Q(duty), 0);
+    modelShapeInit((uint32_t)(1 / RATE_STEP_S), duty, MODEL_TAIL_HOVER);
+
+    for (int i = 0; i < (int)(RUN_S / RATE_STEP_S); i++) {
+        double t = i * RATE_STEP_S;
+
+        if ((i % OUTER_STEPS) == 0) {
+            setRate = mainAltitudeCompute(TARGET_ALT, heli.altitude, 0);
+        }
+        if (mode == DOB_IN_PI) {
+            duty = mainRatePiCompute(setRate, heli.climbRate, -DOB_FROM_Q(estimate), RATE_STEP_S);
+        } else {
+            duty = mainRatePiCompute(setRate, heli.climbRate, 0, RATE_STEP_S);
+            if (mode == DOB_AFTER_PI) { // as the rate loop applied the estimate before
+                duty = fmin(fmax(duty - DOB_FROM_Q(estimate), PI_MIN), PI_MAX);
+            }
+        }
+        if (mode != DOB_OFF) {
+            estimate = dobUpdate(DOB_TO_Q(duty), DOB_TO_Q(heli.climbRate));
+        }
+        modelShape(duty, MODEL_TAIL_HOVER, &mainDuty, &tailDuty);
+        for (int j = 0; j < MODEL_STEPS; j++) {
+            modelStep(&heli, mainDuty, tailDuty, disturbanceAt(disturbance, t), RATE_STEP_S / MODEL_STEPS);
+        }
+
+        double error = heli.altitude - TARGET_ALT;
+        r->peak = fmax(r->peak, fabs(error));
+        if (t >= settledFrom) {
+            r->overshoot = fmax(r->overshoot, error);
+            if (fabs(error) > SETTLE_BAND) {
+                r->recovery = -1;
+            } else if (r->recovery < 0) {
+                r->recovery = t - settledFrom;
+            }
+        }
+    }
+}
+
+/** With the compensation inside the PI, the integral stops winding up while the duty is
+    saturated, so the altitude comes back without the overshoot the wound-up integral caused.  */
+static void testSaturationRecovery(void)
+{
+    response_t r[3];
+
+    for (int mode = DOB_OFF; mode <= DOB_IN_PI; mode++) {
+        hold(mode, DISTURBANCE_SATURATING, &r[mode]);
+        printf("saturating disturbance, %s: drops %.2f%%, overshoots %.2f%% once removed, recovers in %.2f s\n",
+               dobModeNames[mode], r[mode].peak, r[mode].overshoot, r[mode].recovery);
+    }
+    CHECK(r[DOB_IN_PI].recovery > 0);
+    CHECK(r[DOB_IN_PI].overshoot < r[DOB_AFTER_PI].overshoot);
+    CHECK(r[DOB_IN_PI].recovery < r[DOB_AFTER_PI].recovery);
+}
+
+/** The observer holds the altitude closer through step and ramp disturbances.  */
+static void testRejection(void)
+{
+    const disturbance_t disturbances[] = {DISTURBANCE_STEP, DISTURBANCE_RAMP};
+    const char* names[] = {"10% step", "10% ramp"};
+
+    for (unsigned i = 0; i < sizeof(disturbances) / sizeof(disturbances[0]); i++) {
+        response_t off, on;
+        hold(DOB_OFF, disturbances[i], &off);
+        hold(DOB_IN_PI, disturbances[i], &on);
+        printf("%s disturbance: observer off drops %.2f%%, recovers in %.2f s; on drops %.2f%%, recovers in %.2f s\n",
+               names[i], off.peak, off.recovery, on.peak, on.recovery);
+        CHECK(on.recovery >= 0);
+        CHECK(on.peak < off.peak);
+    }
+}
+
+int main(void)
+{
+    testSaturationRecovery();
+    testRejection();
+    return testReport("test_dob");
+}
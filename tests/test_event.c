@@ -0,0 +1,218 @@
+/** @file   test_event.c
+    @author Bailey Lissington, Dillon Pike, Joseph Ramirez
+    @date   21 May 2021
+    @brief  Host tests of the event queues: order, dropping when full, the free-running
+            uint8_t indices wrapping, and a producer and consumer on separate threads
+            standing in for an interrupt handler and the control task.
+*/
+
+#define _POSIX_C_SOURCE 199309L // nanosleep and the benchmark clock
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include <time.h>
+
+#include "event.h"
+#include "test.h"
+
+#define STRESS_EVENTS 200000 // events the producer thread posts, wrapping the indices many times
+#define STRESS_STALL_EVERY 20000 // events the consumer takes between stalls
+#define STRESS_STALL_NS 1000000 // consumer stall, long enough for the queue to fill
+#define YIELD_NS 1000 // wait that gives the other thread a turn on a single core
+
+static eventQueue_t queue;
+
+// Stress run state. Each event posted carries the count of events posted before it
+static volatile bool producerDone;
+static uint32_t posted;
+static uint32_t attempts;
+static uint32_t received;
+static uint32_t outOfOrder;
+static uint32_t torn;
+
+/** Posts an event carrying a sequence number, with its low byte repeated in the type
+    so a torn event is seen.  */
+static bool postSequence(uint32_t sequence)
+{
+    return eventPost(&queue, (uint8_t)~sequence, (uint8_t)(sequence >> 16), (int16_t)(uint16_t)sequence);
+}
+
+/** Gives the other thread a turn. sched.h here is the scheduler's, so this sleeps briefly
+    rather than calling sched_yield.  */
+static void yield(void)
+{
+    const struct timespec wait = {0, YIELD_NS};
+    nanosleep(&wait, NULL);
+}
+
+/** Returns the sequence number an event carries.  */
+static uint32_t eventSequence(const event_t* event)
+{
+    return ((uint32_t)event->source << 16) | (uint16_t)event->value;
+}
+
+/** Events come out in the order posted, with their type, source and value.  */
+static void testOrder(void)
+{
+    event_t event;
+
+    eventQueueInit(&queue);
+    CHECK(!eventGet(&queue, &event));
+    CHECK(eventPost(&queue, EVENT_BUTTON_CHANGED, 3, 1));
+    CHECK(eventPost(&queue, EVENT_SWITCH_CHANGED, 4, -2));
+    CHECK(eventPost(&queue, EVENT_REF_YAW_FOUND, 0, 0));
+
+    CHECK(eventGet(&queue, &event));
+    CHECK((event.type == EVENT_BUTTON_CHANGED) && (event.source == 3) && (event.value == 1));
+    CHECK(eventGet(&queue, &event));
+    CHECK((event.type == EVENT_SWITCH_CHANGED) && (event.source == 4) && (event.value == -2));
+    CHECK(eventGet(&queue, &event));
+    CHECK(event.type == EVENT_REF_YAW_FOUND);
+    CHECK(!eventGet(&queue, &event));
+    CHECK(queue.dropped == 0);
+}
+
+/** A full queue drops and counts new events, keeping the ones it holds.  */
+static void testFull(void)
+{
+    event_t event;
+
+    eventQueueInit(&queue);
+    for (uint32_t i = 0; i < EVENT_QUEUE_SIZE; i++) {
+        CHECK(postSequence(i));
+    }
+    CHECK(!postSequence(100));
+    CHECK(!postSequence(101));
+    CHECK(queue.dropped == 2);
+
+    // Room for one more once one is taken
+    CHECK(eventGet(&queue, &event));
+    CHECK(eventSequence(&event) == 0);
+    CHECK(postSequence(EVENT_QUEUE_SIZE));
+    CHECK(!postSequence(102));
+    CHECK(queue.dropped == 3);
+
+    for (uint32_t i = 1; i <= EVENT_QUEUE_SIZE; i++) {
+        CHECK(eventGet(&queue, &event));
+        CHECK(eventSequence(&event) == i);
+    }
+    CHECK(!eventGet(&queue, &event));
+}
+
+/** The indices wrap from 255 to 0 without losing, repeating or dropping events, both
+    one at a time and with the queue full across the wrap.  */
+static void testIndexWrap(void)
+{
+    event_t event;
+    bool inOrder = true;
+
+    eventQueueInit(&queue);
+    for (uint32_t i = 0; i < 1000; i++) {
+        postSequence(i);
+        inOrder = inOrder && eventGet(&queue, &event) && (eventSequence(&event) == i);
+    }
+    CHECK(inOrder);
+    CHECK(queue.head == (uint8_t)1000);
+    CHECK(queue.tail == queue.head);
+
+    // Head wraps past the tail's value while the queue fills
+    eventQueueInit(&queue);
+    queue.head = queue.tail = 256 - EVENT_QUEUE_SIZE / 2;
+    for (uint32_t i = 0; i < EVENT_QUEUE_SIZE; i++) {
+        CHECK(postSequence(i));
+    }
+    CHECK(queue.head == EVENT_QUEUE_SIZE / 2);
+    CHECK(!postSequence(100));
+    CHECK(queue.dropped == 1);
+    for (uint32_t i = 0; i < EVENT_QUEUE_SIZE; i++) {
+        CHECK(eventGet(&queue, &event));
+        CHECK(eventSequence(&event) == i);
+    }
+    CHECK(!eventGet(&queue, &event));
+}
+
+/** Posts STRESS_EVENTS events, as fast as the queue takes them. Yields when the queue
+    is full, as the test may share one core with the consumer.  */
+static void* producer(void* arg)
+{
+    (void)arg;
+    while (posted < STRESS_EVENTS) {
+        attempts++;
+        if (postSequence(posted)) {
+            posted++;
+        } else {
+            yield();
+        }
+    }
+    producerDone = true;
+    return NULL;
+}
+
+/** Takes events until the producer is done and the queue is empty, stalling now and
+    then so the queue fills.  */
+static void* consumer(void* arg)
+{
+    const struct timespec stall = {0, STRESS_STALL_NS};
+    event_t event;
+    (void)arg;
+
+    while (true) {
+        bool done = producerDone;
+        if (!eventGet(&queue, &event)) {
+            if (done) {
+                break;
+            }
+            yield();
+            continue;
+        }
+        uint32_t sequence = eventSequence(&event);
+        if (sequence != (received & 0xFFFFFF)) {
+            outOfOrder++;
+        }
+        if (event.type != (uint8_t)~sequence) {
+            torn++;
+        }
+        if ((++received % STRESS_STALL_EVERY) == 0) {
+            nanosleep(&stall, NULL);
+        }
+    }
+    return NULL;
+}
+
+/** With the producer and consumer on separate threads, every event posted is taken
+    whole and in order, and every other post is counted as dropped.  */
+static void testThreads(void)
+{
+    pthread_t producerThread, consumerThread;
+
+    eventQueueInit(&queue);
+    producerDone = false;
+    posted = attempts = received = outOfOrder = torn = 0;
+
+    uint64_t start = testNowNs();
+    CHECK(pthread_create(&consumerThread, NULL, consumer, NULL) == 0);
+    CHECK(pthread_create(&producerThread, NULL, producer, NULL) == 0);
+    pthread_join(producerThread, NULL);
+    pthread_join(consumerThread, NULL);
+    double ms = (testNowNs() - start) / 1e6;
+
+    printf("two threads, %lu posts in %.1f ms: %lu taken, %lu dropped, %lu out of order, %lu torn\n",
+           (unsigned long)attempts, ms, (unsigned long)received, (unsigned long)queue.dropped,
+           (unsigned long)outOfOrder, (unsigned long)torn);
+    CHECK(received == STRESS_EVENTS);
+    CHECK(posted + queue.dropped == attempts);
+    CHECK(queue.dropped > 0);
+    CHECK(outOfOrder == 0);
+    CHECK(torn == 0);
+}
+
+int main(void)
+{
+    testOrder();
+    testFull();
+    testIndexWrap();
+    testThreads();
+    return testReport("test_event");
+}
@@ -0,0 +1,162 @@
+/** @file   test_gesture.c
+    @author Bailey Lissington, Dillon Pike, Joseph Ramirez
+    @date   21 May 2021
+    @brief  Host tests of the button gestures in buttons4.c: press, double press, long
+            press and the accelerating repeats, at the times buttons4.h sets, when
+            updated at the control task's rate and across the wrap of the ms clock.
+*/
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "buttons4.h"
+#include "test.h"
+
+#define CONTROL_MS 20 // period the control task updates the gestures at, 50 Hz
+
+static butGesture_t gesture;
+
+/** Holds a button from a time for a while, updating its gesture every ms.
+    @param time the press starts at in ms.
+    @param time it is held for in ms.
+    @param times the repeats are given at, filled in.
+    @param room in times.
+    @return number of long presses and repeats given.  */
+static uint8_t hold(uint32_t startMs, uint32_t holdMs, uint32_t* times, uint8_t maxTimes)
+{
+    uint8_t count = 0;
+
+    updateGesture(&gesture, PUSHED, startMs);
+    for (uint32_t t = 1; t < holdMs; t++) {
+        uint8_t result = updateGesture(&gesture, NO_CHANGE, startMs + t);
+        if (result != GESTURE_NONE) {
+            CHECK(result == ((count == 0) ? GESTURE_LONG_PRESS : GESTURE_REPEAT));
+            if (count < maxTimes) {
+                times[count] = t;
+            }
+            count++;
+        }
+    }
+    updateGesture(&gesture, RELEASED, startMs + holdMs);
+    return count;
+}
+
+/** A push gives a press at once, and a release or an idle button gives nothing.  */
+static void testPress(void)
+{
+    initGesture(&gesture);
+    CHECK(updateGesture(&gesture, NO_CHANGE, 0) == GESTURE_NONE);
+    CHECK(updateGesture(&gesture, PUSHED, 10) == GESTURE_PRESS);
+    CHECK(updateGesture(&gesture, NO_CHANGE, 100) == GESTURE_NONE);
+    CHECK(updateGesture(&gesture, RELEASED, 150) == GESTURE_NONE);
+    CHECK(updateGesture(&gesture, NO_CHANGE, 5000) == GESTURE_NONE);
+}
+
+/** A second press within BUT_DOUBLE_PRESS_MS of a short press's release is a double
+    press, and a third starts afresh.  */
+static void testDoublePress(void)
+{
+    initGesture(&gesture);
+    updateGesture(&gesture, PUSHED, 1000);
+    updateGesture(&gesture, RELEASED, 1100);
+    CHECK(updateGesture(&gesture, PUSHED, 1100 + BUT_DOUBLE_PRESS_MS) == GESTURE_DOUBLE_PRESS);
+    updateGesture(&gesture, RELEASED, 1500);
+    CHECK(updateGesture(&gesture, PUSHED, 1550) == GESTURE_PRESS);
+
+    // Just too late
+    updateGesture(&gesture, RELEASED, 3000);
+    CHECK(updateGesture(&gesture, PUSHED, 3001 + BUT_DOUBLE_PRESS_MS) == GESTURE_PRESS);
+
+    // A long press is not the first half of a double press
+    updateGesture(&gesture, RELEASED, 4000);
+    updateGesture(&gesture, PUSHED, 5000);
+    CHECK(updateGesture(&gesture, NO_CHANGE, 5000 + BUT_LONG_PRESS_MS) == GESTURE_LONG_PRESS);
+    updateGesture(&gesture, RELEASED, 5600);
+    CHECK(updateGesture(&gesture, PUSHED, 5650) == GESTURE_PRESS);
+}
+
+/** A button held for BUT_LONG_PRESS_MS gives a long press, then repeats that start
+    BUT_REPEAT_START_MS apart and speed up by BUT_REPEAT_ACCEL% down to BUT_REPEAT_MIN_MS.  */
+static void testRepeat(void)
+{
+    uint32_t times[64];
+    uint32_t expected = BUT_LONG_PRESS_MS, interval = BUT_REPEAT_START_MS;
+    uint8_t wrong = 0;
+
+    initGesture(&gesture);
+    uint8_t count = hold(0, 2000, times, 64);
+    for (uint8_t i = 0; i < count; i++) {
+        wrong += (times[i] != expected);
+        expected += interval;
+        interval -= interval * BUT_REPEAT_ACCEL / 100;
+        interval = (interval < BUT_REPEAT_MIN_MS) ? BUT_REPEAT_MIN_MS : interval;
+    }
+    printf("held 2 s: long press at %lu ms, repeats at %lu, %lu, %lu ... %lu ms, %u in all\n",
+           (unsigned long)times[0], (unsigned long)times[1], (unsigned long)times[2],
+           (unsigned long)times[3], (unsigned long)times[count - 1], count);
+    CHECK(wrong == 0);
+    CHECK(times[1] - times[0] == BUT_REPEAT_START_MS);
+    CHECK(times[count - 1] - times[count - 2] == BUT_REPEAT_MIN_MS);
+    CHECK(expected >= 2000);
+
+    // A short hold gives no long press, and the next hold starts from the slow rate again
+    CHECK(hold(3000, BUT_LONG_PRESS_MS - 1, times, 64) == 0);
+    CHECK(hold(10000, BUT_LONG_PRESS_MS + BUT_REPEAT_START_MS + 1, times, 64) == 2);
+    CHECK(times[1] - times[0] == BUT_REPEAT_START_MS);
+}
+
+/** Updated only at the control task's rate, each repeat comes on the first update
+    after it is due, one per update, so none are lost at the fastest rate.  */
+static void testControlRate(void)
+{
+    uint32_t due = BUT_LONG_PRESS_MS, interval = BUT_REPEAT_START_MS;
+    uint32_t given = 0, late = 0, maxLateMs = 0;
+
+    initGesture(&gesture);
+    updateGesture(&gesture, PUSHED, 0);
+    for (uint32_t t = CONTROL_MS; t <= 3000; t += CONTROL_MS) {
+        if (updateGesture(&gesture, NO_CHANGE, t) != GESTURE_NONE) {
+            given++;
+            late += (t - due >= CONTROL_MS);
+            maxLateMs = (t - due > maxLateMs) ? t - due : maxLateMs;
+            due += interval;
+            interval -= interval * BUT_REPEAT_ACCEL / 100;
+            interval = (interval < BUT_REPEAT_MIN_MS) ? BUT_REPEAT_MIN_MS : interval;
+        }
+    }
+    printf("held 3 s, updated every %d ms: %lu long press and repeats, up to %lu ms after due\n",
+           CONTROL_MS, (unsigned long)given, (unsigned long)maxLateMs);
+    CHECK(late == 0);
+    CHECK(due > 3000 - BUT_REPEAT_MIN_MS); // none still owed
+}
+
+/** Long presses, repeats and double presses are timed correctly across the wrap of the
+    ms clock.  */
+static void testWrap(void)
+{
+    uint32_t times[64];
+    const uint32_t start = UINT32_MAX - 600;
+
+    initGesture(&gesture);
+    CHECK(hold(start, 1000, times, 64) > 2);
+    CHECK(times[0] == BUT_LONG_PRESS_MS);
+    CHECK(times[1] == BUT_LONG_PRESS_MS + BUT_REPEAT_START_MS);
+
+    initGesture(&gesture);
+    updateGesture(&gesture, PUSHED, UINT32_MAX - 150);
+    updateGesture(&gesture, RELEASED, UINT32_MAX - 100);
+    CHECK(updateGesture(&gesture, PUSHED, 100) == GESTURE_DOUBLE_PRESS);
+    updateGesture(&gesture, RELEASED, 150);
+    CHECK(updateGesture(&gesture, NO_CHANGE, 150 + BUT_LONG_PRESS_MS) == GESTURE_NONE);
+}
+
+int main(void)
+{
+    testPress();
+    testDoublePress();
+    testRepeat();
+    testControlRate();
+    testWrap();
+    return testReport("test_gesture");
+}
@@ -0,0 +1,660 @@
+/** @file   test_intcfg.c
+    @author Bailey Lissington, Dillon Pike, Joseph Ramirez
+    @date   21 May 2021
+    @brief  Host tests of the interrupt plan in intcfg.h: the priorities are set in the
+            order of its table, and each reader of its shared state table is run one
+            instruction at a time, with the interrupt of a writer that preempts it
+            raised after each instruction in turn. Every run must give what the writer
+            running wholly before or wholly after the read gives. Then the length of the
+            SysTick handler, stepped through the same way, as it was when it polled the
+            buttons against now.
+
+            Rows not run here: adcTriggerTime's reader preempts its writer, so has no
+            writer above it; the host timebase is simulated, and test_timebase models
+            the masked read of the hardware one; test_oled raises INT_SSI3 while the
+            dirty ranges are changed; the profile statistics are only copied masked on
+            the target; fDelayExpired is in main.c; and the PWM is written by tasks only.
+*/
+
+#define _POSIX_C_SOURCE 199309L // sigaction, and the benchmark clock
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <signal.h>
+
+#include "tivaware.h"
+#include "yaw.c" // the yaw counters are static, so are set and checked directly
+#include "alt.h"
+#include "circBufT.h"
+#include "event.h"
+#include "buttons4.h"
+#include "intcfg.h"
+#include "timebase.h"
+#include "test.h"
+
+#define TICK_RATE 20000000 // fake timebase rate, the target's system clock
+#define PREV_EDGE_TIME 1000000 // timebase count at the latest edge the previous yaw rate estimate used
+#define EDGE_TIME 1100000 // timebase count at the latest edge counted since
+#define NEW_EDGE_TIME 1130000 // timebase count at the edge the writer gives
+#define YAW_EDGES 3 // edges counted since the previous estimate
+#define YAW_COUNT 100 // yawCounter before the writer's edge
+#define ADC_JUMP 3000 // sample the writer converts
+#define TRAP_FLAG 0x100 // EFLAGS.TF, which traps after every instruction
+
+static uint32_t now; // fake timebase count
+static uint32_t pacerTime; // fake pacer time, which ADCIntHandler measures its latency with
+
+uint32_t timebaseGetCount(void)
+{
+    return now;
+}
+
+uint32_t timebaseGetTickRate(void)
+{
+    return TICK_RATE;
+}
+
+uint32_t pacerGetTime(void)
+{
+    return pacerTime;
+}
+
+/** The interrupt priorities are set in the order of the table in intcfg.h, the encoder first.  */
+static void testPriorities(void)
+{
+    const uint32_t order[] = {INT_GPIOB, INT_GPIOC, INT_ADC0SS0, FAULT_SYSTICK, INT_WTIMER0A,
+                              INT_UART0, INT_GPIOE, FAULT_PENDSV};
+    uint32_t wrongOrder = 0;
+
+    initIntPriorities();
+    for (unsigned i = 1; i < sizeof(order) / sizeof(order[0]); i++) {
+        wrongOrder += (hostIntPriority[order[i - 1]] >= hostIntPriority[order[i]]);
+    }
+    CHECK(wrongOrder == 0);
+    CHECK(hostIntPriority[INT_TIMER1A] == hostIntPriority[INT_WTIMER0A]);
+    CHECK(hostIntPriority[INT_TIMER2A] == hostIntPriority[INT_GPIOE]);
+    CHECK(hostIntPriority[INT_SSI3] < hostIntPriority[FAULT_PENDSV]);
+}
+
+/***********************************************************
+ * Single stepping
+ ***********************************************************/
+
+#if defined(__x86_64__) && defined(__linux__)
+
+// One reader of the shared state table and a writer that preempts it
+typedef struct {
+    const char* name; // reader and writer, for the report
+    void (*setup)(void); // puts the shared state back as it was before each run
+    void (*reader)(void); // reads the shared state as its context does, keeping the result
+    void (*writer)(void); // raises the writer's interrupt, as the hardware would
+    bool (*check)(void); // true if the result and the state after are those of the writer
+                         // running wholly before or wholly after the read
+} preemption_t;
+
+static volatile bool stepping;
+static volatile uint32_t steps; // instructions run since stepping started
+static volatile uint32_t preemptAt; // instruction the writer's interrupt is raised after
+static void (*volatile raiseWriter)(void);
+static uint32_t runs; // reader runs stepped through
+
+/** Runs after every instruction while the trap flag is set, as an interrupt would.  */
+static void onTrap(int signal)
+{
+    (void)signal;
+    if (stepping && (steps++ == preemptAt)) {
+        raiseWriter();
+    }
+}
+
+/** Runs a reader one instruction at a time.  */
+static void stepThrough(void (*reader)(void))
+{
+    steps = 0;
+    stepping = true;
+    // Clear of the red zone, which the compiler may be using
+    __asm__ volatile("subq $128, %%rsp\n\tpushfq\n\torq %0, (%%rsp)\n\tpopfq\n\taddq $128, %%rsp"
+                     :: "i"(TRAP_FLAG) : "memory", "cc");
+    reader();
+    stepping = false;
+    __asm__ volatile("subq $128, %%rsp\n\tpushfq\n\tandq %0, (%%rsp)\n\tpopfq\n\taddq $128, %%rsp"
+                     :: "i"(~TRAP_FLAG) : "memory", "cc");
+}
+
+/** Raises the writer's interrupt after each instruction of the reader in turn.
+    @param reader and writer.
+    @return number of runs the check failed.  */
+static uint32_t preemptEverywhere(const preemption_t* p)
+{
+    uint32_t inconsistent = 0, firstAt = 0;
+
+    // Once without preempting, to count the instructions, and with the writer after
+    raiseWriter = p->writer;
+    preemptAt = UINT32_MAX;
+    p->setup();
+    stepThrough(p->reader);
+    uint32_t instructions = steps;
+    p->writer();
+    CHECK(p->check());
+
+    for (uint32_t at = 0; at < instructions; at++, runs++) {
+        p->setup();
+        preemptAt = at;
+        stepThrough(p->reader);
+        if (!p->check()) {
+            firstAt = inconsistent ? firstAt : at;
+            inconsistent++;
+        }
+    }
+    printf("%s: raised after each of %lu instructions, %lu inconsistent",
+           p->name, (unsigned long)instructions, (unsigned long)inconsistent);
+    if (inconsistent) {
+        printf(", the first after instruction %lu", (unsigned long)firstAt);
+    }
+    printf("\n");
+    return inconsistent;
+}
+
+/***********************************************************
+ * Yaw: yawCounter, yawEdgeCount and yawEdgeTime
+ ***********************************************************/
+
+static uint8_t phase; // quadrature phase of the encoder pins, 0 to 3
+static volatile int16_t readDegrees;
+static volatile double readRate;
+
+/** Moves the encoder one edge forwards, raising INT_GPIOB.  */
+static void yawEdge(void)
+{
+    const uint8_t gray[4] = {0, GPIO_PIN_1, GPIO_PIN_0 | GPIO_PIN_1, GPIO_PIN_0};
+    uint8_t previous = gray[phase];
+
+    phase = (phase + 1) & 3;
+    uint8_t changed = previous ^ gray[phase];
+    now = NEW_EDGE_TIME;
+    hostGpioSet(GPIO_PORTB_BASE, changed, (gray[phase] & changed) != 0);
+}
+
+/** Passes the reference yaw, raising INT_GPIOC.  */
+static void refYawPass(void)
+{
+    hostGpioSet(GPIO_PORTC_BASE, GPIO_PIN_4, false);
+}
+
+static void yawSetup(void)
+{
+    yawCounter = YAW_COUNT;
+    yawEdgeCount = YAW_EDGES;
+    yawEdgeTime = EDGE_TIME;
+    prevRateEdgeTime = PREV_EDGE_TIME;
+    yawRateTimedOut = false;
+    yawRate = 0;
+    now = EDGE_TIME;
+
+    // Reference pin high, its interrupt enabled for the next pass
+    hostGpioSet(GPIO_PORTC_BASE, GPIO_PIN_4, true);
+    eventQueueInit(&refYawEvents);
+    enableRefYawInt();
+}
+
+static void readYawDegrees(void)
+{
+    readDegrees = getYawDegrees();
+}
+
+static void readYawRate(void)
+{
+    readRate = getYawRate();
+}
+
+/** Rate getYawRate gives from edges counted up to an edge time.  */
+static double yawRateOf(int16_t edges, uint32_t edgeTime)
+{
+    return (double)edges * DEGREES_PER_REV / (EDGES_PER_SLOT * DISC_SLOTS)
+           * yawTimerRate / (uint32_t)(edgeTime - PREV_EDGE_TIME);
+}
+
+static bool edgeCheckDegrees(void)
+{
+    int16_t before = YAW_COUNT * DEGREES_PER_REV / (EDGES_PER_SLOT * DISC_SLOTS);
+    return (yawCounter == YAW_COUNT + 1) && ((readDegrees == before) || (readDegrees == getYawDegrees()));
+}
+
+static bool refCheckDegrees(void)
+{
+    int16_t before = YAW_COUNT * DEGREES_PER_REV / (EDGES_PER_SLOT * DISC_SLOTS);
+    return (yawCounter == 0) && ((readDegrees == before) || (readDegrees == 0));
+}
+
+/** The edge after the store keeps it, the edge before is lost to the reference, as
+    either would be were the two a moment further apart.  */
+static bool edgeCheckRef(void)
+{
+    event_t event;
+    return ((yawCounter == 0) || (yawCounter == 1)) && eventGet(&refYawEvents, &event)
+           && (event.type == EVENT_REF_YAW_FOUND);
+}
+
+/** Either the new edge is taken with the rest, or it is left counted for the next call.  */
+static bool edgeCheckRate(void)
+{
+    bool before = (yawEdgeCount == 0) && (prevRateEdgeTime == NEW_EDGE_TIME)
+                  && (readRate == yawRateOf(YAW_EDGES + 1, NEW_EDGE_TIME));
+    bool after = (yawEdgeCount == 1) && (yawEdgeTime == NEW_EDGE_TIME) && (prevRateEdgeTime == EDGE_TIME)
+                 && (readRate == yawRateOf(YAW_EDGES, EDGE_TIME));
+    return before || after;
+}
+
+/** getYawRate's take of the edges without INT_GPIOB masked, to show the stepping finds
+    what the mask prevents.  */
+static void readYawRateUnmasked(void)
+{
+    int16_t edges = yawEdgeCount;
+    uint32_t edgeTime = yawEdgeTime;
+    yawEdgeCount = 0;
+
+    readRate = yawRateOf(edges, edgeTime);
+    prevRateEdgeTime = edgeTime;
+}
+
+/***********************************************************
+ * Altitude: circBufADC, adcSumRate, latency maxima
+ ***********************************************************/
+
+static volatile uint32_t readMean;
+static volatile double readClimbRate;
+static volatile uint32_t readLatency;
+static uint32_t meanBefore;
+static double altRateBefore;
+
+/** Converts a sample, raising INT_ADC0SS0. Nothing these readers do disables or masks
+    it, so its handler runs straight away.  */
+static void adcConvert(uint32_t value)
+{
+    hostAdcValue = value;
+    pacerTime += 300;
+    hostAdcHandler();
+}
+
+/** Converts a sample far from any in the buffer, so the mean and rate both change.  */
+static void adcJump(void)
+{
+    adcConvert(ADC_JUMP);
+}
+
+/** Fills the buffer with samples spread below ADC_JUMP.  */
+static void altSetup(void)
+{
+    for (int i = 0; i < BUF_SIZE; i++) {
+        adcConvert(1000 + 10 * i);
+    }
+    meanBefore = altRead();
+    altRateBefore = getAltitudeRate();
+    intLatencyReset();
+    intLatencyRecord(INT_SRC_ADC, 100);
+}
+
+static void readAltMean(void)
+{
+    readMean = altRead();
+}
+
+static void readAltRate(void)
+{
+    readClimbRate = getAltitudeRate();
+}
+
+static void readLatencyMax(void)
+{
+    readLatency = intLatencyMax(INT_SRC_ADC);
+}
+
+/** The sample replaces one slot, so the mean is of the window before it or after it.  */
+static bool adcCheckMean(void)
+{
+    uint32_t meanAfter = altRead();
+    return (meanAfter != meanBefore) && ((readMean == meanBefore) || (readMean == meanAfter));
+}
+
+static bool adcCheckRate(void)
+{
+    double altRateAfter = getAltitudeRate();
+    return (altRateAfter != altRateBefore) && ((readClimbRate == altRateBefore) || (readClimbRate == altRateAfter));
+}
+
+static bool adcCheckLatency(void)
+{
+    uint32_t latencyAfter = intLatencyMax(INT_SRC_ADC);
+    return (latencyAfter == pacerTime) && ((readLatency == 100) || (readLatency == latencyAfter));
+}
+
+/***********************************************************
+ * Event queues
+ ***********************************************************/
+
+static eventQueue_t queue;
+static uint8_t queued; // events in the queue before the read
+static int16_t nextValue; // value of the next event posted
+static volatile bool readGot;
+static event_t readEvent;
+
+/** Posts the next event, as an interrupt handler does. Nothing the consumer does masks it.  */
+static void queuePost(void)
+{
+    eventPost(&queue, nextValue % 4, (uint8_t)(nextValue * 7), nextValue);
+    nextValue++;
+}
+
+static void queueSetup(void)
+{
+    eventQueueInit(&queue);
+    nextValue = 1;
+    for (uint8_t i = 0; i < queued; i++) {
+        queuePost();
+    }
+}
+
+static void readQueue(void)
+{
+    event_t event;
+    readGot = eventGet(&queue, &event);
+    readEvent = event;
+}
+
+/** Is an event whole, as posted?  */
+static bool eventWhole(const event_t* event, int16_t value)
+{
+    return (event->value == value) && (event->type == value % 4) && (event->source == (uint8_t)(value * 7));
+}
+
+/** The events taken and left run from 1 without a gap, each whole, and the writer's is
+    only dropped if the queue was full.  */
+static bool queueCheck(void)
+{
+    int16_t expected = 1;
+    event_t event;
+
+    if ((queued > 0) && !readGot) {
+        return false;
+    }
+    if (readGot && !eventWhole(&readEvent, expected++)) {
+        return false;
+    }
+    while (eventGet(&queue, &event)) {
+        if (!eventWhole(&event, expected++)) {
+            return false;
+        }
+    }
+    return (expected - 1 == queued + 1 - (int16_t)queue.dropped)
+           && ((queue.dropped == 0) || (queued == EVENT_QUEUE_SIZE));
+}
+
+/***********************************************************
+ * Buttons: button state and flags
+ ***********************************************************/
+
+static volatile uint8_t readButton;
+
+/** Runs the push button debounce timer out, raising INT_TIMER2A.  */
+static void debounceExpire(void)
+{
+    hostTimersAdvance(hostClockHz / 1000 * BUT_DEBOUNCE_MS);
+}
+
+/** Releases UP and takes its change, then pushes it, starting the debounce timer.  */
+static void buttonSetup(void)
+{
+    hostGpioSet(UP_BUT_PORT_BASE, UP_BUT_PIN, UP_BUT_NORMAL);
+    hostTimersAdvance(hostClockHz);
+    while (checkButton(UP) != NO_CHANGE) {
+    }
+    hostGpioSet(UP_BUT_PORT_BASE, UP_BUT_PIN, !UP_BUT_NORMAL);
+}
+
+static void readCheckButton(void)
+{
+    readButton = checkButton(UP);
+}
+
+/** The push is given once, by this call or the next.  */
+static bool buttonCheck(void)
+{
+    uint8_t next = checkButton(UP);
+    return ((readButton == PUSHED) && (next == NO_CHANGE))
+           || ((readButton == NO_CHANGE) && (next == PUSHED) && (checkButton(UP) == NO_CHANGE));
+}
+
+/***********************************************************
+ * SysTick: the handler before and after the buttons moved to edge interrupts
+ ***********************************************************/
+
+#define SYSTICK_RATE_HZ 500 // main.c
+#define BUTTON_POLLING_RATE_HZ 100 // rate SysTick polled the buttons at before
+#define LENGTH_TICKS 1000 // ticks stepped through for each handler
+#define BENCH_TICKS 1000000 // ticks timed for each handler
+#define FLIP_POLLS 10 // polls between flips of every button and switch pin
+
+static eventQueue_t tickEvents; // inputEvents of main.c
+static uint8_t sysTickButtonCounter;
+static bool switchPosted[NUM_BUTS];
+static bool switchesPosted;
+static volatile uint32_t sysTickValue; // SysTick's count at entry
+
+/** Pushes or releases every button and turns every switch on or off.  */
+static void flipPins(bool pushed)
+{
+    hostGpioSet(UP_BUT_PORT_BASE, UP_BUT_PIN, pushed != UP_BUT_NORMAL);
+    hostGpioSet(DOWN_BUT_PORT_BASE, DOWN_BUT_PIN, pushed != DOWN_BUT_NORMAL);
+    hostGpioSet(LEFT_BUT_PORT_BASE, LEFT_BUT_PIN, pushed != LEFT_BUT_NORMAL);
+    hostGpioSet(RIGHT_BUT_PORT_BASE, RIGHT_BUT_PIN, pushed != RIGHT_BUT_NORMAL);
+    hostGpioSet(SWITCH1_BUT_PORT_BASE, SWITCH1_BUT_PIN, pushed != SWITCH1_BUT_NORMAL);
+    hostGpioSet(RESET_BUT_PORT_BASE, RESET_BUT_PIN, pushed != RESET_BUT_NORMAL);
+}
+
+/** SysTickIntHandler as it was when it polled the buttons every fifth tick and posted
+    their changes, with the event types of now.  */
+static void oldSysTick(void)
+{
+    uint8_t but;
+    uint8_t state;
+
+    ADCProcessorTrigger(ADC0_BASE, 0);
+    if (sysTickButtonCounter >= (SYSTICK_RATE_HZ / BUTTON_POLLING_RATE_HZ)) {
+        sysTickButtonCounter = 0;
+        updateButtons();
+        for (but = UP; but <= RIGHT; but++) {
+            state = checkButton(but);
+            if (state != NO_CHANGE) {
+                eventPost(&tickEvents, EVENT_BUTTON_CHANGED, but, state);
+            }
+        }
+        for (but = SWITCH1; but <= RESET; but++) {
+            bool level = getState(but);
+            if ((!switchesPosted) || (level != switchPosted[but])) {
+                if (eventPost(&tickEvents, EVENT_SWITCH_CHANGED, but, level)) {
+                    switchPosted[but] = level;
+                }
+            }
+        }
+        switchesPosted = true;
+    }
+    sysTickButtonCounter++;
+}
+
+/** SysTickIntHandler now, with SysTickPeriodGet and SysTickValueGet as the register
+    reads they are.  */
+static void newSysTick(void)
+{
+    intLatencyRecord(INT_SRC_SYSTICK, hostClockHz / SYSTICK_RATE_HZ - 1 - sysTickValue);
+    altTrigger();
+}
+
+/** Starts the ticks with every pin released and nothing posted.  */
+static void tickSetup(void)
+{
+    event_t event;
+
+    flipPins(false);
+    for (unsigned i = 0; i < 2 * NUM_SWITCH_POLLS; i++) {
+        updateButtons();
+    }
+    for (uint8_t but = 0; but < NUM_BUTS; but++) {
+        checkButton(but);
+    }
+    while (eventGet(&tickEvents, &event)) {
+    }
+    sysTickButtonCounter = 0;
+    switchesPosted = false;
+}
+
+/** Runs one tick of a handler, flipping the pins every FLIP_POLLS polls and taking the
+    events as the control task does.  */
+static void tick(void (*handler)(void), uint32_t i, bool step)
+{
+    const uint32_t ticksPerPoll = SYSTICK_RATE_HZ / BUTTON_POLLING_RATE_HZ;
+    event_t event;
+
+    if (i % (ticksPerPoll * FLIP_POLLS) == 0) {
+        flipPins((i / (ticksPerPoll * FLIP_POLLS)) % 2 == 1);
+    }
+    sysTickValue = i % 64;
+    if (step) {
+        stepThrough(handler);
+    } else {
+        handler();
+    }
+    while (eventGet(&tickEvents, &event)) {
+    }
+}
+
+/** Steps through a handler's ticks, and times them.
+    @param handler to run each tick.
+    @param set to its most instructions in a tick.
+    @param set to its mean instructions per tick.
+    @return mean time of a tick in ns.  */
+static double tickLength(void (*handler)(void), uint32_t* worst, double* mean)
+{
+    uint64_t total = 0;
+
+    raiseWriter = NULL;
+    preemptAt = UINT32_MAX;
+    tickSetup();
+    *worst = 0;
+    for (uint32_t i = 0; i < LENGTH_TICKS; i++) {
+        tick(handler, i, true);
+        *worst = (steps > *worst) ? steps : *worst;
+        total += steps;
+    }
+    *mean = (double)total / LENGTH_TICKS;
+
+    tickSetup();
+    uint64_t start = testNowNs();
+    for (uint32_t i = 0; i < BENCH_TICKS; i++) {
+        tick(handler, i, false);
+    }
+    return (double)(testNowNs() - start) / BENCH_TICKS;
+}
+
+/***********************************************************
+ * Tests
+ ***********************************************************/
+
+/** Every reader of the shared state gives a consistent result wherever the writers
+    above it preempt, and leaves nothing a writer wrote lost or half taken.  */
+static void testPreemption(void)
+{
+    const preemption_t cases[] = {
+        {"getYawDegrees, YawIntHandler", yawSetup, readYawDegrees, yawEdge, edgeCheckDegrees},
+        {"getYawDegrees, refYawIntHandler", yawSetup, readYawDegrees, refYawPass, refCheckDegrees},
+        {"refYawIntHandler, YawIntHandler", yawSetup, refYawPass, yawEdge, edgeCheckRef},
+        {"getYawRate, YawIntHandler", yawSetup, readYawRate, yawEdge, edgeCheckRate},
+        {"altRead, ADCIntHandler", altSetup, readAltMean, adcJump, adcCheckMean},
+        {"getAltitudeRate, ADCIntHandler", altSetup, readAltRate, adcJump, adcCheckRate},
+        {"intLatencyMax, ADCIntHandler", altSetup, readLatencyMax, adcJump, adcCheckLatency},
+        {"eventGet, eventPost", queueSetup, readQueue, queuePost, queueCheck},
+        {"checkButton, butDebounceIntHandler", buttonSetup, readCheckButton, debounceExpire, buttonCheck},
+    };
+    const uint8_t queueFill[] = {0, 1, EVENT_QUEUE_SIZE - 1, EVENT_QUEUE_SIZE};
+    uint64_t start = testNowNs();
+
+    for (unsigned i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        if (cases[i].setup == queueSetup) {
+            // Empty, partly filled and full
+            for (unsigned fill = 0; fill < sizeof(queueFill); fill++) {
+                queued = queueFill[fill];
+                printf("%u queued, ", queued);
+                CHECK(preemptEverywhere(&cases[i]) == 0);
+            }
+        } else {
+            CHECK(preemptEverywhere(&cases[i]) == 0);
+        }
+    }
+    printf("%lu runs stepped through in %.0f ms\n", (unsigned long)runs, (testNowNs() - start) / 1e6);
+    CHECK(hostIntMasked == false);
+}
+
+/** Without INT_GPIOB masked, the take of the edges loses the edges that arrive in it.  */
+static void testUnmaskedFound(void)
+{
+    const preemption_t unmasked = {"getYawRate unmasked, YawIntHandler", yawSetup, readYawRateUnmasked,
+                                   yawEdge, edgeCheckRate};
+    CHECK(preemptEverywhere(&unmasked) > 0);
+}
+
+/** Every handler below SysTick waits for the whole of SysTickIntHandler. Its worst tick,
+    when the polled buttons change and post their events, is several times longer than
+    the handler that only triggers the conversion. Instructions are the host's, the stand-ins'
+    register accesses included.  */
+static void testSysTickLength(void)
+{
+    uint32_t oldWorst, newWorst;
+    double oldMean, newMean;
+    double oldNs = tickLength(oldSysTick, &oldWorst, &oldMean);
+    double newNs = tickLength(newSysTick, &newWorst, &newMean);
+
+    printf("SysTick polling the buttons: worst %lu instructions, mean %.1f, %.1f ns per tick\n",
+           (unsigned long)oldWorst, oldMean, oldNs);
+    printf("SysTick triggering the ADC only: worst %lu instructions, mean %.1f, %.1f ns per tick\n",
+           (unsigned long)newWorst, newMean, newNs);
+    CHECK(newWorst * 4 < oldWorst);
+    CHECK(newMean < oldMean);
+}
+
+int main(void)
+{
+    struct sigaction action;
+
+    testPriorities();
+
+    initYawInt();
+    initYawStates();
+    initRefYawInt();
+    initYawRate();
+    initCircBuf(&circBufADC, BUF_SIZE);
+    initADC();
+    initButtons();
+    initButtonInts(NULL);
+    eventQueueInit(&tickEvents);
+
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = onTrap;
+    sigaction(SIGTRAP, &action, NULL);
+
+    testPreemption();
+    testUnmaskedFound();
+    testSysTickLength();
+    return testReport("test_intcfg");
+}
+
+#else
+
+int main(void)
+{
+    testPriorities();
+    printf("single stepping needs x86-64 Linux, preemption not tested\n");
+    return testReport("test_intcfg");
+}
+
+#endif
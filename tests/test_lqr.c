@@ -0,0 +1,282 @@
+/** @file   test_lqr.c
+    @author Bailey Lissington, Dillon Pike, Joseph Ramirez
+    @date   21 May 2021
+    @brief  Host tests of the LQR controller: the Q16 arithmetic against the same
+            control law in floating point, bumpless transfer, closed-loop settling
+            on the identified model the gains were generated from, and a benchmark
+            of settling time, overshoot and effort against the cascaded PI control.
+*/
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <math.h>
+
+#include "lqr.h"
+#include "pi.h"
+#include "traj.h"
+#include "test.h"
+#include "model.h"
+
+#define CONTROL_STEP_S 0.1 // control period the gains were generated for
+#define MODEL_STEP_S 0.001
+#define SETTLE_S 15.0
+#define RATE_STEP_S 0.01 // rate task period of the cascaded PI control
+#define PI_CONTROL_STEP_S 0.02 // control task period of the cascaded PI control
+#define ALT_BAND 1.0 // altitude error counted as settled, in %
+#define YAW_BAND 2.0 // yaw error counted as settled, in degrees
+#define YAW_OVERSHOOT_MAX 20.0 // neither controller may overshoot the yaw by more, in degrees
+#define Q16 65536.0
+
+// lqrCompute in floating point, with the gains the Q16 constants hold
+static double fAltIntegral, fYawIntegral, fPrevAltitude, fPrevYaw, fAltRate, fYawRate;
+static bool fHasPrevSample;
+
+/** Wraps a yaw difference to the shortest signed difference, as lqrYawError.  */
+static double floatYawError(double error)
+{
+    if (error < -(FULL_ROTATION_DEG / 2)) {
+        error += FULL_ROTATION_DEG;
+    } else if (error > (FULL_ROTATION_DEG / 2)) {
+        error -= FULL_ROTATION_DEG;
+    }
+    return error;
+}
+
+static void floatReset(void)
+{
+    fAltIntegral = fYawIntegral = fAltRate = fYawRate = 0;
+    fHasPrevSample = false;
+}
+
+/** lqrTransfer in floating point: solves for the integrals that continue from the duties.  */
+static void floatTransfer(double altReference, int16_t altitude, double yawReference, int16_t yaw,
+                          double mainDuty, double tailDuty)
+{
+    double altError = altReference - altitude;
+    double yawError = floatYawError(yawReference - yaw);
+    double mainRemainder = mainDuty * Q16 - LQR_K_MAIN_ALT * altError - LQR_K_MAIN_YAW * yawError;
+    double tailRemainder = tailDuty * Q16 - LQR_K_TAIL_ALT * altError - LQR_K_TAIL_YAW * yawError;
+    double det = (double)LQR_K_MAIN_ALT_INT * LQR_K_TAIL_YAW_INT - (double)LQR_K_MAIN_YAW_INT * LQR_K_TAIL_ALT_INT;
+
+    floatReset();
+    fAltIntegral = (mainRemainder * LQR_K_TAIL_YAW_INT - tailRemainder * LQR_K_MAIN_YAW_INT) / det;
+    fYawIntegral = (tailRemainder * LQR_K_MAIN_ALT_INT - mainRemainder * LQR_K_TAIL_ALT_INT) / det;
+}
+
+static void floatCompute(double altReference, int16_t altitude, double yawReference, int16_t yaw, double deltaT,
+                         double* mainDuty, double* tailDuty)
+{
+    double altError = altReference - altitude;
+    double yawError = floatYawError(yawReference - yaw);
+
+    if (fHasPrevSample) {
+        fAltRate = (altitude - fPrevAltitude) / deltaT;
+        fYawRate = floatYawError(yaw - fPrevYaw) / deltaT;
+    }
+    fPrevAltitude = altitude;
+    fPrevYaw = yaw;
+    fHasPrevSample = true;
+
+    double main = (LQR_K_MAIN_ALT * altError - LQR_K_MAIN_ALT_RATE * fAltRate + LQR_K_MAIN_YAW * yawError
+                   - LQR_K_MAIN_YAW_RATE * fYawRate + LQR_K_MAIN_ALT_INT * fAltIntegral
+                   + LQR_K_MAIN_YAW_INT * fYawIntegral) / Q16;
+    double tail = (LQR_K_TAIL_ALT * altError - LQR_K_TAIL_ALT_RATE * fAltRate + LQR_K_TAIL_YAW * yawError
+                   - LQR_K_TAIL_YAW_RATE * fYawRate + LQR_K_TAIL_ALT_INT * fAltIntegral
+                   + LQR_K_TAIL_YAW_INT * fYawIntegral) / Q16;
+
+    double mainConstrained = (main < PI_MIN) ? PI_MIN : ((main > PI_MAX) ? PI_MAX : main);
+    double tailConstrained = (tail < PI_MIN) ? PI_MIN : ((tail > PI_MAX) ? PI_MAX : tail);
+    if ((mainConstrained == main) && (tailConstrained == tail)) {
+        fAltIntegral += altError * deltaT;
+        fYawIntegral += yawError * deltaT;
+    }
+    *mainDuty = mainConstrained;
+    *tailDuty = tailConstrained;
+}
+
+/** Flies the Q16 controller on the model through altitude and yaw steps, running the
+    floating-point controller on the same measurements alongside.
+    @param largest difference between the two controllers' duties in %.
+    @return true if the model settled within 1% and 2 degrees of each reference.  */
+static bool flySteps(double* maxDifference)
+{
+    const double altitudes[] = {30.0, 30.0, 60.0, 10.0};
+    const double yaws[] = {0, 90.0, -45.0, 170.0};
+    model_t heli = {0};
+    double mainDuty = MODEL_MAIN_HOVER, tailDuty = MODEL_TAIL_HOVER, mainApplied, tailApplied;
+    bool settled = true;
+    *maxDifference = 0;
+
+    lqrReset();
+    lqrTransfer(0, 0, 0, 0, mainDuty, tailDuty);
+    floatTransfer(0, 0, 0, 0, mainDuty, tailDuty);
+    modelShapeInit((uint32_t)(1 / CONTROL_STEP_S), mainDuty, tailDuty);
+
+    for (unsigned step = 0; step < sizeof(altitudes) / sizeof(altitudes[0]); step++) {
+        for (int i = 0; i < (int)(SETTLE_S / CONTROL_STEP_S); i++) {
+            int16_t altitude = (int16_t)lround(heli.altitude);
+            int16_t yaw = (int16_t)lround(floatYawError(fmod(heli.yaw, FULL_ROTATION_DEG)));
+            double floatMain, floatTail;
+
+            lqrCompute(altitudes[step], altitude, yaws[step], yaw, CONTROL_STEP_S, &mainDuty, &tailDuty);
+            floatCompute(altitudes[step], altitude, yaws[step], yaw, CONTROL_STEP_S, &floatMain, &floatTail);
+            *maxDifference = fmax(*maxDifference, fmax(fabs(mainDuty - floatMain), fabs(tailDuty - floatTail)));
+
+            modelShape(mainDuty, tailDuty, &mainApplied, &tailApplied);
+            for (int j = 0; j < (int)(CONTROL_STEP_S / MODEL_STEP_S); j++) {
+                modelStep(&heli, mainApplied, tailApplied, 0, MODEL_STEP_S);
+            }
+        }
+        double yawError = floatYawError(fmod(yaws[step] - heli.yaw, FULL_ROTATION_DEG));
+        printf("LQR step to %.0f%%, %.0f degrees: altitude %.2f%%, yaw error %.2f degrees after %.0f s\n",
+               altitudes[step], yaws[step], heli.altitude, yawError, SETTLE_S);
+        settled = settled && (fabs(heli.altitude - altitudes[step]) < 1.0) && (fabs(yawError) < 2.0);
+    }
+    return settled;
+}
+
+/** The Q16 controller matches the floating-point control law and settles the model.  */
+static void testClosedLoop(void)
+{
+    double maxDifference;
+    CHECK(flySteps(&maxDifference));
+    printf("Q16 and floating-point duties differ by up to %.4f%%\n", maxDifference);
+    CHECK(maxDifference < 0.05);
+}
+
+/** The first output after a transfer continues from the duties the previous mode left.  */
+static void testBumplessTransfer(void)
+{
+    const double mains[] = {PI_MIN, 35.0, 61.5, PI_MAX};
+    const double tails[] = {PI_MAX, 20.0, 44.25, PI_MIN};
+    double mainDuty, tailDuty;
+
+    for (unsigned i = 0; i < sizeof(mains) / sizeof(mains[0]); i++) {
+        lqrReset();
+        lqrTransfer(25.0, 20, -30.0, -10, mains[i], tails[i]);
+        lqrCompute(25.0, 20, -30.0, -10, CONTROL_STEP_S, &mainDuty, &tailDuty);
+        CHECK_NEAR(mainDuty, mains[i], 0.01);
+        CHECK_NEAR(tailDuty, tails[i], 0.01);
+    }
+}
+
+// Response of both rotors to a move, from the moment it is asked for
+typedef struct {
+    double altSettle; // time until the altitude stays within ALT_BAND, in s
+    double yawSettle; // time until the yaw stays within YAW_BAND, in s
+    double altOvershoot; // largest altitude past the target, in %
+    double yawOvershoot; // largest yaw past the target, in degrees
+    double effort; // integrated thrust away from hover of both rotors, in %.s
+} benchmark_t;
+
+/** Records the settling time of one sample.  */
+static void recordSettle(double* settle, double t, double error, double band)
+{
+    if (fabs(error) > band) {
+        *settle = -1;
+    } else if (*settle < 0) {
+        *settle = t;
+    }
+}
+
+/** Flies the model from hover at 0 to an altitude and yaw, with the controllers, task
+    rates and trajectories main.c gives either controller.
+    @param true for LQR control, false for the cascaded PI control.
+    @param altitude target in %.
+    @param yaw target in degrees.
+    @param address to store the response.  */
+static void flyController(bool lqr, double altTarget, double yawTarget, benchmark_t* b)
+{
+    trajectory_t altTraj, yawTraj;
+    model_t heli = {0};
+    double controlStep = lqr ? CONTROL_STEP_S : PI_CONTROL_STEP_S;
+    double updateStep = lqr ? CONTROL_STEP_S : RATE_STEP_S; // period the rotors are shaped at
+    double mainCommand = MODEL_MAIN_HOVER, tailCommand = MODEL_TAIL_HOVER, mainApplied = 0, tailApplied = 0;
+    double setClimbRate = 0, setYawRate = 0, feedforward = 0;
+    b->altSettle = b->yawSettle = -1;
+    b->altOvershoot = b->yawOvershoot = b->effort = 0;
+
+    trajInit(&altTraj, 0, ALT_TRAJ_MAX_RATE, ALT_TRAJ_MAX_ACCEL, 0);
+    trajSetNegativeRate(&altTraj, ALT_MAX_DESCENT_RATE);
+    trajInit(&yawTraj, 0, YAW_TRAJ_MAX_RATE, YAW_TRAJ_MAX_ACCEL, FULL_ROTATION_DEG);
+    lqrReset();
+    lqrTransfer(0, 0, 0, 0, mainCommand, tailCommand);
+    resetErrorIntegrals();
+    mainRatePiTransfer(0, 0, mainCommand);
+    tailRatePiTransfer(0, 0, tailCommand);
+    modelShapeInit((uint32_t)(1 / updateStep), mainCommand, tailCommand);
+
+    for (int i = 0; i < (int)(SETTLE_S / MODEL_STEP_S); i++) {
+        double t = i * MODEL_STEP_S;
+
+        if ((i % (int)(controlStep / MODEL_STEP_S)) == 0) {
+            int16_t altitude = (int16_t)lround(heli.altitude);
+            int16_t yaw = (int16_t)lround(floatYawError(fmod(heli.yaw, FULL_ROTATION_DEG)));
+            double altReference = trajUpdate(&altTraj, altTarget, controlStep);
+            double yawReference = trajUpdate(&yawTraj, yawTarget, controlStep);
+            if (lqr) {
+                lqrCompute(altReference, altitude, yawReference, yaw, controlStep, &mainCommand, &tailCommand);
+            } else {
+                setClimbRate = mainAltitudeCompute(altReference, altitude, altTraj.velocity);
+                feedforward = mainRateFeedforward(altTraj.velocity, altTraj.acceleration);
+                setYawRate = tailAngleCompute(yawReference, yaw, yawTraj.velocity);
+            }
+        }
+        if ((i % (int)(updateStep / MODEL_STEP_S)) == 0) {
+            if (!lqr) {
+                mainCommand = mainRatePiCompute(setClimbRate, heli.climbRate, feedforward, RATE_STEP_S);
+                tailCommand = tailRatePiCompute(setYawRate, heli.yawRate, RATE_STEP_S);
+            }
+            modelShape(mainCommand, tailCommand, &mainApplied, &tailApplied);
+        }
+        modelStep(&heli, mainApplied, tailApplied, 0, MODEL_STEP_S);
+
+        double altError = heli.altitude - altTarget;
+        double yawError = floatYawError(fmod(heli.yaw - yawTarget, FULL_ROTATION_DEG));
+        recordSettle(&b->altSettle, t, altError, ALT_BAND);
+        recordSettle(&b->yawSettle, t, yawError, YAW_BAND);
+        b->altOvershoot = fmax(b->altOvershoot, altError);
+        b->yawOvershoot = fmax(b->yawOvershoot, yawError);
+        b->effort += (fabs(mainCommand - MODEL_MAIN_HOVER) + fabs(tailCommand - MODEL_TAIL_HOVER)) * MODEL_STEP_S;
+    }
+}
+
+/** Benchmark of LQR against the cascaded PI control on the same model and moves. At its
+    10 Hz control period LQR cannot use the rate loops or the altitude feedforward, so the
+    default PI control settles sooner and overshoots less in altitude, for less effort.
+    Their yaw overshoots are close, and both are bounded.  */
+static void testAgainstPi(void)
+{
+    const double altitudes[] = {10.0, 30.0, 50.0};
+    const double yaws[] = {90.0, 45.0, 170.0};
+
+    for (unsigned i = 0; i < sizeof(altitudes) / sizeof(altitudes[0]); i++) {
+        benchmark_t lqr, pi;
+        flyController(true, altitudes[i], yaws[i], &lqr);
+        flyController(false, altitudes[i], yaws[i], &pi);
+        printf("to %.0f%%, %.0f degrees: LQR settles in %.2f/%.2f s, overshoots %.2f%%/%.2f degrees, effort %.0f %%.s; "
+               "PI settles in %.2f/%.2f s, overshoots %.2f%%/%.2f degrees, effort %.0f %%.s\n",
+               altitudes[i], yaws[i], lqr.altSettle, lqr.yawSettle, lqr.altOvershoot, lqr.yawOvershoot, lqr.effort,
+               pi.altSettle, pi.yawSettle, pi.altOvershoot, pi.yawOvershoot, pi.effort);
+        CHECK(lqr.altSettle > 0);
+        CHECK(lqr.yawSettle > 0);
+        CHECK(pi.altSettle > 0);
+        CHECK(pi.yawSettle > 0);
+        CHECK(lqr.altSettle < SETTLE_S - 5.0);
+        CHECK(lqr.yawSettle < SETTLE_S - 5.0);
+        CHECK(pi.altSettle < lqr.altSettle);
+        CHECK(pi.yawSettle < lqr.yawSettle);
+        CHECK(pi.altOvershoot < lqr.altOvershoot);
+        CHECK(fmax(pi.yawOvershoot, lqr.yawOvershoot) < YAW_OVERSHOOT_MAX);
+        CHECK(pi.effort < lqr.effort);
+    }
+}
+
+int main(void)
+{
+    testClosedLoop();
+    testBumplessTransfer();
+    testAgainstPi();
+    return testReport("test_lqr");
+}
@@ -0,0 +1,492 @@
+/** @file   test_oled.c
+    @author Bailey Lissington, Dillon Pike, Joseph Ramirez
+    @date   21 May 2021
+    @brief  Host tests of the OLED updates: a model of the display controller, fed the
+            bytes SSI3 sends, checks the display matches the frame buffer, and counts
+            the column ranges each page has dirty and the bytes a displayInfoOLED frame
+            sends, against updating the whole screen. Then the background updates: the
+            busy flag, updates while busy costing one more pass, drawing while a page
+            is sent, transfers completing inside OrbitOledMarkDirty, and the time the
+            display task takes.
+*/
+
+#define _POSIX_C_SOURCE 199309L // benchmark clock
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "tivaware.h"
+#include "OrbitOLED/OrbitOLEDInterface.h"
+#include "OrbitOLED/lib_OrbitOled/OrbitOled.h"
+#include "OrbitOLED/lib_OrbitOled/OrbitOledChar.h"
+#include "OrbitOLED/lib_OrbitOled/OrbitBoosterPackDefs.h"
+#include "pwm.h"
+#include "test.h"
+
+#define OLED_STR 17 // MAX_OLED_STR in main.c
+#define FRAMES 1000
+#define STRESS_STEPS 20000 // main loop passes of the interleaving test
+#define SSI_BYTE_US 1 // 8 bits at the 8 MHz SSI3 clock
+#define COMMAND_BYTES_PER_PAGE 3 // page, then the column's low and high nibbles
+
+extern char rgbOledBmp[];
+extern int rgcolOledDirtyFirst[];
+extern int rgcolOledDirtyLast[];
+
+// Display controller model, in page addressing mode
+static uint8_t display[cpagOledMax][ccolOledMax];
+static uint8_t page, column;
+static uint8_t argumentBytes; // of a two byte command still to come
+static uint32_t commandBytes, dataBytes;
+static uint32_t pageBytes[cpagOledMax]; // data bytes written to each page
+static uint32_t unselected; // bytes sent with chip select high
+static uint32_t pageSends[cpagOledMax]; // page address commands for each page
+static uint32_t commandsWhileBusy; // command bytes sent while the uDMA was sending data
+
+// Background update state
+static uint32_t doneCount; // updates finished
+static uint32_t staleAtDone; // clean pages not matching the buffer when an update finished
+static uint32_t maxDisableBytes; // most bytes the uDMA moves while SSI3 is disabled
+static uint32_t completedDisabled; // transfers completed while SSI3 was disabled
+
+static uint32_t randomState = 1;
+
+// Helicopter state a frame shows, as displayInfoOLED takes it
+typedef struct {
+    int16_t altitude;
+    int16_t altSetpoint;
+    int16_t yaw;
+    int16_t yawSetpoint;
+    uint32_t mainDuty; // Q16 percent
+    uint32_t tailDuty;
+} frame_t;
+
+/** The drivers' millisecond delays are not needed without a display to power up.  */
+void DelayInit()
+{
+}
+
+void DelayMs(int cms)
+{
+    (void)cms;
+}
+
+/** Returns a pseudo-random number from a fixed-seed generator.  */
+static uint32_t randomNext(void)
+{
+    randomState = randomState * 1103515245 + 12345;
+    return randomState >> 16;
+}
+
+/** Takes a byte SSI3 sends as the display controller would: a command when the D/C pin
+    is low, setting the page or a nibble of the column, otherwise data written at the
+    column, which then advances.  */
+static void displayByte(uint8_t byte)
+{
+    unselected += (GPIOPinRead(nCS_OLEDPort, nCS_OLED) != 0);
+    if (GPIOPinRead(nDC_OLEDPort, nDC_OLED)) {
+        dataBytes++;
+        pageBytes[page]++;
+        display[page][column] = byte;
+        column = (column + 1) & (ccolOledMax - 1);
+        return;
+    }
+
+    commandBytes++;
+    commandsWhileBusy += hostDmaBusy();
+    if (argumentBytes > 0) {
+        argumentBytes--;
+    } else if ((byte & 0xF8) == 0xB0) {
+        page = byte & (cpagOledMax - 1);
+        pageSends[page]++;
+    } else if ((byte & 0xF0) == 0x00) {
+        column = (column & 0xF0) | (byte & 0x0F);
+    } else if ((byte & 0xF0) == 0x10) {
+        column = (column & 0x0F) | ((byte & 0x0F) << 4);
+    } else if ((byte == 0x8D) || (byte == 0xD9) || (byte == 0xDA) || (byte == 0x81)) {
+        argumentBytes = 1; // charge pump, pre-charge, COM pins and contrast
+    }
+}
+
+/** Lets the uDMA send everything queued, as the SSI3 interrupts would between frames.  */
+static void flush(void)
+{
+    for (uint32_t i = 0; OrbitOledUpdateBusy() && (i < 10000); i++) {
+        hostDmaAdvance(16);
+    }
+    CHECK(!OrbitOledUpdateBusy());
+}
+
+/** Returns whether the display shows what is in the frame buffer.  */
+static bool displayMatches(void)
+{
+    return memcmp(display, rgbOledBmp, cbOledDispMax) == 0;
+}
+
+/** Returns whether a page of the display shows what is in the frame buffer.  */
+static bool pageMatches(int ipag)
+{
+    return memcmp(display[ipag], &rgbOledBmp[ipag * ccolOledMax], ccolOledMax) == 0;
+}
+
+/** Returns whether a page has columns not yet taken by an update.  */
+static bool pageDirty(int ipag)
+{
+    return rgcolOledDirtyFirst[ipag] <= rgcolOledDirtyLast[ipag];
+}
+
+/** Called by the SSI3 interrupt when an update has been sent: every page not
+    marked dirty since must now be on the display.  */
+static void updateDone(void)
+{
+    doneCount++;
+    for (int ipag = 0; ipag < cpagOledMax; ipag++) {
+        staleAtDone += !pageDirty(ipag) && !pageMatches(ipag);
+    }
+}
+
+/** Lets the uDMA move up to maxDisableBytes while SSI3 is disabled, as it carries on
+    while OrbitOledMarkDirty or OrbitOledUpdate hold off the interrupt.  */
+static void dmaWhileDisabled(uint32_t interrupt)
+{
+    if ((interrupt == INT_SSI3) && hostDmaBusy() && (maxDisableBytes > 0)) {
+        hostDmaAdvance(randomNext() % (maxDisableBytes + 1));
+        completedDisabled += !hostDmaBusy();
+    }
+}
+
+/** Zeroes the byte and update counts.  */
+static void resetCounts(void)
+{
+    commandBytes = dataBytes = 0;
+    memset(pageSends, 0, sizeof(pageSends));
+    doneCount = 0;
+}
+
+// Like usnprintf, snprintf cuts the first two lines at OLED_STR - 1 characters, dropping the newline
+#pragma GCC diagnostic ignored "-Wformat-truncation"
+
+/** Draws the four lines displayInfoOLED does, with the same formats.  */
+static void drawFrame(const frame_t* frame)
+{
+    char dispStr[OLED_STR];
+
+    snprintf(dispStr, OLED_STR, "ALT: %4d [%4d]\n", frame->altitude, frame->altSetpoint);
+    OLEDStringDraw(dispStr, 0, 0);
+    snprintf(dispStr, OLED_STR, "YAW: %4d [%4d]\n", frame->yaw, frame->yawSetpoint);
+    OLEDStringDraw(dispStr, 0, 1);
+    snprintf(dispStr, OLED_STR, "M: %2d.%1d T: %2d.%1d", (int)PWM_DUTY_WHOLE(frame->mainDuty),
+             (int)PWM_DUTY_TENTHS(frame->mainDuty), (int)PWM_DUTY_WHOLE(frame->tailDuty),
+             (int)PWM_DUTY_TENTHS(frame->tailDuty));
+    OLEDStringDraw(dispStr, 0, 2);
+    snprintf(dispStr, OLED_STR, "MODE: %9s", "FLYING");
+    OLEDStringDraw(dispStr, 0, 3);
+}
+
+/** Moves a value a step either way at random, keeping it within limits.  */
+static int32_t wander(int32_t value, int32_t step, int32_t min, int32_t max)
+{
+    value += (int32_t)(randomNext() % (2 * step + 1)) - step;
+    return (value < min) ? min : (value > max) ? max : value;
+}
+
+/** Clearing sends every page whole, and the display then matches the cleared buffer.  */
+static void testClear(void)
+{
+    commandBytes = dataBytes = 0;
+    OrbitOledClear();
+    flush();
+    printf("clear: %lu data and %lu command bytes\n", (unsigned long)dataBytes, (unsigned long)commandBytes);
+    CHECK(dataBytes == cbOledDispMax);
+    CHECK(commandBytes == cpagOledMax * COMMAND_BYTES_PER_PAGE);
+    CHECK(displayMatches());
+}
+
+/** Only the columns of glyphs that change are dirty, and redrawing a frame dirties nothing.  */
+static void testDirtyRanges(void)
+{
+    frame_t frame = {50, 50, -12, -15, PWM_DUTY_TO_Q(46), PWM_DUTY_TO_Q(38)};
+
+    OrbitOledSetCharUpdate(0);
+    drawFrame(&frame);
+    for (int ipag = 0; ipag < cpagOledMax; ipag++) {
+        CHECK(rgcolOledDirtyFirst[ipag] <= rgcolOledDirtyLast[ipag]);
+        CHECK(rgcolOledDirtyLast[ipag] < ccolOledMax);
+    }
+    OrbitOledUpdate();
+    flush();
+    CHECK(displayMatches());
+
+    // One digit of the altitude changes
+    frame.altitude = 51;
+    drawFrame(&frame);
+    printf("altitude 50 to 51: page 0 dirty from column %d to %d", rgcolOledDirtyFirst[0], rgcolOledDirtyLast[0]);
+    for (int ipag = 1; ipag < cpagOledMax; ipag++) {
+        printf(", page %d %s", ipag, (rgcolOledDirtyFirst[ipag] <= rgcolOledDirtyLast[ipag]) ? "dirty" : "clean");
+        CHECK(rgcolOledDirtyFirst[ipag] > rgcolOledDirtyLast[ipag]);
+    }
+    printf("\n");
+    CHECK(rgcolOledDirtyFirst[0] >= 8 * cbOledChar); // within the glyph of the units digit
+    CHECK(rgcolOledDirtyLast[0] < 9 * cbOledChar);
+
+    uint32_t dirtyColumns = rgcolOledDirtyLast[0] - rgcolOledDirtyFirst[0] + 1;
+    commandBytes = dataBytes = 0;
+    OrbitOledUpdate();
+    flush();
+    CHECK(dataBytes == dirtyColumns);
+    CHECK(commandBytes == COMMAND_BYTES_PER_PAGE);
+    CHECK(displayMatches());
+
+    // The same frame again
+    drawFrame(&frame);
+    for (int ipag = 0; ipag < cpagOledMax; ipag++) {
+        CHECK(rgcolOledDirtyFirst[ipag] > rgcolOledDirtyLast[ipag]);
+    }
+    commandBytes = dataBytes = 0;
+    OrbitOledUpdate();
+    flush();
+    CHECK(dataBytes == 0);
+    CHECK(commandBytes == 0);
+    OrbitOledSetCharUpdate(1);
+}
+
+/** Frames of a hovering helicopter, drawn as displayInfoOLED draws them, each string
+    starting an update, send a few bytes each, and leave the display matching.  */
+static void testTypicalFrames(void)
+{
+    frame_t frame = {50, 50, 0, 0, PWM_DUTY_TO_Q(46), PWM_DUTY_TO_Q(38)};
+    uint32_t totalData = 0, totalCommand = 0, maxBytes = 0, wrong = 0;
+
+    drawFrame(&frame);
+    flush();
+    memset(pageBytes, 0, sizeof(pageBytes));
+    for (uint32_t i = 0; i < FRAMES; i++) {
+        frame.altitude = wander(frame.altitude, 1, 45, 55);
+        frame.yaw = wander(frame.yaw, 2, -10, 10);
+        frame.mainDuty = wander(frame.mainDuty, 1 << (PWM_DUTY_Q_BITS - 3),
+                                PWM_DUTY_TO_Q(40), PWM_DUTY_TO_Q(50));
+        frame.tailDuty = wander(frame.tailDuty, 1 << (PWM_DUTY_Q_BITS - 3),
+                                PWM_DUTY_TO_Q(30), PWM_DUTY_TO_Q(45));
+
+        commandBytes = dataBytes = 0;
+        drawFrame(&frame);
+        flush();
+        wrong += !displayMatches();
+        totalData += dataBytes;
+        totalCommand += commandBytes;
+        maxBytes = (dataBytes + commandBytes > maxBytes) ? dataBytes + commandBytes : maxBytes;
+    }
+
+    uint32_t fullBytes = cbOledDispMax + cpagOledMax * COMMAND_BYTES_PER_PAGE;
+    double meanBytes = (double)(totalData + totalCommand) / FRAMES;
+    printf("displayInfoOLED frame: mean %.1f data and %.1f command bytes, %.0f us at 8 MHz, max %lu bytes; "
+           "a full screen update %lu bytes, four of them %lu\n",
+           (double)totalData / FRAMES, (double)totalCommand / FRAMES, meanBytes * SSI_BYTE_US,
+           (unsigned long)maxBytes, (unsigned long)fullBytes, (unsigned long)(4 * fullBytes));
+    printf("data bytes per frame by page (altitude, yaw, duties, mode):");
+    for (int ipag = 0; ipag < cpagOledMax; ipag++) {
+        printf(" %.1f", (double)pageBytes[ipag] / FRAMES);
+    }
+    printf("\n");
+    CHECK(pageBytes[3] == 0); // the mode does not change
+    CHECK(wrong == 0);
+    CHECK(unselected == 0);
+    CHECK(meanBytes < fullBytes / 8);
+    CHECK(maxBytes < fullBytes);
+}
+
+/** An update is busy until its last page is sent, and however many updates are asked
+    for while busy, only one more pass follows, sending what was drawn meanwhile.  */
+static void testBusyAndPending(void)
+{
+    frame_t frame = {20, 20, 0, 0, PWM_DUTY_TO_Q(46), PWM_DUTY_TO_Q(38)};
+
+    OrbitOledSetCharUpdate(0);
+    drawFrame(&frame);
+    OrbitOledUpdate();
+    flush();
+
+    // Altitude and yaw change, and page 0 starts going out
+    resetCounts();
+    frame.altitude = 21;
+    frame.yaw = 1;
+    drawFrame(&frame);
+    OrbitOledUpdate();
+    CHECK(OrbitOledUpdateBusy());
+    CHECK(hostDmaBusy());
+    CHECK(pageSends[0] == 1);
+    CHECK(!pageDirty(0) && pageDirty(1));
+
+    // The altitude changes again while page 0 is sent, then five more updates are asked for
+    frame.altitude = 22;
+    drawFrame(&frame);
+    CHECK(pageDirty(0));
+    for (int i = 0; i < 5; i++) {
+        OrbitOledUpdate();
+        CHECK(OrbitOledUpdateBusy());
+    }
+    flush();
+    CHECK(doneCount == 1);
+    CHECK((pageSends[0] == 2) && (pageSends[1] == 1) && (pageSends[2] == 0) && (pageSends[3] == 0));
+    CHECK(displayMatches());
+
+    // Nothing to send finishes at once
+    resetCounts();
+    OrbitOledUpdate();
+    CHECK(!OrbitOledUpdateBusy());
+    CHECK(doneCount == 1);
+    CHECK(commandBytes == 0);
+    CHECK(commandsWhileBusy == 0);
+}
+
+/** Drawing on a page already sent marks it for the next update, rather than being lost
+    or sent half drawn.  */
+static void testDrawDuringTransfer(void)
+{
+    frame_t frame = {30, 30, 0, 0, PWM_DUTY_TO_Q(46), PWM_DUTY_TO_Q(38)};
+
+    drawFrame(&frame);
+    OrbitOledUpdate();
+    flush();
+
+    frame.altitude = 31;
+    drawFrame(&frame);
+    OrbitOledUpdate();
+    hostDmaAdvance(1); // page 0 part sent
+    frame.altitude = 32;
+    drawFrame(&frame); // no update asked for
+    flush();
+    CHECK(!pageMatches(0));
+    CHECK(pageDirty(0));
+
+    OrbitOledUpdate();
+    flush();
+    CHECK(displayMatches());
+    OrbitOledSetCharUpdate(1);
+}
+
+/** A transfer completing while OrbitOledMarkDirty has SSI3 disabled is handled once it
+    is enabled again, so the next page sent takes the range just marked.  */
+static void testCompleteInMarkDirty(void)
+{
+    frame_t frame = {40, 40, 0, 0, PWM_DUTY_TO_Q(46), PWM_DUTY_TO_Q(38)};
+
+    OrbitOledSetCharUpdate(0);
+    drawFrame(&frame);
+    OrbitOledUpdate();
+    flush();
+
+    // Pages 0 and 1 change, and page 0 starts going out
+    resetCounts();
+    frame.altitude = 41;
+    frame.yaw = 5;
+    drawFrame(&frame);
+    OrbitOledUpdate();
+    CHECK(pageSends[0] == 1);
+
+    // The yaw changes again, and page 0's transfer completes inside the marking
+    completedDisabled = 0;
+    maxDisableBytes = ccolOledMax;
+    hostIntDisableHook = dmaWhileDisabled;
+    frame.yaw = 6;
+    drawFrame(&frame);
+    hostIntDisableHook = NULL;
+    maxDisableBytes = 0;
+    CHECK(completedDisabled == 1);
+    CHECK(pageSends[1] == 1); // started by the interrupt once enabled
+    CHECK(!pageDirty(1)); // and took the new range with it
+
+    flush();
+    CHECK(doneCount == 1);
+    CHECK(pageSends[1] == 1);
+    CHECK(displayMatches());
+    OrbitOledSetCharUpdate(1);
+}
+
+/** Runs a main loop whose display task draws a frame whenever the last has gone out,
+    as displayTask does, while the uDMA moves on between and inside its calls. Every
+    update leaves the pages it did not see changed on the display.  */
+static void testInterleaved(void)
+{
+    frame_t frame = {50, 50, 0, 0, PWM_DUTY_TO_Q(46), PWM_DUTY_TO_Q(38)};
+    uint32_t drawn = 0, skipped = 0;
+
+    resetCounts();
+    staleAtDone = completedDisabled = commandsWhileBusy = 0;
+    maxDisableBytes = 24;
+    hostIntDisableHook = dmaWhileDisabled;
+    for (uint32_t i = 0; i < STRESS_STEPS; i++) {
+        hostDmaAdvance(randomNext() % 64);
+        if (OLEDUpdateBusy()) {
+            skipped++;
+            continue;
+        }
+        frame.altitude = wander(frame.altitude, 3, 0, 100);
+        frame.yaw = wander(frame.yaw, 5, -180, 179);
+        frame.mainDuty = wander(frame.mainDuty, 1 << (PWM_DUTY_Q_BITS - 2), PWM_DUTY_TO_Q(2), PWM_DUTY_TO_Q(98));
+        drawFrame(&frame);
+        drawn++;
+    }
+    hostIntDisableHook = NULL;
+    maxDisableBytes = 0;
+    flush();
+
+    printf("main loop: %lu frames drawn, %lu skipped while busy, %lu transfers completed with SSI3 disabled\n",
+           (unsigned long)drawn, (unsigned long)skipped, (unsigned long)completedDisabled);
+    CHECK(displayMatches());
+    CHECK(staleAtDone == 0);
+    CHECK(commandsWhileBusy == 0);
+    CHECK(doneCount >= drawn); // each string starts an update, all finished before the next frame
+    CHECK(completedDisabled > 0);
+}
+
+/** Times the display task's drawing, which now returns without waiting for the
+    display, against the time the bytes it sends take on SSI3, which OrbitOledPutBuffer
+    used to busy-wait through.  */
+static void testBench(void)
+{
+    frame_t frame = {50, 50, 0, 0, PWM_DUTY_TO_Q(46), PWM_DUTY_TO_Q(38)};
+    uint64_t drawNs = 0, interruptNs = 0;
+    uint32_t bytes = 0;
+
+    for (uint32_t i = 0; i < FRAMES; i++) {
+        frame.altitude = wander(frame.altitude, 1, 45, 55);
+        frame.yaw = wander(frame.yaw, 2, -10, 10);
+        frame.mainDuty = wander(frame.mainDuty, 1 << (PWM_DUTY_Q_BITS - 3), PWM_DUTY_TO_Q(40), PWM_DUTY_TO_Q(50));
+
+        resetCounts();
+        uint64_t start = testNowNs();
+        drawFrame(&frame);
+        uint64_t drawnAt = testNowNs();
+        flush();
+        drawNs += drawnAt - start;
+        interruptNs += testNowNs() - drawnAt;
+        bytes += dataBytes + commandBytes;
+    }
+    printf("display task: %.2f us drawing and %.2f us in SSI3 interrupts per frame on the host; "
+           "its %.1f bytes take %.0f us on SSI3, formerly busy-waited\n",
+           drawNs / 1e3 / FRAMES, interruptNs / 1e3 / FRAMES, (double)bytes / FRAMES,
+           (double)bytes * SSI_BYTE_US / FRAMES);
+    CHECK(displayMatches());
+}
+
+int main(void)
+{
+    hostSsiTxHook = displayByte;
+    OrbitOledSetUpdateDone(updateDone);
+    OLEDInitialise();
+    flush();
+    CHECK(displayMatches());
+
+    testClear();
+    testDirtyRanges();
+    testTypicalFrames();
+    testBusyAndPending();
+    testDrawDuringTransfer();
+    testCompleteInMarkDirty();
+    testInterleaved();
+    testBench();
+    return testReport("test_oled");
+}
@@ -0,0 +1,237 @@
+/** @file   test_pacer.c
+    @author Bailey Lissington, Dillon Pike, Joseph Ramirez
+    @date   21 May 2021
+    @brief  Host tests of the pacer's sleep accounting on a fake timebase: when it sleeps,
+            the time asleep, wakes by the match against other interrupts, wake latency,
+            the CPU load the statistics give, and the interrupt masking around the WFI.
+*/
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "tivaware.h"
+#include "timebase.h"
+#include "pacer.h"
+#include "test.h"
+
+#define TICK_RATE 20000000 // fake timebase rate, the target's system clock
+#define MIN_SLEEP_TICKS 400 // PACER_MIN_SLEEP_US at TICK_RATE
+
+static uint64_t now; // fake timebase ticks, whose low 32 bits are the count
+static uint32_t match;
+static bool matched; // match interrupt pending
+
+// What the next WFI does: wake at the match plus wakeLatency, or after wakeAfter
+// ticks on another interrupt if that is sooner
+static uint32_t wakeLatency;
+static uint32_t wakeAfter;
+static bool maskedInWfi; // interrupts were masked when the WFI ran
+
+uint32_t timebaseGetCount(void)
+{
+    return (uint32_t)now;
+}
+
+uint64_t timebaseGetTicks(void)
+{
+    return now;
+}
+
+uint32_t timebaseGetTickRate(void)
+{
+    return TICK_RATE;
+}
+
+void timebaseSetMatch(uint32_t count)
+{
+    match = count;
+    matched = false;
+}
+
+bool timebaseMatched(void)
+{
+    return matched;
+}
+
+/** Sleeps the fake processor until the match or another interrupt wakes it.  */
+static void wfi(void)
+{
+    uint32_t untilMatch = match - (uint32_t)now;
+
+    maskedInWfi = hostIntMasked;
+    if ((wakeAfter != 0) && (wakeAfter < untilMatch)) {
+        now += wakeAfter;
+    } else {
+        now += untilMatch + wakeLatency;
+        matched = true;
+    }
+}
+
+/** Starts a new set of statistics at a time, with wakes on the match after a latency.  */
+static void reset(uint64_t time, uint32_t latency)
+{
+    now = time;
+    wakeLatency = latency;
+    wakeAfter = 0;
+    hostWfiCount = 0;
+    hostIntMasked = false;
+    initPacer();
+}
+
+/** A wake on the match counts the time asleep and the latency from the match.  */
+static void testMatchWake(void)
+{
+    pacerSleepStats_t stats;
+
+    reset(1000, 37);
+    pacerSleepUntil(11000);
+    CHECK(hostWfiCount == 1);
+    CHECK(now == 11037);
+    CHECK(maskedInWfi);
+    CHECK(!hostIntMasked);
+
+    now += 500; // running for a while after waking
+    pacerGetSleepStats(&stats);
+    CHECK(stats.elapsed == 10537);
+    CHECK(stats.asleep == 10037);
+    CHECK(stats.wakeups == 1);
+    CHECK(stats.latencyMax == 37);
+    CHECK(stats.latencyTotal == 37);
+
+    wakeLatency = 12;
+    pacerSleepUntil((uint32_t)now + 1000);
+    pacerGetSleepStats(&stats);
+    CHECK(stats.wakeups == 2);
+    CHECK(stats.latencyMax == 37);
+    CHECK(stats.latencyTotal == 49);
+}
+
+/** A wait no longer than the minimum, or already past, returns without sleeping.  */
+static void testTooClose(void)
+{
+    pacerSleepStats_t stats;
+
+    reset(5000, 0);
+    pacerSleepUntil(5000 + MIN_SLEEP_TICKS);
+    pacerSleepUntil(5000);
+    pacerSleepUntil(4000);
+    CHECK(hostWfiCount == 0);
+    CHECK(now == 5000);
+    CHECK(!hostIntMasked);
+
+    pacerSleepUntil(5000 + MIN_SLEEP_TICKS + 1);
+    CHECK(hostWfiCount == 1);
+    pacerGetSleepStats(&stats);
+    CHECK(stats.asleep == MIN_SLEEP_TICKS + 1);
+}
+
+/** Another interrupt waking the processor early counts as time asleep but not as a
+    wake by the match, so its latency is not recorded.  */
+static void testOtherWake(void)
+{
+    pacerSleepStats_t stats;
+
+    reset(0, 0);
+    wakeAfter = 3000;
+    pacerSleepUntil(10000);
+    pacerGetSleepStats(&stats);
+    CHECK(now == 3000);
+    CHECK(stats.asleep == 3000);
+    CHECK(stats.wakeups == 0);
+    CHECK(stats.latencyTotal == 0);
+}
+
+/** Interrupts masked by the caller stay masked.  */
+static void testMaskedCaller(void)
+{
+    reset(0, 0);
+    hostIntMasked = true;
+    pacerSleepUntil(10000);
+    CHECK(hostWfiCount == 1);
+    CHECK(maskedInWfi);
+    CHECK(hostIntMasked);
+    hostIntMasked = false;
+}
+
+/** Sleeps that cross the wrap of the 32 bit count are measured correctly.  */
+static void testWrap(void)
+{
+    pacerSleepStats_t stats;
+
+    reset(UINT32_MAX - 999, 5);
+    pacerSleepUntil(1000);
+    pacerGetSleepStats(&stats);
+    CHECK(hostWfiCount == 1);
+    CHECK((uint32_t)now == 1005);
+    CHECK(stats.asleep == 2005);
+    CHECK(stats.elapsed == 2005);
+    CHECK(stats.latencyMax == 5);
+}
+
+/** Statistics left running for longer than the 32 bit count takes to wrap still cover
+    all the time since they were reset.  */
+static void testLongRun(void)
+{
+    const uint32_t period = TICK_RATE / 100; // 100 Hz loop
+    const uint32_t busy = period / 4;
+    uint32_t release = 0;
+    pacerSleepStats_t stats;
+
+    reset(0, 0);
+    for (int i = 0; i < 300 * 100; i++) { // 300 s
+        now += busy;
+        release += period;
+        pacerSleepUntil(release);
+    }
+    pacerGetSleepStats(&stats);
+    printf("300 s at 25%% load: %llu ticks elapsed, load %.2f%%\n",
+           (unsigned long long)stats.elapsed, 100.0 * (stats.elapsed - stats.asleep) / stats.elapsed);
+    CHECK(stats.elapsed == 300ULL * TICK_RATE);
+    CHECK(stats.elapsed - stats.asleep == 300ULL * 100 * busy);
+}
+
+/** Over a paced loop, the time asleep accounts for all the time not spent running, so
+    the statistics give the CPU load, and resetting them starts again from zero.  */
+static void testLoad(void)
+{
+    const uint32_t period = TICK_RATE / 1000; // 1 kHz loop
+    const uint32_t busy = period * 3 / 10;
+    uint32_t release = 0;
+    pacerSleepStats_t stats;
+
+    reset(0, 20);
+    for (int i = 0; i < 1000; i++) {
+        now += busy;
+        release += period;
+        pacerSleepUntil(release);
+    }
+    pacerGetSleepStats(&stats);
+    printf("1 kHz loop running 30%% of each period: load %.2f%%, %lu wakes, mean latency %.1f ticks\n",
+           100.0 * (stats.elapsed - stats.asleep) / stats.elapsed, (unsigned long)stats.wakeups,
+           (double)stats.latencyTotal / stats.wakeups);
+    CHECK(stats.wakeups == 1000);
+    CHECK(stats.elapsed - stats.asleep == 1000 * busy); // the wake latency counts as asleep
+    CHECK(stats.latencyTotal == 1000 * 20);
+
+    pacerResetSleepStats();
+    pacerGetSleepStats(&stats);
+    CHECK(stats.elapsed == 0);
+    CHECK(stats.asleep == 0);
+    CHECK(stats.wakeups == 0);
+    CHECK(stats.latencyMax == 0);
+}
+
+int main(void)
+{
+    hostWfiHook = wfi;
+
+    testMatchWake();
+    testTooClose();
+    testOtherWake();
+    testMaskedCaller();
+    testWrap();
+    testLoad();
+    testLongRun();
+    return testReport("test_pacer");
+}
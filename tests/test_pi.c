@@ -0,0 +1,168 @@
+/** @file   test_pi.c
+    @author Bailey Lissington, Dillon Pike, Joseph Ramirez
+    @date   21 May 2021
+    @brief  Host tests of the PI controllers: recovery after saturation with
+            back-calculation against the conditional integration it replaced,
+            compensation inside the saturation, and bumpless transfer between modes.
+*/
+
+#include <stdio.h>
+#include <stdbool.h>
+
+#include "pi.h"
+#include "test.h"
+
+#define STEP_S 0.01 // rate loop period
+#define SATURATE_START_S 5.0 // time the disturbance saturates the loop at
+#define SATURATE_END_S 8.0 // time the disturbance is removed at
+#define RUN_S 15.0
+
+// A rate loop on a first-order plant, rate' = (gain * (duty - need) - rate) / tau,
+// where need is the duty that holds the rate at 0. A disturbance raises or lowers
+// need beyond the duty limits for a while, saturating the loop.
+typedef struct {
+    const char* name;
+    bool tail; // tail or main rate PI
+    double gain;
+    double tau;
+    double need;
+    double saturatedNeed;
+    double setRate;
+    double settleBand;
+} scenario_t;
+
+static const scenario_t scenarios[] = {
+    {"tail, disturbance above the limit", true, 20.0, 0.5, 30.0, 110.0, 45.0, 2.0},
+    {"tail, disturbance below the limit", true, 20.0, 0.5, 30.0, -10.0, 0, 2.0},
+    {"main, disturbance above the limit", false, 3.0, 0.8, 40.0, 110.0, 0, 1.0},
+    {"main, disturbance below the limit", false, 3.0, 0.8, 40.0, -5.0, 0, 1.0},
+    {"main, climbing", false, 3.0, 0.8, 60.0, 100.0, 5.0, 1.0},
+};
+
+static double conditionalIntegral = 0;
+
+/** The rate PI as it was before back-calculation: integration is skipped
+    whenever the output saturates.  */
+static double conditionalPiCompute(double error, double kp, double ki, double deltaT)
+{
+    double deltaI = error * deltaT;
+    double control = error * kp + (conditionalIntegral + deltaI) * ki;
+
+    if (control < PI_MIN) {
+        control = PI_MIN;
+    } else if (control > PI_MAX) {
+        control = PI_MAX;
+    } else {
+        conditionalIntegral += deltaI;
+    }
+    return control;
+}
+
+/** Simulates a scenario and measures how long the loop takes to recover once
+    the saturating disturbance is removed.
+    @param scenario to simulate.
+    @param true to use pi.c, false to use conditional integration.
+    @return time from the end of saturation until the rate stays within the settle band, in s.  */
+static double recoveryTime(const scenario_t* s, bool backCalculation)
+{
+    double rate = 0;
+    double settled = -1;
+    resetErrorIntegrals();
+    conditionalIntegral = 0;
+
+    for (int i = 0; i < (int)(RUN_S / STEP_S); i++) {
+        double t = i * STEP_S;
+        bool saturating = (t >= SATURATE_START_S) && (t < SATURATE_END_S);
+        double duty;
+
+        if (!backCalculation) {
+            duty = s->tail ? conditionalPiCompute(s->setRate - rate, TAIL_RATE_KP, TAIL_RATE_KI, STEP_S)
+                           : conditionalPiCompute(s->setRate - rate, MAIN_RATE_KP, MAIN_RATE_KI, STEP_S);
+        } else if (s->tail) {
+            duty = tailRatePiCompute(s->setRate, rate, STEP_S);
+        } else {
+            duty = mainRatePiCompute(s->setRate, rate, 0, STEP_S);
+        }
+        rate += (s->gain * (duty - (saturating ? s->saturatedNeed : s->need)) - rate) / s->tau * STEP_S;
+
+        if (t >= SATURATE_END_S) {
+            if (fabs(rate - s->setRate) > s->settleBand) {
+                settled = -1;
+            } else if (settled < 0) {
+                settled = t - SATURATE_END_S;
+            }
+        }
+    }
+    return settled;
+}
+
+/** Recovery after saturation is no slower than with conditional integration.  */
+static void testSaturationRecovery(void)
+{
+    for (unsigned i = 0; i < sizeof(scenarios) / sizeof(scenarios[0]); i++) {
+        double back = recoveryTime(&scenarios[i], true);
+        double conditional = recoveryTime(&scenarios[i], false);
+        printf("%s: back-calculation recovers in %.2f s, conditional integration in %.2f s\n",
+               scenarios[i].name, back, conditional);
+        CHECK(back > 0);
+        CHECK(conditional > 0);
+        CHECK(back <= conditional);
+    }
+}
+
+/** Saturated output unwinds: once the error reverses the output leaves the limit
+    within a few steps, rather than waiting for an integral to run down.  */
+static void testUnwind(void)
+{
+    resetErrorIntegrals();
+    for (int i = 0; i < 1000; i++) {
+        mainRatePiCompute(20.0, 0, 0, STEP_S); // 10 s with the error held, saturated
+    }
+    CHECK_NEAR(mainRatePiCompute(20.0, 0, 0, STEP_S), PI_MAX, 1e-9);
+    int steps = 0;
+    while ((mainRatePiCompute(-5.0, 0, 0, STEP_S) >= PI_MAX) && (steps < 1000)) {
+        steps++;
+    }
+    CHECK(steps < 10);
+}
+
+/** Compensation adds to the output and counts towards saturation, so the integral unwinds
+    against the duty applied and the output leaves the limit as soon as the compensation falls.  */
+static void testCompensation(void)
+{
+    mainRatePiTransfer(0, 0, 50.0);
+    CHECK_NEAR(mainRatePiCompute(0, 0, 10.0, STEP_S), 60.0, 1e-9);
+
+    for (int i = 0; i < 100; i++) {
+        CHECK_NEAR(mainRatePiCompute(0, 0, 70.0, STEP_S), PI_MAX, 1e-9); // 50 + 70 saturates
+    }
+    CHECK_NEAR(mainRatePiCompute(0, 0, 60.0, STEP_S), PI_MAX - 10.0, 0.5);
+}
+
+/** The first output after a transfer continues from the duty the previous mode left.  */
+static void testBumplessTransfer(void)
+{
+    const double duties[] = {PI_MIN, 25.0, 52.5, PI_MAX};
+    const double errors[] = {-30.0, 0, 12.0};
+
+    for (unsigned i = 0; i < sizeof(duties) / sizeof(duties[0]); i++) {
+        for (unsigned j = 0; j < sizeof(errors) / sizeof(errors[0]); j++) {
+            mainRatePiTransfer(errors[j], 0, duties[i]);
+            double main = mainRatePiCompute(errors[j], 0, 0, STEP_S);
+            CHECK(fabs(main - duties[i]) <= fabs(errors[j]) * MAIN_RATE_KI * STEP_S + 1e-9);
+
+            tailRatePiTransfer(errors[j], 0, duties[i]);
+            double tail = tailRatePiCompute(errors[j], 0, STEP_S);
+            CHECK(fabs(tail - duties[i]) <= fabs(errors[j]) * TAIL_RATE_KI * STEP_S + 1e-9);
+        }
+    }
+}
+
+int main(void)
+{
+    testSaturationRecovery();
+    testUnwind();
+    testCompensation();
+    testBumplessTransfer();
+    return testReport("test_pi");
+}
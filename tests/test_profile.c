@@ -0,0 +1,137 @@
+/** @file   test_profile.c
+    @author Bailey Lissington, Dillon Pike, Joseph Ramirez
+    @date   21 May 2021
+    @brief  Host tests of the profiler: histogram binning at each bin edge, the
+            count, min, max and total of a probe, clearing on report, and the cost
+            of a probe. Built with PROFILING, where a host profiler tick is 1 ns.
+*/
+
+#include "profile.c" // the statistics are static, so are checked directly
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "test.h"
+
+#define BENCH_RUNS 1000000
+
+// Execution time and the histogram bin it belongs in
+typedef struct {
+    uint32_t ticks;
+    uint8_t bin;
+} binCase_t;
+
+/** Returns the only histogram bin of a probe holding a count, or PROFILE_HIST_BINS if none
+    or more than one do.  */
+static uint8_t onlyBin(profileProbe_t probe)
+{
+    uint8_t found = PROFILE_HIST_BINS;
+    for (uint8_t bin = 0; bin < PROFILE_HIST_BINS; bin++) {
+        if (stats[probe].hist[bin] != 0) {
+            if (found != PROFILE_HIST_BINS) {
+                return PROFILE_HIST_BINS;
+            }
+            found = bin;
+        }
+    }
+    return found;
+}
+
+/** Times either side of each bin edge land in the bins the report's header names:
+    <1, <2, <4 ... <64 and >=64 us.  */
+static void testBins(void)
+{
+    const binCase_t cases[] = {
+        {0, 0}, {999, 0},
+        {1000, 1}, {1999, 1},
+        {2000, 2}, {3999, 2},
+        {4000, 3}, {7999, 3},
+        {8000, 4}, {15999, 4},
+        {16000, 5}, {31999, 5},
+        {32000, 6}, {63999, 6},
+        {64000, 7}, {1000000, 7}, {UINT32_MAX, 7},
+    };
+
+    for (unsigned i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        profileClear();
+        profileRecord(PROFILE_CONTROL, cases[i].ticks);
+        if (onlyBin(PROFILE_CONTROL) != cases[i].bin) {
+            printf("%lu ticks binned in %u, expected %u\n", (unsigned long)cases[i].ticks,
+                   onlyBin(PROFILE_CONTROL), cases[i].bin);
+        }
+        CHECK(onlyBin(PROFILE_CONTROL) == cases[i].bin);
+    }
+}
+
+/** A probe's count, min, max and total cover every time recorded, and no other probe's.  */
+static void testStatistics(void)
+{
+    const uint32_t times[] = {5000, 1200, 70000, 300};
+    uint32_t histTotal = 0;
+
+    profileClear();
+    for (unsigned i = 0; i < sizeof(times) / sizeof(times[0]); i++) {
+        profileRecord(PROFILE_ADC_ISR, times[i]);
+    }
+    CHECK(stats[PROFILE_ADC_ISR].count == 4);
+    CHECK(stats[PROFILE_ADC_ISR].min == 300);
+    CHECK(stats[PROFILE_ADC_ISR].max == 70000);
+    CHECK(stats[PROFILE_ADC_ISR].total == 76500);
+    for (uint8_t bin = 0; bin < PROFILE_HIST_BINS; bin++) {
+        histTotal += stats[PROFILE_ADC_ISR].hist[bin];
+    }
+    CHECK(histTotal == 4);
+    CHECK(stats[PROFILE_ADC_ISR].hist[0] == 1);
+    CHECK(stats[PROFILE_ADC_ISR].hist[1] == 1);
+    CHECK(stats[PROFILE_ADC_ISR].hist[3] == 1);
+    CHECK(stats[PROFILE_ADC_ISR].hist[7] == 1);
+    CHECK(stats[PROFILE_YAW_ISR].count == 0);
+}
+
+/** Reporting clears every probe.  */
+static void testReportClears(void)
+{
+    profileClear();
+    profileRecord(PROFILE_OLED, 2500);
+    profileReport();
+    CHECK(stats[PROFILE_OLED].count == 0);
+    CHECK(stats[PROFILE_OLED].min == UINT32_MAX);
+    CHECK(stats[PROFILE_OLED].total == 0);
+    CHECK(onlyBin(PROFILE_OLED) == PROFILE_HIST_BINS);
+}
+
+/** A probe records one run of its section, and its own cost.  */
+static void testProbe(void)
+{
+    profileClear();
+    uint64_t start = testNowNs();
+    for (int i = 0; i < BENCH_RUNS; i++) {
+        PROFILE_START(PROFILE_PWM);
+        PROFILE_END(PROFILE_PWM);
+    }
+    double probeNs = (double)(testNowNs() - start) / BENCH_RUNS;
+
+    start = testNowNs();
+    for (int i = 0; i < BENCH_RUNS; i++) {
+        profileRecord(PROFILE_SERIAL, (uint32_t)i);
+    }
+    double recordNs = (double)(testNowNs() - start) / BENCH_RUNS;
+
+    printf("probe around an empty section: %.1f ns, of which profileRecord %.1f ns\n", probeNs, recordNs);
+    CHECK(stats[PROFILE_PWM].count == BENCH_RUNS);
+    CHECK(stats[PROFILE_SERIAL].count == BENCH_RUNS);
+    CHECK(stats[PROFILE_PWM].min < 1000); // an empty section fits the first bin at least once
+}
+
+int main(void)
+{
+    profileInit();
+    CHECK(ticksPerUs == 1000);
+
+    testBins();
+    testStatistics();
+    testReportClears();
+    testProbe();
+    return testReport("test_profile");
+}
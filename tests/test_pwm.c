@@ -0,0 +1,250 @@
+/** @file   test_pwm.c
+    @author Bailey Lissington, Dillon Pike, Joseph Ramirez
+    @date   21 May 2021
+    @brief  Host tests of the PWM module against a model of the generators: the
+            period and compare values setPWMDuty and setPWMFrequency calculate, that
+            both are staged until the same period boundary, and a benchmark of a duty
+            update against the setPWMDuty that got the clock and period every call.
+*/
+
+#define _POSIX_C_SOURCE 199309L // benchmark clock
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "tivaware.h"
+#include "clock.h"
+#include "pwm.h"
+#include "test.h"
+
+// Generators the rotors are on, as in pwm.c
+#define MAIN_BASE PWM0_BASE
+#define MAIN_GEN PWM_GEN_3
+#define TAIL_BASE PWM1_BASE
+#define TAIL_GEN PWM_GEN_2
+
+#define BENCH_CALLS 1000000
+#define REF_PWM_HZ 250 // fixed frequency of the old setPWMDuty, PWM_START_HZ in pwm.c
+#define REF_PWM_DIVIDER 1 // PWM_DIVIDER in pwm.c
+
+// Registers TivaWare's SysCtlClockGet and PWMPulseWidthSet read on the TM4C123
+#define REF_SYSCTL_RCC 0x400FE060
+#define REF_SYSCTL_RCC2 0x400FE070
+#define REF_SYSCTL_PLLFREQ0 0x400FE160
+#define REF_SYSCTL_PLLFREQ1 0x400FE164
+#define REF_PWM_O_X_CTL 0x00000000
+#define REF_PWM_X_CTL_MODE 0x00000002 // up/down counting
+
+/** Passes a period boundary on both generators.  */
+static void boundary(void)
+{
+    hostPwmBoundary(MAIN_BASE, MAIN_GEN);
+    hostPwmBoundary(TAIL_BASE, TAIL_GEN);
+}
+
+/** Returns the duty a generator is producing in %.  */
+static double activeDuty(uint32_t base, uint32_t generator)
+{
+    hostPwmGen_t gen = hostPwmActive(base, generator);
+    return 100.0 * (gen.load - gen.compare) / gen.load;
+}
+
+/** Duties are staged until pwmCommit and the next boundary, and land within a count.  */
+static void testDuty(void)
+{
+    const double duties[] = {2.0, 12.5, 33.3, 50.0, 71.25, 98.0};
+
+    for (unsigned i = 0; i < sizeof(duties) / sizeof(duties[0]); i++) {
+        double before = activeDuty(MAIN_BASE, MAIN_GEN);
+        setPWMDuty(PWM_DUTY_TO_Q(duties[i]), MAIN);
+        setPWMDuty(PWM_DUTY_TO_Q(100 - duties[i]), TAIL);
+        boundary();
+        CHECK(activeDuty(MAIN_BASE, MAIN_GEN) == before); // not committed yet
+
+        pwmCommit();
+        CHECK(activeDuty(MAIN_BASE, MAIN_GEN) == before); // committed, waiting for the boundary
+        boundary();
+        double count = 100.0 / hostPwmActive(MAIN_BASE, MAIN_GEN).load;
+        CHECK_NEAR(activeDuty(MAIN_BASE, MAIN_GEN), duties[i], count);
+        CHECK_NEAR(activeDuty(TAIL_BASE, TAIL_GEN), 100 - duties[i], count);
+    }
+}
+
+/** Sets the clock registers as initClock leaves them: RCC2 in use on the 16 MHz crystal,
+    the 400 MHz PLL halved and divided by SYS_CLOCK_DIV.  */
+static void refClockInit(void)
+{
+    HWREG(REF_SYSCTL_RCC) = (0x15 << 6) | (1 << 22); // XTAL 16 MHz, USESYSDIV
+    HWREG(REF_SYSCTL_RCC2) = (1UL << 31) | ((SYS_CLOCK_DIV - 1) << 23); // USERCC2, SYSDIV2
+    HWREG(REF_SYSCTL_PLLFREQ0) = 50; // MINT
+    HWREG(REF_SYSCTL_PLLFREQ1) = 1; // N
+}
+
+/** The work TivaWare's SysCtlClockGet does for that clock: reads the clock registers,
+    looks up the crystal, and works forward through the PLL and the system divider.  */
+static uint32_t refClockGet(void)
+{
+    static const uint32_t xtals[] = {
+        1000000, 1843200, 2000000, 2457600, 3579545, 3686400, 4000000, 4096000, 4915200,
+        5000000, 5120000, 6000000, 6144000, 7372800, 8000000, 8192000, 10000000, 12000000,
+        12288000, 13560000, 14318180, 16000000, 16384000, 18000000, 20000000, 24000000, 25000000
+    };
+    uint32_t rcc = HWREG(REF_SYSCTL_RCC);
+    uint32_t rcc2 = HWREG(REF_SYSCTL_RCC2);
+    bool useRcc2 = rcc2 & (1UL << 31);
+    uint32_t clock;
+
+    switch (useRcc2 ? (rcc2 & 0x70) : (rcc & 0x30)) {
+    case 0x00: // main oscillator
+        clock = xtals[(rcc >> 6) & 0x1F];
+        break;
+    case 0x10:
+        clock = 16000000; // precision internal oscillator
+        break;
+    case 0x20:
+        clock = 16000000 / 4;
+        break;
+    default:
+        clock = 30000; // low frequency internal oscillator
+        break;
+    }
+    if (!(useRcc2 ? (rcc2 & (1 << 11)) : (rcc & (1 << 11)))) { // PLL not bypassed
+        uint32_t pll = HWREG(REF_SYSCTL_PLLFREQ0);
+        uint32_t pll1 = HWREG(REF_SYSCTL_PLLFREQ1);
+        clock /= (((pll1 >> 8) & 0x1F) + 1) * ((pll1 & 0x1F) + 1);
+        clock = clock * (pll & 0x3FF) + ((clock * ((pll >> 10) & 0x3FF)) >> 10);
+        clock /= 2;
+    }
+    if (rcc & (1 << 22)) { // system divider in use
+        clock /= useRcc2 ? ((rcc2 >> 23) & 0x3F) + 1 : ((rcc >> 23) & 0x0F) + 1;
+    }
+    return clock;
+}
+
+/** TivaWare's PWMPulseWidthSet for output B of a generator: reads the mode and the load,
+    then writes the compare register.  */
+static void refPulseWidthSet(uint32_t base, uint32_t generator, uint32_t width)
+{
+    if (HWREG(base + generator + REF_PWM_O_X_CTL) & REF_PWM_X_CTL_MODE) {
+        width /= 2;
+    }
+    HWREG(base + generator + PWM_O_X_CMPB) = HWREG(base + generator + PWM_O_X_LOAD) - width;
+}
+
+/** The setPWMDuty the cached path replaced, getting the clock and rewriting the period
+    every call.  */
+static void refSetPWMDuty(double duty, rotor chosenRotor)
+{
+    uint32_t period = refClockGet() / REF_PWM_DIVIDER / REF_PWM_HZ;
+
+    if (chosenRotor == MAIN) {
+        PWMGenPeriodSet(MAIN_BASE, MAIN_GEN, period);
+        refPulseWidthSet(MAIN_BASE, MAIN_GEN, (uint32_t)(period * duty / 100));
+    } else {
+        PWMGenPeriodSet(TAIL_BASE, TAIL_GEN, period);
+        refPulseWidthSet(TAIL_BASE, TAIL_GEN, (uint32_t)(period * duty / 100));
+    }
+}
+
+/** Time an update of both duties and the commit takes, as applyDuties makes every rate
+    task run, with the cached period and the old setPWMDuty, both at REF_PWM_HZ.  */
+static void testBench(void)
+{
+    CHECK(setPWMFrequency(MAIN, REF_PWM_HZ));
+    CHECK(setPWMFrequency(TAIL, REF_PWM_HZ));
+    refClockInit();
+    CHECK(refClockGet() == SYS_CLOCK_HZ);
+    HWREG(MAIN_BASE + MAIN_GEN + REF_PWM_O_X_CTL) = REF_PWM_X_CTL_MODE;
+    HWREG(TAIL_BASE + TAIL_GEN + REF_PWM_O_X_CTL) = REF_PWM_X_CTL_MODE;
+
+    uint64_t start = testNowNs();
+    for (uint32_t call = 0; call < BENCH_CALLS; call++) {
+        setPWMDuty((call & 0x3FFFFF) + PWM_DUTY_TO_Q(PWM_DUTY_MIN), MAIN);
+        setPWMDuty((call & 0x3FFFFF) + PWM_DUTY_TO_Q(PWM_DUTY_MIN), TAIL);
+        pwmCommit();
+    }
+    double cachedNs = (double)(testNowNs() - start) / BENCH_CALLS;
+
+    start = testNowNs();
+    for (uint32_t call = 0; call < BENCH_CALLS; call++) {
+        refSetPWMDuty(PWM_DUTY_FROM_Q((call & 0x3FFFFF) + PWM_DUTY_TO_Q(PWM_DUTY_MIN)), MAIN);
+        refSetPWMDuty(PWM_DUTY_FROM_Q((call & 0x3FFFFF) + PWM_DUTY_TO_Q(PWM_DUTY_MIN)), TAIL);
+        pwmCommit();
+    }
+    double referenceNs = (double)(testNowNs() - start) / BENCH_CALLS;
+
+    // Both write the same compare value for the same duty, to within a count
+    setPWMDuty(PWM_DUTY_TO_Q(37.5), MAIN);
+    double cachedCompare = HWREG(MAIN_BASE + MAIN_GEN + PWM_O_X_CMPB);
+    refSetPWMDuty(37.5, MAIN);
+    CHECK_NEAR(HWREG(MAIN_BASE + MAIN_GEN + PWM_O_X_CMPB), cachedCompare, 1);
+
+    printf("both duties and the commit: cached period %.1f ns, clock and period every call %.1f ns\n",
+           cachedNs, referenceNs);
+    CHECK(cachedNs < referenceNs);
+}
+
+/** A new frequency changes the period exactly and recomputes the compare value for the
+    same duty, and both reach the generator at the same boundary.  */
+static void testFrequency(void)
+{
+    const uint32_t frequencies[] = {153, 250, 333, 1000, 4321, 10000};
+    const double duty = 37.5;
+
+    setPWMDuty(PWM_DUTY_TO_Q(duty), MAIN);
+    pwmCommit();
+    boundary();
+
+    for (unsigned i = 0; i < sizeof(frequencies) / sizeof(frequencies[0]); i++) {
+        hostPwmGen_t before = hostPwmActive(MAIN_BASE, MAIN_GEN);
+        CHECK(setPWMFrequency(MAIN, frequencies[i]));
+        CHECK(getPWMFrequency(MAIN) == frequencies[i]);
+
+        hostPwmGen_t staged = hostPwmActive(MAIN_BASE, MAIN_GEN);
+        CHECK((staged.load == before.load) && (staged.compare == before.compare));
+        boundary();
+        hostPwmGen_t after = hostPwmActive(MAIN_BASE, MAIN_GEN);
+        CHECK(after.load == SYS_CLOCK_HZ / frequencies[i] / 2);
+        CHECK_NEAR(activeDuty(MAIN_BASE, MAIN_GEN), duty, 100.0 / after.load);
+    }
+    CHECK(hostIntMaskCount == 0); // the tasks that write the PWM never preempt each other
+}
+
+/** Frequencies whose period does not fit the generator, or that are above PWM_MAX_HZ,
+    are refused and leave the rotor unchanged.  */
+static void testFrequencyRange(void)
+{
+    const uint32_t invalid[] = {0, 152, 10001};
+
+    CHECK(setPWMFrequency(TAIL, 500));
+    pwmCommit();
+    boundary();
+    hostPwmGen_t before = hostPwmActive(TAIL_BASE, TAIL_GEN);
+
+    for (unsigned i = 0; i < sizeof(invalid) / sizeof(invalid[0]); i++) {
+        CHECK(!setPWMFrequency(TAIL, invalid[i]));
+        CHECK(getPWMFrequency(TAIL) == 500);
+        boundary();
+        hostPwmGen_t after = hostPwmActive(TAIL_BASE, TAIL_GEN);
+        CHECK((after.load == before.load) && (after.compare == before.compare));
+    }
+}
+
+int main(void)
+{
+    hostClockHz = SYS_CLOCK_HZ;
+    initPWMClock();
+    initialisePWM();
+    initialisePWMTail();
+    boundary();
+    CHECK(hostPwmActive(MAIN_BASE, MAIN_GEN).enabled);
+    CHECK(hostPwmActive(TAIL_BASE, TAIL_GEN).enabled);
+    CHECK(getPWMFrequency(MAIN) == getPWMFrequency(TAIL));
+
+    testDuty();
+    testBench();
+    testFrequency();
+    testFrequencyRange();
+    return testReport("test_pwm");
+}
@@ -0,0 +1,213 @@
+/** @file   test_sched.c
+    @author Bailey Lissington, Dillon Pike, Joseph Ramirez
+    @date   21 May 2021
+    @brief  Host tests of the scheduler on a fake clock: priority order, releases on an
+            absolute grid, overrun statistics, the single catch-up run and the releases
+            it skips, and times that wrap around at 2^32.
+*/
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "sched.h"
+#include "test.h"
+
+#define MAX_RUNS 64
+
+static uint32_t now; // fake clock, advanced by the tasks and the tests
+static uint32_t execTicks[4]; // time each task takes to run
+static char order[MAX_RUNS + 1]; // task letters in the order they ran
+static uint8_t orderLength;
+static uint32_t starts[MAX_RUNS]; // start times of task A
+static uint8_t startCount;
+
+static uint32_t fakeTime(void)
+{
+    return now;
+}
+
+/** Records a run of a task and advances the clock by its execution time.  */
+static void runTask(uint8_t task)
+{
+    if (orderLength < MAX_RUNS) {
+        order[orderLength++] = 'A' + task;
+        order[orderLength] = '\0';
+    }
+    if ((task == 0) && (startCount < MAX_RUNS)) {
+        starts[startCount++] = now;
+    }
+    now += execTicks[task];
+}
+
+static void taskA(void) { runTask(0); }
+static void taskB(void) { runTask(1); }
+static void taskC(void) { runTask(2); }
+static void taskD(void) { runTask(3); }
+
+/** Starts a new schedule at a time, with tasks that take no time to run.  */
+static void reset(uint32_t time)
+{
+    now = time;
+    orderLength = startCount = 0;
+    order[0] = '\0';
+    for (int i = 0; i < 4; i++) {
+        execTicks[i] = 0;
+    }
+    schedInit(fakeTime);
+}
+
+/** Runs every task that is due now.  */
+static void runDue(void)
+{
+    while (schedRunNext()) {
+    }
+}
+
+/** Tasks due together run highest priority first, and in the order added within a priority.  */
+static void testPriorityOrder(void)
+{
+    reset(0);
+    CHECK(schedAddTask("C", taskC, 100, 2));
+    CHECK(schedAddTask("A", taskA, 100, 0));
+    CHECK(schedAddTask("D", taskD, 100, 2));
+    CHECK(schedAddTask("B", taskB, 100, 1));
+    runDue();
+    CHECK(strcmp(order, "ABCD") == 0);
+    CHECK(schedGetTask(0)->priority == 0);
+    CHECK(schedGetTask(3)->run == taskD);
+
+    // Only the highest priority due task runs on each call
+    now = 100;
+    CHECK(schedRunNext());
+    CHECK(strcmp(order, "ABCDA") == 0);
+}
+
+/** Starting late does not move later releases off the period grid.  */
+static void testNoDrift(void)
+{
+    reset(0);
+    execTicks[0] = 10;
+    schedAddTask("A", taskA, 100, 0);
+
+    for (uint32_t k = 0; k < 50; k++) {
+        now = k * 100 + (k * 37) % 60; // started up to 59 ticks late
+        CHECK(schedRunNext());
+        CHECK(schedGetTask(0)->nextRelease == (k + 1) * 100);
+        CHECK(!schedRunNext()); // nothing due until the next grid point
+    }
+    CHECK(schedGetTask(0)->runs == 50);
+    CHECK(schedGetTask(0)->maxLateness == 59);
+    CHECK(schedGetTask(0)->overruns == 0);
+    CHECK(schedGetTask(0)->minExec == 10);
+}
+
+/** A run that ends past its deadline counts as an overrun by the time it is late.  */
+static void testOverrun(void)
+{
+    reset(0);
+    execTicks[0] = 150;
+    schedAddTask("A", taskA, 100, 0);
+    CHECK(schedRunNext()); // 0 to 150, deadline 100
+    execTicks[0] = 10;
+    CHECK(schedRunNext()); // catch-up at 150, to 160, deadline 200
+
+    const schedTask_t* task = schedGetTask(0);
+    CHECK(task->overruns == 1);
+    CHECK(task->maxOverrun == 50);
+    CHECK(task->totalOverrun == 50);
+    CHECK(task->skipped == 0);
+    CHECK(task->maxExec == 150);
+    CHECK(task->nextRelease == 200);
+}
+
+/** A run that ends 250 ticks past its deadline runs once more straight away and skips
+    the two releases it missed beyond that, then returns to the grid.  */
+static void testCatchUp(void)
+{
+    reset(0);
+    execTicks[0] = 350;
+    schedAddTask("A", taskA, 100, 0);
+    CHECK(schedRunNext()); // 0 to 350, deadline 100
+
+    const schedTask_t* task = schedGetTask(0);
+    CHECK(task->overruns == 1);
+    CHECK(task->maxOverrun == 250);
+    CHECK(task->skipped == 2); // 100 and 200 are dropped, 300 is the catch-up
+    CHECK(task->nextRelease == 300);
+
+    execTicks[0] = 10;
+    CHECK(schedRunNext()); // catch-up at 350
+    CHECK(starts[1] == 350);
+    CHECK(!schedRunNext());
+    CHECK(task->nextRelease == 400);
+    CHECK(schedElapsed() == 350);
+
+    now = 400;
+    CHECK(schedRunNext());
+    CHECK(task->skipped == 2);
+    CHECK(task->runs == 3);
+}
+
+/** Releases, lateness and the earliest release are measured correctly across the wrap of
+    the 32 bit clock.  */
+static void testWrap(void)
+{
+    const uint32_t start = UINT32_MAX - 250;
+
+    reset(start);
+    execTicks[0] = 5;
+    schedAddTask("A", taskA, 100, 0);
+    schedAddTask("B", taskB, 300, 1);
+
+    // Steps the clock a tick at a time through the wrap
+    for (uint32_t t = 0; t < 1000; t++) {
+        runDue();
+        now = start + t + 1;
+    }
+    CHECK(startCount == 10);
+    for (uint8_t i = 1; i < startCount; i++) {
+        CHECK(starts[i] - starts[i - 1] == 100);
+    }
+    CHECK(schedGetTask(0)->maxLateness == 0);
+    CHECK(schedGetTask(0)->overruns == 0);
+    CHECK(schedGetTask(1)->runs == 4);
+
+    // Task B's release is before the wrap and task A's after it
+    reset(UINT32_MAX - 50);
+    schedAddTask("A", taskA, 100, 0);
+    schedAddTask("B", taskB, 30, 1);
+    runDue();
+    CHECK(schedNextRelease() == UINT32_MAX - 20);
+    now = UINT32_MAX - 20;
+    runDue();
+    CHECK(schedNextRelease() == 9); // B again, just after the wrap
+    CHECK(strcmp(order, "ABB") == 0);
+}
+
+/** schedElapsed gives the period on the first run and the real interval after that.  */
+static void testElapsed(void)
+{
+    reset(1000);
+    schedAddTask("A", taskA, 100, 0);
+    CHECK(schedRunNext());
+    CHECK(schedElapsed() == 100);
+    now = 1130; // 30 late
+    CHECK(schedRunNext());
+    CHECK(schedElapsed() == 130);
+    now = 1200;
+    CHECK(schedRunNext());
+    CHECK(schedElapsed() == 70);
+}
+
+int main(void)
+{
+    testPriorityOrder();
+    testNoDrift();
+    testOverrun();
+    testCatchUp();
+    testWrap();
+    testElapsed();
+    return testReport("test_sched");
+}
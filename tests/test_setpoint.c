@@ -0,0 +1,137 @@
+/** @file   test_setpoint.c
+    @author Bailey Lissington, Dillon Pike, Joseph Ramirez
+    @date   21 May 2021
+    @brief  Host tests of the setpoints as main.c sets them up: the altitude limited
+            between its min and max, the yaw wrapping around a full rotation in
+            coarse and fine steps, and the two presses of a double press.
+*/
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "setpoint.h"
+#include "pi.h"
+#include "test.h"
+
+static setpoint_t alt, yaw;
+
+/** Sets up both setpoints at 0, as main does.  */
+static void reset(void)
+{
+    setpointInit(&alt, 0, ALT_SETPOINT_MIN, ALT_SETPOINT_MAX, ALT_SETPOINT_COARSE_STEP, ALT_SETPOINT_FINE_STEP,
+                 ALT_SETPOINT_DOUBLE_STEP, 0);
+    setpointInit(&yaw, 0, 0, 0, YAW_SETPOINT_COARSE_STEP, YAW_SETPOINT_FINE_STEP,
+                 YAW_SETPOINT_DOUBLE_STEP, FULL_ROTATION_DEG);
+}
+
+/** The altitude steps coarsely and finely, and stops at its min and max.  */
+static void testAltitudeLimits(void)
+{
+    reset();
+    setpointStep(&alt, -1, SETPOINT_FINE);
+    CHECK(setpointGet(&alt) == ALT_SETPOINT_MIN);
+
+    for (int i = 0; i < 9; i++) {
+        setpointStep(&alt, 1, SETPOINT_COARSE);
+    }
+    setpointStep(&alt, 1, SETPOINT_FINE);
+    CHECK(setpointGet(&alt) == 92);
+    setpointStep(&alt, 1, SETPOINT_COARSE);
+    CHECK(setpointGet(&alt) == ALT_SETPOINT_MAX);
+    setpointStep(&alt, 1, SETPOINT_FINE);
+    CHECK(setpointGet(&alt) == ALT_SETPOINT_MAX);
+
+    setpointSet(&alt, 150);
+    CHECK(setpointGet(&alt) == ALT_SETPOINT_MAX);
+    setpointSet(&alt, -5);
+    CHECK(setpointGet(&alt) == ALT_SETPOINT_MIN);
+}
+
+/** The yaw stays in [-180, 180) and wraps at both ends, in coarse and fine steps.  */
+static void testYawWrap(void)
+{
+    const int16_t half = FULL_ROTATION_DEG / 2;
+
+    reset();
+    setpointSet(&yaw, half - YAW_SETPOINT_COARSE_STEP);
+    setpointStep(&yaw, 1, SETPOINT_COARSE);
+    CHECK(setpointGet(&yaw) == -half);
+    setpointStep(&yaw, -1, SETPOINT_COARSE);
+    CHECK(setpointGet(&yaw) == half - YAW_SETPOINT_COARSE_STEP);
+
+    setpointSet(&yaw, half - 1);
+    setpointStep(&yaw, 1, SETPOINT_FINE);
+    CHECK(setpointGet(&yaw) == -half + YAW_SETPOINT_FINE_STEP - 1);
+    setpointStep(&yaw, -1, SETPOINT_FINE);
+    CHECK(setpointGet(&yaw) == half - 1);
+
+    setpointSet(&yaw, half);
+    CHECK(setpointGet(&yaw) == -half);
+    setpointSet(&yaw, -half - 1);
+    CHECK(setpointGet(&yaw) == half - 1);
+    setpointSet(&yaw, -half);
+    CHECK(setpointGet(&yaw) == -half);
+}
+
+/** A full rotation of steps either way comes back to where it started, in range throughout.  */
+static void testFullRotation(void)
+{
+    const setpointMode_t modes[] = {SETPOINT_COARSE, SETPOINT_FINE};
+    const int16_t steps[] = {YAW_SETPOINT_COARSE_STEP, YAW_SETPOINT_FINE_STEP};
+    const int16_t starts[] = {0, 7, -180, 179};
+    uint32_t outOfRange = 0;
+
+    reset();
+    for (unsigned m = 0; m < 2; m++) {
+        for (unsigned s = 0; s < sizeof(starts) / sizeof(starts[0]); s++) {
+            for (int8_t direction = -1; direction <= 1; direction += 2) {
+                setpointSet(&yaw, starts[s]);
+                for (int i = 0; i < FULL_ROTATION_DEG / steps[m]; i++) {
+                    setpointStep(&yaw, direction, modes[m]);
+                    outOfRange += (setpointGet(&yaw) < -FULL_ROTATION_DEG / 2)
+                                  || (setpointGet(&yaw) >= FULL_ROTATION_DEG / 2);
+                }
+                CHECK(setpointGet(&yaw) == starts[s]);
+            }
+        }
+    }
+    CHECK(outOfRange == 0);
+}
+
+/** A double press, a coarse step then the double press step as applyGesture gives them,
+    steps the altitude by 50% up to its max and the yaw by a quarter turn, wrapping.  */
+static void testDoublePress(void)
+{
+    reset();
+    setpointStep(&alt, 1, SETPOINT_COARSE);
+    setpointStep(&alt, 1, SETPOINT_DOUBLE);
+    CHECK(setpointGet(&alt) == 50);
+    setpointStep(&alt, -1, SETPOINT_COARSE);
+    setpointStep(&alt, -1, SETPOINT_DOUBLE);
+    CHECK(setpointGet(&alt) == 0);
+
+    setpointSet(&alt, 80);
+    setpointStep(&alt, 1, SETPOINT_COARSE);
+    setpointStep(&alt, 1, SETPOINT_DOUBLE);
+    CHECK(setpointGet(&alt) == ALT_SETPOINT_MAX);
+
+    setpointStep(&yaw, 1, SETPOINT_COARSE);
+    setpointStep(&yaw, 1, SETPOINT_DOUBLE);
+    CHECK(setpointGet(&yaw) == 90);
+    setpointStep(&yaw, 1, SETPOINT_COARSE);
+    setpointStep(&yaw, 1, SETPOINT_DOUBLE);
+    CHECK(setpointGet(&yaw) == -FULL_ROTATION_DEG / 2);
+    setpointStep(&yaw, -1, SETPOINT_COARSE);
+    setpointStep(&yaw, -1, SETPOINT_DOUBLE);
+    CHECK(setpointGet(&yaw) == 90);
+}
+
+int main(void)
+{
+    testAltitudeLimits();
+    testYawWrap();
+    testFullRotation();
+    testDoublePress();
+    return testReport("test_setpoint");
+}
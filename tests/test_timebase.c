@@ -0,0 +1,148 @@
+/** @file   test_timebase.c
+    @author Bailey Lissington, Dillon Pike, Joseph Ramirez
+    @date   21 May 2021
+    @brief  Host tests of the timebase: timebaseExtend over every combination of a
+            pending overflow and a count either side of UINT32_MAX / 2, reads of a
+            modelled WTIMER0A that stay monotonic across a forced wrap for any
+            overflow interrupt latency, and the simulated host timebase.
+*/
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "clock.h"
+#include "timebase.h"
+#include "test.h"
+
+#define WRAP ((uint64_t)1 << 32) // hardware count period
+#define WINDOW 20000 // ticks read either side of a forced wrap
+
+// Overflow count, hardware count and pending flag, and the time they give
+typedef struct {
+    uint32_t high;
+    uint32_t count;
+    bool pending;
+    uint64_t expected;
+} extendCase_t;
+
+/** A pending overflow is counted only when the count is in the lower half, meaning it
+    was read after the wrap. In the upper half it was read just before the wrap.  */
+static void testExtend(void)
+{
+    const uint32_t half = UINT32_MAX / 2;
+    const extendCase_t cases[] = {
+        // No overflow pending: the count is used as read, wherever it is
+        {0, 0, false, 0},
+        {0, 5, false, 5},
+        {0, half - 1, false, half - 1},
+        {0, half, false, half},
+        {0, UINT32_MAX, false, UINT32_MAX},
+        {3, half - 1, false, 3 * WRAP + half - 1},
+        {3, half + 1, false, 3 * WRAP + half + 1},
+
+        // Overflow pending, count read after the wrap: the overflow is counted here
+        {0, 0, true, WRAP},
+        {0, 5, true, WRAP + 5},
+        {0, half - 1, true, WRAP + half - 1},
+        {7, 0, true, 8 * WRAP},
+        {UINT32_MAX - 1, 10, true, (uint64_t)UINT32_MAX * WRAP + 10},
+
+        // Overflow pending, count read before the wrap: not counted yet
+        {0, half, true, half},
+        {0, half + 1, true, half + 1},
+        {0, UINT32_MAX, true, UINT32_MAX},
+        {7, UINT32_MAX - 3, true, 7 * WRAP + UINT32_MAX - 3},
+    };
+
+    for (unsigned i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        const extendCase_t* c = &cases[i];
+        uint64_t time = timebaseExtend(c->high, c->count, c->pending);
+        if (time != c->expected) {
+            printf("timebaseExtend(%lu, 0x%08lx, %d) = 0x%016llx, expected 0x%016llx\n",
+                   (unsigned long)c->high, (unsigned long)c->count, c->pending,
+                   (unsigned long long)time, (unsigned long long)c->expected);
+        }
+        CHECK(time == c->expected);
+    }
+}
+
+/** Reads the modelled WTIMER0A as timebaseGetTicks does, with interrupts masked from
+    reading the overflow count until reading the pending flag a tick after the count.
+    @param time the read starts at, in ticks.
+    @param ticks from a wrap until its overflow interrupt is counted.
+    @return time the read gives.  */
+static uint64_t modelRead(uint64_t time, uint32_t latency)
+{
+    uint32_t counted = (time >= latency) ? (uint32_t)((time - latency) / WRAP) : 0;
+    uint32_t count = (uint32_t)(time + 1);
+    uint32_t wrapped = (uint32_t)((time + 2) / WRAP); // wraps by the pending flag's read
+
+    return timebaseExtend(counted, count, wrapped > counted);
+}
+
+/** Every read around a wrap gives the time the count was read, so reads never go
+    backwards, however late the overflow interrupt is counted.  */
+static void testForcedWrap(void)
+{
+    const uint32_t latencies[] = {0, 1, 2, 3, 100, 10000, UINT32_MAX / 4};
+    const uint64_t wraps[] = {WRAP, 5 * WRAP};
+
+    for (unsigned w = 0; w < sizeof(wraps) / sizeof(wraps[0]); w++) {
+        for (unsigned l = 0; l < sizeof(latencies) / sizeof(latencies[0]); l++) {
+            uint64_t previous = 0;
+            uint32_t wrong = 0, backwards = 0;
+
+            for (uint64_t time = wraps[w] - WINDOW; time < wraps[w] + WINDOW; time++) {
+                uint64_t read = modelRead(time, latencies[l]);
+                wrong += (read != time + 1);
+                backwards += (read < previous);
+                previous = read;
+            }
+            // And once the late interrupt is finally counted
+            uint64_t late = wraps[w] + latencies[l];
+            for (uint64_t time = late - 2; time < late + 2; time++) {
+                uint64_t read = modelRead(time, latencies[l]);
+                wrong += (read != time + 1);
+            }
+            if (wrong || backwards) {
+                printf("wrap at 0x%llx, latency %lu: %lu wrong reads, %lu backwards\n",
+                       (unsigned long long)wraps[w], (unsigned long)latencies[l],
+                       (unsigned long)wrong, (unsigned long)backwards);
+            }
+            CHECK(wrong == 0);
+            CHECK(backwards == 0);
+        }
+    }
+}
+
+/** The simulated host timebase counts at the target's clock rate and never goes backwards.  */
+static void testHost(void)
+{
+    uint64_t previous = 0;
+    uint32_t backwards = 0;
+
+    initTimebase();
+    CHECK(timebaseGetTickRate() == SYS_CLOCK_HZ);
+    for (int i = 0; i < 100000; i++) {
+        uint64_t ticks = timebaseGetTicks();
+        backwards += (ticks < previous);
+        previous = ticks;
+    }
+    CHECK(backwards == 0);
+    CHECK(timebaseGetUs() >= previous / (SYS_CLOCK_HZ / TIMEBASE_US_PER_S));
+
+    uint32_t now = timebaseGetCount();
+    timebaseSetMatch(now - 1);
+    CHECK(timebaseMatched());
+    timebaseSetMatch(now + SYS_CLOCK_HZ);
+    CHECK(!timebaseMatched());
+}
+
+int main(void)
+{
+    testExtend();
+    testForcedWrap();
+    testHost();
+    return testReport("test_timebase");
+}
@@ -0,0 +1,210 @@
+/** @file   test_traj.c
+    @author Bailey Lissington, Dillon Pike, Joseph Ramirez
+    @date   21 May 2021
+    @brief  Host tests of the setpoint trajectories: rate and acceleration limits,
+            settling on the target, wrapping, and a closed-loop benchmark of time to
+            target, overshoot and integrated error against a raw step.
+*/
+
+#include <stdio.h>
+#include <stdbool.h>
+
+#include "traj.h"
+#include "pi.h"
+#include "test.h"
+#include "model.h"
+
+#define CONTROL_STEP_S 0.02 // control task period the trajectories are updated at
+#define RATE_STEP_S 0.01 // rate loop period
+#define ARRIVE_BAND 1.0 // altitude error counted as arrived, in %
+#define LIMIT_TOL 1e-9
+
+/** Shortest time a move can take at the given limits, starting and ending at rest.  */
+static double minimumMoveTime(double distance, double maxRate, double maxAccel)
+{
+    distance = fabs(distance);
+    if (distance >= maxRate * maxRate / maxAccel) {
+        return distance / maxRate + maxRate / maxAccel;
+    }
+    return 2 * sqrt(distance / maxAccel);
+}
+
+/** Runs a trajectory to a target, checking the limits hold and, if it starts at
+    rest, that it moves the given distance without passing the target.
+    @return time taken to settle on the target in s.  */
+static double runToTarget(trajectory_t* traj, double target, double distance)
+{
+    bool fromRest = (traj->velocity == 0);
+    double velocity = traj->velocity;
+    double travelled = 0;
+    double t = 0;
+
+    while ((t < 60.0) && ((traj->position != target) || (traj->velocity != 0))) {
+        double previous = traj->position;
+        trajUpdate(traj, target, CONTROL_STEP_S);
+        t += CONTROL_STEP_S;
+
+        double moved = traj->position - previous;
+        if (traj->wrapRange > 0) {
+            moved = (moved > traj->wrapRange / 2) ? moved - traj->wrapRange
+                  : (moved < -traj->wrapRange / 2) ? moved + traj->wrapRange : moved;
+        }
+        travelled += moved;
+
+        CHECK(fabs(traj->velocity) <= traj->maxRate + LIMIT_TOL);
+        CHECK(traj->velocity >= -traj->maxNegativeRate - LIMIT_TOL);
+        CHECK(fabs(traj->velocity - velocity) <= traj->maxAccel * CONTROL_STEP_S + LIMIT_TOL);
+        CHECK(fabs(traj->acceleration * CONTROL_STEP_S - (traj->velocity - velocity)) < LIMIT_TOL);
+        CHECK(!fromRest || (fabs(travelled) <= fabs(distance) + LIMIT_TOL)); // never overshoots
+        velocity = traj->velocity;
+    }
+    CHECK(traj->position == target);
+    CHECK(traj->velocity == 0);
+    CHECK(!fromRest || (fabs(travelled - distance) < 1e-6));
+    return t;
+}
+
+/** Moves of every size stay within the limits and settle close to the fastest possible time.  */
+static void testLimitsAndSettling(void)
+{
+    const double moves[] = {0.5, 2.0, 10.0, 30.0, 100.0, -10.0, -70.0};
+    trajectory_t traj;
+
+    for (unsigned i = 0; i < sizeof(moves) / sizeof(moves[0]); i++) {
+        trajInit(&traj, 0, ALT_TRAJ_MAX_RATE, ALT_TRAJ_MAX_ACCEL, 0);
+        double t = runToTarget(&traj, moves[i], moves[i]);
+        double fastest = minimumMoveTime(moves[i], ALT_TRAJ_MAX_RATE, ALT_TRAJ_MAX_ACCEL);
+        CHECK(t >= fastest - CONTROL_STEP_S);
+        CHECK(t <= fastest + 3 * CONTROL_STEP_S);
+    }
+}
+
+/** Negative moves are held to the lower negative rate, and positive moves are not.  */
+static void testNegativeRate(void)
+{
+    const double moves[] = {-40.0, 40.0, -3.0};
+    trajectory_t traj;
+
+    for (unsigned i = 0; i < sizeof(moves) / sizeof(moves[0]); i++) {
+        trajInit(&traj, 50.0, ALT_TRAJ_MAX_RATE, ALT_TRAJ_MAX_ACCEL, 0);
+        trajSetNegativeRate(&traj, ALT_MAX_DESCENT_RATE);
+        double t = runToTarget(&traj, 50.0 + moves[i], moves[i]);
+        double rate = (moves[i] < 0) ? ALT_MAX_DESCENT_RATE : ALT_TRAJ_MAX_RATE;
+        CHECK(t <= minimumMoveTime(moves[i], rate, ALT_TRAJ_MAX_ACCEL) + 3 * CONTROL_STEP_S);
+    }
+    trajSetNegativeRate(&traj, 2 * ALT_TRAJ_MAX_RATE);
+    CHECK(traj.maxNegativeRate == ALT_TRAJ_MAX_RATE);
+}
+
+/** A target that changes mid-move, including reversing, is still reached within the limits.  */
+static void testRetarget(void)
+{
+    trajectory_t traj;
+    trajInit(&traj, 0, ALT_TRAJ_MAX_RATE, ALT_TRAJ_MAX_ACCEL, 0);
+
+    for (int i = 0; i < 40; i++) {
+        trajUpdate(&traj, 60.0, CONTROL_STEP_S); // moving up at full rate
+    }
+    CHECK(traj.velocity > 0);
+    runToTarget(&traj, 10.0, 0);
+}
+
+/** Yaw moves the short way across the wrap, and its position stays in range.  */
+static void testWrap(void)
+{
+    trajectory_t traj;
+    trajInit(&traj, 170.0, YAW_TRAJ_MAX_RATE, YAW_TRAJ_MAX_ACCEL, FULL_ROTATION_DEG);
+    runToTarget(&traj, -170.0, 20.0);
+
+    trajInit(&traj, -135.0, YAW_TRAJ_MAX_RATE, YAW_TRAJ_MAX_ACCEL, FULL_ROTATION_DEG);
+    while ((traj.position != 135.0) || (traj.velocity != 0)) {
+        trajUpdate(&traj, 135.0, CONTROL_STEP_S);
+        CHECK((traj.position >= -180.0) && (traj.position < 180.0));
+        CHECK(traj.velocity <= 0); // -90 degrees is shorter than +270
+    }
+}
+
+/** Flies the cascaded altitude controller between two altitudes, as main.c does, with
+    the reference either stepping straight to the target or following the trajectory
+    and fed forward into the rate loop.
+    @param true to follow the trajectory.
+    @param starting altitude in %.
+    @param target altitude in %.
+    @param integrated absolute error from the target in %.s.
+    @param largest altitude past the target in %.
+    @return time until the altitude stays within ARRIVE_BAND of the target, in s.  */
+static double flyAltitude(bool trajectory, double start, double target, double* iae, double* overshoot)
+{
+    trajectory_t traj;
+    model_t heli = {start, 0, 0, 0};
+    double direction = (target > start) ? 1 : -1;
+    double reference = start, setRate = 0, feedforward = 0, mainDuty, tailDuty;
+    double arrived = -1;
+    *iae = 0;
+    *overshoot = 0;
+
+    trajInit(&traj, start, ALT_TRAJ_MAX_RATE, ALT_TRAJ_MAX_ACCEL, 0);
+    trajSetNegativeRate(&traj, ALT_MAX_DESCENT_RATE);
+    resetErrorIntegrals();
+    mainRatePiTransfer(0, 0, MODEL_MAIN_HOVER);
+    modelShapeInit((uint32_t)(1 / RATE_STEP_S), MODEL_MAIN_HOVER, MODEL_TAIL_HOVER);
+
+    for (int i = 0; i < (int)(20.0 / RATE_STEP_S); i++) {
+        double t = i * RATE_STEP_S;
+        if ((i % (int)(CONTROL_STEP_S / RATE_STEP_S)) == 0) {
+            if (trajectory) {
+                reference = trajUpdate(&traj, target, CONTROL_STEP_S);
+                feedforward = mainRateFeedforward(traj.velocity, traj.acceleration);
+            } else {
+                reference = target;
+            }
+            setRate = mainAltitudeCompute(reference, heli.altitude, trajectory ? traj.velocity : 0);
+        }
+        modelShape(mainRatePiCompute(setRate, heli.climbRate, feedforward, RATE_STEP_S), MODEL_TAIL_HOVER,
+                   &mainDuty, &tailDuty);
+        modelStep(&heli, mainDuty, tailDuty, 0, RATE_STEP_S);
+
+        *iae += fabs(target - heli.altitude) * RATE_STEP_S;
+        *overshoot = fmax(*overshoot, (heli.altitude - target) * direction);
+        if (fabs(heli.altitude - target) > ARRIVE_BAND) {
+            arrived = -1;
+        } else if (arrived < 0) {
+            arrived = t;
+        }
+    }
+    return arrived;
+}
+
+/** Benchmark of time to target, overshoot and integrated error against a raw step, on
+    the identified model. Fed forward, the rate loop keeps the heli on the trajectory, so
+    it arrives sooner and without the overshoot the step's lagging cascade gives.  */
+static void testClosedLoop(void)
+{
+    const double starts[] = {0, 0, 0, 50.0, 30.0};
+    const double targets[] = {10.0, 30.0, 50.0, 10.0, 0};
+
+    for (unsigned i = 0; i < sizeof(targets) / sizeof(targets[0]); i++) {
+        double stepIae, stepOvershoot, trajIae, trajOvershoot;
+        double step = flyAltitude(false, starts[i], targets[i], &stepIae, &stepOvershoot);
+        double smooth = flyAltitude(true, starts[i], targets[i], &trajIae, &trajOvershoot);
+        printf("altitude %.0f to %.0f%%: step arrives in %.2f s, overshoot %.2f%%, error %.1f %%.s; "
+               "trajectory arrives in %.2f s, overshoot %.2f%%, error %.1f %%.s\n",
+               starts[i], targets[i], step, stepOvershoot, stepIae, smooth, trajOvershoot, trajIae);
+        CHECK(step > 0);
+        CHECK(smooth > 0);
+        CHECK(smooth < step);
+        CHECK(trajOvershoot < stepOvershoot);
+        CHECK(trajOvershoot < ARRIVE_BAND);
+        CHECK(trajIae < stepIae);
+    }
+}
+
+int main(void)
+{
+    testLimitsAndSettling();
+    testNegativeRate();
+    testRetarget();
+    testWrap();
+    testClosedLoop();
+    return testReport("test_traj");
+}
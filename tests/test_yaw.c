@@ -0,0 +1,203 @@
+/** @file   test_yaw.c
+    @author Bailey Lissington, Dillon Pike, Joseph Ramirez
+    @date   21 May 2021
+    @brief  Host tests of the yaw rate estimate in yaw.c, fed quadrature edges through
+            the GPIO stand-ins on a fake timebase: resolution at low rates against
+            counting edges per call, direction, the clamp while no edge arrives, and
+            the timeout to zero.
+*/
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <math.h>
+
+#include "tivaware.h"
+#include "timebase.h"
+#include "yaw.h"
+#include "test.h"
+
+#define TICK_RATE 20000000 // fake timebase rate, the target's system clock
+#define RATE_LOOP_S 0.01 // period getYawRate is called at by the rate task
+#define DEGREES_PER_EDGE (360.0 / (112 * 4)) // DISC_SLOTS and EDGES_PER_SLOT in yaw.c
+#define TIMEOUT_S 0.5 // YAW_RATE_TIMEOUT_S in yaw.c
+
+static uint32_t now; // fake timebase count
+static double simTime; // simulated time in s
+static double position; // encoder position in edges, from the start
+static long level; // whole edges given to the encoder pins, the floor of position
+static uint32_t lastEdge; // fake timebase count at the latest edge
+static uint8_t phase; // quadrature phase of the pins, 0 to 3
+
+uint32_t timebaseGetCount(void)
+{
+    return now;
+}
+
+uint32_t timebaseGetTickRate(void)
+{
+    return TICK_RATE;
+}
+
+/** Moves the encoder one edge. Channels A and B follow the Gray code 00, 01, 11, 10,
+    which yaw.c counts up going forwards.
+    @param 1 or -1.  */
+static void edge(int direction)
+{
+    const uint8_t gray[4] = {0, GPIO_PIN_1, GPIO_PIN_0 | GPIO_PIN_1, GPIO_PIN_0};
+    uint8_t previous = gray[phase];
+
+    phase = (phase + direction) & 3;
+    uint8_t changed = previous ^ gray[phase];
+    hostGpioSet(GPIO_PORTB_BASE, changed, (gray[phase] & changed) != 0); // runs YawIntHandler
+    level += direction;
+    lastEdge = now;
+}
+
+/** Turns the encoder at a constant rate for a while, giving each edge at its time, and
+    calls getYawRate every rate loop period.
+    @param yaw rate in degrees per s.
+    @param time to turn for in s.
+    @param called with the true rate and each estimate, or NULL.  */
+static void turn(double rate, double duration, void (*record)(double rate, double estimate))
+{
+    double edgesPerS = rate / DEGREES_PER_EDGE;
+
+    for (double end = simTime + duration - 1e-9; simTime < end; simTime += RATE_LOOP_S) {
+        double start = position;
+        double target = position + edgesPerS * RATE_LOOP_S;
+
+        // Gives every edge crossed during the period at the time it is crossed, at the
+        // next whole position going up or the current one going down
+        while (level + 1 <= target) {
+            now = (uint32_t)llround((simTime + (level + 1 - start) / edgesPerS) * TICK_RATE);
+            edge(1);
+        }
+        while (level > target) {
+            now = (uint32_t)llround((simTime + (level - start) / edgesPerS) * TICK_RATE);
+            edge(-1);
+        }
+        position = target;
+        now = (uint32_t)llround((simTime + RATE_LOOP_S) * TICK_RATE);
+        double estimate = getYawRate();
+        if (record) {
+            record(rate, estimate);
+        }
+    }
+}
+
+// Largest estimate error once moving, and estimates of zero while moving
+static double worstError;
+static uint32_t zeroWhileMoving;
+
+static void recordError(double rate, double estimate)
+{
+    worstError = fmax(worstError, fabs(estimate - rate) / fabs(rate));
+    zeroWhileMoving += (estimate == 0);
+}
+
+// Estimates after the encoder stops: over one edge since the latest, of the wrong sign,
+// and the time since the latest edge the first zero came at
+static uint32_t overBound, wrongSign;
+static double stopDirection, zeroAfter;
+
+static void recordStopped(double rate, double estimate)
+{
+    double sinceEdge = (double)(uint32_t)(now - lastEdge) / TICK_RATE;
+    (void)rate;
+    overBound += (fabs(estimate) > DEGREES_PER_EDGE / sinceEdge + 1e-9);
+    wrongSign += (estimate * stopDirection < 0);
+    if ((estimate == 0) && (zeroAfter < 0)) {
+        zeroAfter = sinceEdge;
+    }
+}
+
+/** Starts the encoder at rest at 0, timed out as after start up.  */
+static void reset(void)
+{
+    hostGpioSet(GPIO_PORTB_BASE, GPIO_PIN_0 | GPIO_PIN_1, false);
+    phase = 0;
+    initYawInt();
+    initYawStates();
+    simTime = 1.0; // past the timeout since the encoder last moved
+    now = TICK_RATE;
+    position = 0;
+    level = 0;
+    initYawRate();
+    turn(0, 1.0, NULL);
+}
+
+/** At low rates, where an edge arrives only every few calls, each estimate is within a
+    few percent of the true rate and never drops to zero between edges, where counting
+    the edges each call gives either zero or a whole edge per period.  */
+static void testLowRate(void)
+{
+    const double rates[] = {2.0, 5.0, 20.0, 150.0};
+
+    for (unsigned i = 0; i < sizeof(rates) / sizeof(rates[0]); i++) {
+        reset();
+        turn(rates[i], 1.0, NULL); // past the first edges, which restart the estimate
+        worstError = 0;
+        zeroWhileMoving = 0;
+        turn(rates[i], 3.0, recordError);
+        printf("%.0f degrees/s: estimate within %.2f%%, counting edges per call gives %.0f or %.0f degrees/s\n",
+               rates[i], 100 * worstError, floor(rates[i] * RATE_LOOP_S / DEGREES_PER_EDGE) * DEGREES_PER_EDGE / RATE_LOOP_S,
+               ceil(rates[i] * RATE_LOOP_S / DEGREES_PER_EDGE) * DEGREES_PER_EDGE / RATE_LOOP_S);
+        CHECK(worstError < 0.02);
+        CHECK(zeroWhileMoving == 0);
+    }
+}
+
+/** Turning either way gives the sign yawCounter moves in, as getYawDegrees shows.  */
+static void testDirection(void)
+{
+    reset();
+    turn(30.0, 1.0, NULL);
+    CHECK_NEAR(getYawRate(), 30.0, 0.5);
+    CHECK(getYawDegrees() > 0);
+
+    turn(-30.0, 2.0, NULL);
+    CHECK_NEAR(getYawRate(), -30.0, 0.5);
+    CHECK(getYawDegrees() < 0);
+    CHECK(level < 0);
+}
+
+/** Once the edges stop, the estimate can be no more than one edge over the time since
+    the latest edge, and is zero once TIMEOUT_S has passed without one. The next edges
+    restart it without using the time it was stopped for.  */
+static void testStopAndTimeout(void)
+{
+    const double directions[] = {1, -1};
+
+    for (unsigned i = 0; i < 2; i++) {
+        reset();
+        turn(directions[i] * 100.0, 1.0, NULL);
+        overBound = wrongSign = 0;
+        stopDirection = directions[i];
+        zeroAfter = -1;
+        turn(0, 2 * TIMEOUT_S, recordStopped);
+        printf("stopped from %.0f degrees/s: estimate clamped to one edge since the latest, zero %.2f s after it\n",
+               directions[i] * 100.0, zeroAfter);
+        CHECK(overBound == 0);
+        CHECK(wrongSign == 0);
+        CHECK(zeroAfter > TIMEOUT_S);
+        CHECK(zeroAfter <= TIMEOUT_S + RATE_LOOP_S);
+        CHECK(getYawRate() == 0);
+
+        // The first edge after the timeout only restarts the estimate
+        worstError = 0;
+        zeroWhileMoving = 0;
+        turn(directions[i] * 10.0, 1.0, NULL);
+        turn(directions[i] * 10.0, 1.0, recordError);
+        CHECK(worstError < 0.02);
+        CHECK(zeroWhileMoving == 0);
+    }
+}
+
+int main(void)
+{
+    testLowRate();
+    testDirection();
+    testStopAndTimeout();
+    return testReport("test_yaw");
+}
@@ -0,0 +1,185 @@
+/** @file   timebase.c
+    @author Bailey Lissington, Dillon Pike, Joseph Ramirez
+    @date   21 May 2021
+    @brief  Functions related to the monotonic timebase.
+            Under HOST_BUILD the timebase is simulated from the host's monotonic clock.
+*/
+
+#ifdef HOST_BUILD
+#define _POSIX_C_SOURCE 199309L // clock_gettime, before any system header
+#endif
+
+// standard library includes
+#include <stdint.h>
+#include <stdbool.h>
+#ifdef HOST_BUILD
+#include <time.h>
+#endif
+
+// library includes
+#ifndef HOST_BUILD
+#include "inc/hw_memmap.h"
+#include "inc/hw_types.h"
+#include "inc/hw_timer.h"
+#include "driverlib/sysctl.h"
+#include "driverlib/timer.h"
+#include "driverlib/interrupt.h"
+#include "intcfg.h"
+#endif
+#include "clock.h"
+#include "timebase.h"
+
+#define TIMEBASE_PERIPH SYSCTL_PERIPH_WTIMER0
+#define TIMEBASE_BASE WTIMER0_BASE
+#define TIMEBASE_HOST_TICK_RATE SYS_CLOCK_HZ // matches the target's system clock
+
+static uint32_t tickRate; // timer increments per second
+static uint32_t ticksPerUs;
+
+#ifdef HOST_BUILD
+
+static uint64_t hostStart; // host clock at initTimebase in ticks
+static uint32_t hostMatch;
+static bool hostMatchSet = false;
+
+/** Returns the host's monotonic clock in ticks.  */
+static uint64_t hostTicks(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return ((uint64_t)now.tv_sec * 1000000000 + now.tv_nsec) / (1000000000 / TIMEBASE_HOST_TICK_RATE);
+}
+
+/** Starts the simulated timebase at 0.  */
+void initTimebase(void)
+{
+    tickRate = TIMEBASE_HOST_TICK_RATE;
+    ticksPerUs = tickRate / TIMEBASE_US_PER_S;
+    hostStart = hostTicks();
+}
+
+/** Returns the hardware count, the low 32 bits of the timebase.  */
+uint32_t timebaseGetCount(void)
+{
+    return (uint32_t)timebaseGetTicks();
+}
+
+/** Returns the overflow-extended timebase.  */
+uint64_t timebaseGetTicks(void)
+{
+    return hostTicks() - hostStart;
+}
+
+/** Sets the count at which the match interrupt fires.  */
+void timebaseSetMatch(uint32_t count)
+{
+    hostMatch = count;
+    hostMatchSet = true;
+}
+
+/** Returns whether the count has reached the match set.  */
+bool timebaseMatched(void)
+{
+    return hostMatchSet && ((int32_t)(timebaseGetCount() - hostMatch) >= 0);
+}
+
+#else
+
+static volatile uint32_t overflows = 0; // wraps of the hardware count
+
+/** Counts overflows of the hardware count and records the latency of match interrupts.  */
+static void timebaseIntHandler(void)
+{
+    uint32_t count = timebaseGetCount();
+
+    // Masked so a higher priority handler never sees the overflow cleared but not yet counted
+    IntMasterDisable();
+    uint32_t status = TimerIntStatus(TIMEBASE_BASE, true);
+    TimerIntClear(TIMEBASE_BASE, status);
+    if (status & TIMER_TIMA_TIMEOUT) {
+        overflows++;
+    }
+    IntMasterEnable();
+
+    if (status & TIMER_TIMA_MATCH) {
+        intLatencyRecord(INT_SRC_PACER, count - HWREG(TIMEBASE_BASE + TIMER_O_TAMATCHR));
+    }
+}
+
+/** Initialises WTIMER0A as a free-running counter and enables its overflow interrupt.  */
+void initTimebase(void)
+{
+    SysCtlPeripheralEnable(TIMEBASE_PERIPH);
+    tickRate = SysCtlClockGet();
+    ticksPerUs = tickRate / TIMEBASE_US_PER_S;
+
+    while (!SysCtlPeripheralReady(TIMEBASE_PERIPH));
+
+    // Full 32-bit count, extended by the overflow interrupt
+    TimerConfigure(TIMEBASE_BASE, TIMER_CFG_SPLIT_PAIR | TIMER_CFG_A_PERIODIC_UP);
+    TimerLoadSet(TIMEBASE_BASE, TIMER_A, UINT32_MAX);
+
+    // Match interrupt is used to wake the processor
+    HWREG(TIMEBASE_BASE + TIMER_O_TAMR) |= TIMER_TAMR_TAMIE;
+    TimerIntRegister(TIMEBASE_BASE, TIMER_A, timebaseIntHandler);
+    TimerIntEnable(TIMEBASE_BASE, TIMER_TIMA_TIMEOUT | TIMER_TIMA_MATCH);
+
+    TimerEnable(TIMEBASE_BASE, TIMER_A);
+}
+
+/** Returns the hardware count, the low 32 bits of the timebase.  */
+uint32_t timebaseGetCount(void)
+{
+    return TimerValueGet(TIMEBASE_BASE, TIMER_A);
+}
+
+/** Returns the overflow-extended timebase.  */
+uint64_t timebaseGetTicks(void)
+{
+    // Masked so the overflow count and hardware count are read together,
+    // even when called from a handler that preempts the overflow interrupt
+    bool wasDisabled = IntMasterDisable();
+    uint32_t high = overflows;
+    uint32_t count = timebaseGetCount();
+    bool pending = (TimerIntStatus(TIMEBASE_BASE, false) & TIMER_TIMA_TIMEOUT) != 0;
+
+    if (!wasDisabled) {
+        IntMasterEnable();
+    }
+    return timebaseExtend(high, count, pending);
+}
+
+/** Sets the count at which the match interrupt fires.  */
+void timebaseSetMatch(uint32_t count)
+{
+    TimerMatchSet(TIMEBASE_BASE, TIMER_A, count);
+}
+
+/** Returns whether the count has reached the match set since the last match interrupt.  */
+bool timebaseMatched(void)
+{
+    return (TimerIntStatus(TIMEBASE_BASE, false) & TIMER_TIMA_MATCH) != 0;
+}
+
+#endif /* HOST_BUILD */
+
+/** Returns the overflow-extended timebase in microseconds.  */
+uint64_t timebaseGetUs(void)
+{
+    return timebaseGetTicks() / ticksPerUs;
+}
+
+/** Returns the rate the timebase counts at.  */
+uint32_t timebaseGetTickRate(void)
+{
+    return tickRate;
+}
+
+/** Combines the overflow count and hardware count into the 64-bit time.  */
+uint64_t timebaseExtend(uint32_t high, uint32_t count, bool overflowPending)
+{
+    if (overflowPending && (count < (UINT32_MAX / 2))) {
+        high++;
+    }
+    return ((uint64_t)high << 32) | count;
+}
@@ -0,0 +1,55 @@
+/** @file   timebase.h
+    @author Bailey Lissington, Dillon Pike, Joseph Ramirez
+    @date   21 May 2021
+    @brief  Functions related to the monotonic timebase.
+            WTIMER0A counts up at the system clock rate, and its overflows are
+            counted to extend it to 64 bits, so times never wrap while running.
+            Safe to read from any task or interrupt handler.
+*/
+
+#ifndef TIMEBASE_H_
+#define TIMEBASE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define TIMEBASE_US_PER_S 1000000
+
+/** Initialises WTIMER0A as a free-running counter and enables its overflow interrupt.  */
+void initTimebase(void);
+
+/** Returns the hardware count, the low 32 bits of the timebase.
+    Cheaper than timebaseGetTicks for differences shorter than a wrap.
+    @return time in ticks, wrapping every 2^32 ticks.  */
+uint32_t timebaseGetCount(void);
+
+/** Returns the overflow-extended timebase.
+    @return time since initTimebase in ticks.  */
+uint64_t timebaseGetTicks(void);
+
+/** Returns the overflow-extended timebase in microseconds.
+    @return time since initTimebase in microseconds.  */
+uint64_t timebaseGetUs(void);
+
+/** Returns the rate the timebase counts at.
+    @return ticks per second.  */
+uint32_t timebaseGetTickRate(void);
+
+/** Sets the count at which the match interrupt fires, e.g. to wake the processor.
+    @param count to match.  */
+void timebaseSetMatch(uint32_t count);
+
+/** Returns whether the count has reached the match set since the last match interrupt.
+    @return true if the match interrupt is pending.  */
+bool timebaseMatched(void);
+
+/** Combines the overflow count and hardware count into the 64-bit time.
+    An overflow that is pending but not yet counted applies only if the count
+    was read after it, in which case the count is small.
+    @param high overflows counted by the interrupt handler.
+    @param count read from the hardware.
+    @param overflowPending true if the overflow interrupt was pending after count was read.
+    @return time in ticks.  */
+uint64_t timebaseExtend(uint32_t high, uint32_t count, bool overflowPending);
+
+#endif /* TIMEBASE_H_ */
@@ -0,0 +1,125 @@
+#!/usr/bin/env python3
+"""@file   lqr_gains.py
+   @brief  Computes the fixed-point state-feedback gains used by lqr.c.
+
+Host-side tool. Discretises the identified helirig model below at the
+control period, solves the discrete algebraic Riccati equation by
+iteration and prints the LQR_K_* defines for lqr.h. Uses only the Python
+standard library.
+
+State (plant minus reference):
+    [altitude (%), altitude rate (%/s), yaw (deg), yaw rate (deg/s),
+     altitude error integral (%.s), yaw error integral (deg.s)]
+Input:
+    [main thrust (%), tail thrust (%)] as deviations from the hover thrusts,
+    which actuatorShape turns into duties through the rotors' thrust curves
+
+Usage: python3 tools/lqr_gains.py [control period in s]
+"""
+
+import sys
+
+# Identified model parameters. Re-identify these from step responses on the rig.
+ALT_TAU = 0.8       # altitude rate time constant (s)
+ALT_GAIN = 3.0      # altitude acceleration per % main thrust (%/s^2)
+YAW_TAU = 0.5       # yaw rate time constant (s)
+YAW_GAIN = 20.0     # yaw acceleration per % tail thrust (deg/s^2)
+YAW_COUPLING = 15.0 # yaw acceleration per % main thrust from main rotor torque (deg/s^2)
+
+# Bryson's rule weights: largest acceptable value of each state and input
+STATE_MAX = [10.0, 40.0, 20.0, 120.0, 20.0, 40.0]
+INPUT_MAX = [15.0, 15.0]
+
+Q_FRACTION_BITS = 16 # fixed-point format of the printed gains
+
+
+def mat_mul(a, b):
+    return [[sum(a[i][k] * b[k][j] for k in range(len(b))) for j in range(len(b[0]))] for i in range(len(a))]
+
+
+def mat_add(a, b):
+    return [[a[i][j] + b[i][j] for j in range(len(a[0]))] for i in range(len(a))]
+
+
+def mat_scale(a, s):
+    return [[x * s for x in row] for row in a]
+
+
+def transpose(a):
+    return [list(row) for row in zip(*a)]
+
+
+def identity(n):
+    return [[1.0 if i == j else 0.0 for j in range(n)] for i in range(n)]
+
+
+def inverse(a):
+    n = len(a)
+    m = [row[:] + identity(n)[i] for i, row in enumerate(a)]
+    for col in range(n):
+        pivot = max(range(col, n), key=lambda r: abs(m[r][col]))
+        m[col], m[pivot] = m[pivot], m[col]
+        p = m[col][col]
+        m[col] = [x / p for x in m[col]]
+        for r in range(n):
+            if r != col:
+                f = m[r][col]
+                m[r] = [x - f * y for x, y in zip(m[r], m[col])]
+    return [row[n:] for row in m]
+
+
+def discretise(a, b, dt, terms=20):
+    """Zero-order-hold discretisation using the series expansion of exp([[A, B], [0, 0]] dt)."""
+    n, m = len(a), len(b[0])
+    big = [a[i] + b[i] for i in range(n)] + [[0.0] * (n + m) for _ in range(m)]
+    big = mat_scale(big, dt)
+    result = identity(n + m)
+    term = identity(n + m)
+    for k in range(1, terms):
+        term = mat_scale(mat_mul(term, big), 1.0 / k)
+        result = mat_add(result, term)
+    return [row[:n] for row in result[:n]], [row[n:] for row in result[:n]]
+
+
+def dlqr(ad, bd, q, r, iterations=5000):
+    p = q
+    for _ in range(iterations):
+        bt_p = mat_mul(transpose(bd), p)
+        k = mat_mul(inverse(mat_add(r, mat_mul(bt_p, bd))), mat_mul(bt_p, ad))
+        p = mat_add(q, mat_mul(mat_mul(transpose(ad), p), mat_add(ad, mat_scale(mat_mul(bd, k), -1.0))))
+    return k
+
+
+def main():
+    dt = float(sys.argv[1]) if len(sys.argv) > 1 else 0.1
+
+    a = [[0, 1, 0, 0, 0, 0],
+         [0, -1 / ALT_TAU, 0, 0, 0, 0],
+         [0, 0, 0, 1, 0, 0],
+         [0, 0, 0, -1 / YAW_TAU, 0, 0],
+         [1, 0, 0, 0, 0, 0],
+         [0, 0, 1, 0, 0, 0]]
+    b = [[0, 0],
+         [ALT_GAIN, 0],
+         [0, 0],
+         [-YAW_COUPLING, YAW_GAIN],
+         [0, 0],
+         [0, 0]]
+    a = [[float(x) for x in row] for row in a]
+    b = [[float(x) for x in row] for row in b]
+
+    q = [[(1 / STATE_MAX[i] ** 2) if i == j else 0.0 for j in range(6)] for i in range(6)]
+    r = [[(1 / INPUT_MAX[i] ** 2) if i == j else 0.0 for j in range(2)] for i in range(2)]
+
+    ad, bd = discretise(a, b, dt)
+    k = dlqr(ad, bd, q, r)
+
+    names = ["ALT", "ALT_RATE", "YAW", "YAW_RATE", "ALT_INT", "YAW_INT"]
+    print("// Generated by tools/lqr_gains.py for a %g s control period" % dt)
+    for row, rotor in zip(k, ["MAIN", "TAIL"]):
+        for gain, name in zip(row, names):
+            print("#define LQR_K_%s_%s %d // %.4f" % (rotor, name, round(gain * (1 << Q_FRACTION_BITS)), gain))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,86 @@
+/** @file   traj.c
+    @author Bailey Lissington, Dillon Pike, Joseph Ramirez
+    @date   21 May 2021
+    @brief  Functions related to generating smooth setpoint trajectories.
+*/
+
+// standard library includes
+#include <stdint.h>
+#include <stdbool.h>
+#include <math.h>
+
+// library includes
+#include "traj.h"
+
+// Macro function definition
+#define CONSTRAIN(x, lo, hi) (((x) < (lo)) ? (lo) : (((x) > (hi)) ? (hi) : (x))) // Constrains x between lo and hi
+
+/** Wraps a value between negative and positive half of the wrap range of a trajectory.
+    @param address of trajectory.
+    @param value to wrap.
+    @return wrapped value.  */
+static double trajWrap(const trajectory_t* traj, double value)
+{
+    if (traj->wrapRange > 0) {
+        if (value < -(traj->wrapRange / 2)) {
+            value += traj->wrapRange;
+        } else if (value >= (traj->wrapRange / 2)) {
+            value -= traj->wrapRange;
+        }
+    }
+    return value;
+}
+
+/** Initialises a trajectory at rest at the given position.  */
+void trajInit(trajectory_t* traj, double position, double maxRate, double maxAccel, double wrapRange)
+{
+    traj->maxRate = maxRate;
+    traj->maxNegativeRate = maxRate;
+    traj->maxAccel = maxAccel;
+    traj->wrapRange = wrapRange;
+    trajReset(traj, position);
+}
+
+/** Limits the negative velocity of a trajectory below its maximum rate.  */
+void trajSetNegativeRate(trajectory_t* traj, double maxNegativeRate)
+{
+    traj->maxNegativeRate = CONSTRAIN(maxNegativeRate, 0, traj->maxRate);
+}
+
+/** Moves a trajectory to the given position and brings it to rest.  */
+void trajReset(trajectory_t* traj, double position)
+{
+    traj->position = position;
+    traj->velocity = 0;
+    traj->acceleration = 0;
+}
+
+/** Advances a trajectory by deltaT towards the target without exceeding its rate and
+    acceleration limits, decelerating so it comes to rest on the target.  */
+double trajUpdate(trajectory_t* traj, double target, double deltaT)
+{
+    double distance = trajWrap(traj, target - traj->position);
+    double maxDeltaV = traj->maxAccel * deltaT;
+
+    // Settles on the target once it can be reached and stopped at within this update
+    if ((fabs(distance) <= fabs(traj->velocity) * deltaT + maxDeltaV * deltaT) && (fabs(traj->velocity) <= maxDeltaV)) {
+        traj->position = trajWrap(traj, target);
+        traj->acceleration = -traj->velocity / deltaT;
+        traj->velocity = 0;
+        return traj->position;
+    }
+
+    // Fastest velocity that can still be brought to rest on the target at maxAccel. Stopping from
+    // v takes whole updates, covering deltaT * (v + (v - maxDeltaV) + ...), so the number of
+    // updates is found first and then the distance is solved for v, so it never overshoots
+    double steps = floor(sqrt(maxDeltaV * maxDeltaV / 4 + 2 * traj->maxAccel * fabs(distance)) / maxDeltaV - 0.5);
+    double stopVelocity = (fabs(distance) / deltaT + maxDeltaV * steps * (steps + 1) / 2) / (steps + 1);
+    double desiredVelocity = CONSTRAIN((distance < 0) ? -stopVelocity : stopVelocity, -traj->maxNegativeRate, traj->maxRate);
+
+    double deltaV = CONSTRAIN(desiredVelocity - traj->velocity, -maxDeltaV, maxDeltaV);
+    traj->velocity += deltaV;
+    traj->acceleration = deltaV / deltaT;
+    traj->position = trajWrap(traj, traj->position + traj->velocity * deltaT);
+
+    return traj->position;
+}
@@ -0,0 +1,61 @@
+/** @file   traj.h
+    @author Bailey Lissington, Dillon Pike, Joseph Ramirez
+    @date   21 May 2021
+    @brief  Functions related to generating smooth setpoint trajectories.
+*/
+
+#ifndef TRAJ_H_
+#define TRAJ_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Rate and acceleration limits of the altitude reference (% per s and % per s^2). The rate
+// loop is fed the reference's rate and acceleration, so these are what the heli flies;
+// descents are further limited to ALT_MAX_DESCENT_RATE
+#define ALT_TRAJ_MAX_RATE 20.0
+#define ALT_TRAJ_MAX_ACCEL 20.0
+
+// Rate and acceleration limits of the yaw reference (degrees per s and degrees per s^2)
+#define YAW_TRAJ_MAX_RATE 60.0
+#define YAW_TRAJ_MAX_ACCEL 120.0
+
+// Rate and acceleration limited reference profile
+typedef struct {
+    double position;        // current reference value
+    double velocity;        // current reference rate of change per second
+    double acceleration;    // change in velocity per second over the last update
+    double maxRate;         // maximum magnitude of velocity
+    double maxNegativeRate; // maximum magnitude of negative velocity, maxRate unless set lower
+    double maxAccel;        // maximum magnitude of the change in velocity per second
+    double wrapRange;       // range position wraps around in (e.g. a full rotation), or 0 to not wrap
+} trajectory_t;
+
+/** Initialises a trajectory at rest at the given position.
+    @param address of trajectory.
+    @param initial position.
+    @param maximum rate.
+    @param maximum acceleration.
+    @param range position wraps around in, or 0 to not wrap.  */
+void trajInit(trajectory_t* traj, double position, double maxRate, double maxAccel, double wrapRange);
+
+/** Limits the negative velocity of a trajectory below its maximum rate, e.g. to descend
+    more slowly than it climbs.
+    @param address of trajectory.
+    @param maximum magnitude of negative velocity.  */
+void trajSetNegativeRate(trajectory_t* traj, double maxNegativeRate);
+
+/** Moves a trajectory to the given position and brings it to rest.
+    @param address of trajectory.
+    @param new position.  */
+void trajReset(trajectory_t* traj, double position);
+
+/** Advances a trajectory by deltaT towards the target without exceeding its rate and
+    acceleration limits, decelerating so it comes to rest on the target.
+    @param address of trajectory.
+    @param target position.
+    @param time since the last update in seconds.
+    @return updated reference position.  */
+double trajUpdate(trajectory_t* traj, double target, double deltaT);
+
+#endif /* TRAJ_H_ */
@@ -38,6 +38,21 @@ extern "C"
 {
 #endif
 
+//*****************************************************************************
+//
+// Built for buffered operation, so UARTprintf() queues its output for the
+// UART interrupt to send rather than waiting on the 16 byte FIFO.  Defined
+// here so that uartstdio.c and its callers agree on it.  The transmit buffer
+// holds a profile report and a SCHED report alongside the telemetry.
+//
+//*****************************************************************************
+#ifndef UART_BUFFERED
+#define UART_BUFFERED
+#endif
+#ifndef UART_TX_BUFFER_SIZE
+#define UART_TX_BUFFER_SIZE     2048
+#endif
+
 //*****************************************************************************
 //
 // If built for buffered operation, the following labels define the sizes of
@@ -72,6 +87,7 @@ extern void UARTFlushRx(void);
 extern int UARTRxBytesAvail(void);
 extern int UARTTxBytesFree(void);
 extern void UARTEchoSet(bool bEnable);
+extern void UARTStdioIntHandler(void);
 #endif
 
 //*****************************************************************************
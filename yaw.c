@@ -10,24 +10,40 @@
 
 // library includes
 #include "inc/hw_memmap.h"
+#include "inc/hw_ints.h"
 #include "driverlib/gpio.h"
 #include "driverlib/sysctl.h"
+#include "driverlib/interrupt.h"
 #include "yaw.h"
+#include "timebase.h"
+#include "profile.h"
 
 #define DISC_SLOTS 112 // number of slots on the encoder disc
 #define EDGES_PER_SLOT 4 // total number of rising and falling edges per slot
 #define DEGREES_PER_REV 360 // number of degrees in a full revolution
 
+#define YAW_RATE_TIMEOUT_S 0.5 // time without an edge after which the yaw rate is taken as 0
+
 // global yaw counter variable that tracks how many disc slots the reader is away from the origin
 static volatile int16_t yawCounter = 0;
 
-// flag for refYawIntHandler to set so it can be handled in main loop
-volatile bool refYawFlag = false;
+// queue of reference yaw events, produced by refYawIntHandler only
+eventQueue_t refYawEvents;
 
 // global variables that track the state of channel A and B
 static volatile bool aState;
 static volatile bool bState;
 
+// signed edges counted since the last yaw rate estimate and the timebase count at the latest edge
+static volatile int16_t yawEdgeCount = 0;
+static volatile uint32_t yawEdgeTime = 0;
+
+// yaw rate estimate state
+static uint32_t yawTimerRate; // timebase ticks per second
+static uint32_t prevRateEdgeTime; // timebase count at the latest edge used by the previous estimate
+static double yawRate = 0; // latest yaw rate estimate in degrees per second
+static bool yawRateTimedOut = true; // has the time since the latest edge exceeded YAW_RATE_TIMEOUT_S?
+
 /** Enables GPIO port B and initialises YawIntHandler to run when the values on pins 0 or 1 change.  */
 void initYawInt(void)
 {
@@ -44,6 +60,8 @@ void initYawInt(void)
 /** Enables GPIO port C and registers refYawIntHandler to run when the value on pin 4 is changes to low.  */
 void initRefYawInt(void)
 {
+    eventQueueInit(&refYawEvents);
+
     SysCtlPeripheralEnable(SYSCTL_PERIPH_GPIOC);
 
     GPIOPinTypeGPIOInput(GPIO_PORTC_BASE, GPIO_PIN_4);
@@ -65,34 +83,34 @@ void initYawStates(void)
     Decrements yawCounter if channel B leads (counter-clockwise).  */
 void YawIntHandler(void)
 {
+    PROFILE_START(PROFILE_YAW_ISR);
     uint32_t status = GPIOIntStatus(GPIO_PORTB_BASE, true);
     GPIOIntClear(GPIO_PORTB_BASE, status);
 
+    int8_t direction;
+
     if (status & GPIO_PIN_0) { // if channel A changes
         aState = !aState;
-        if (aState != bState) { // if channel A leads
-            yawCounter--;
-        } else {
-            yawCounter++;
-        }
+        direction = (aState != bState) ? -1 : 1; // decrements if channel A leads
     } else {
         bState = !bState;
-        if (aState != bState) { // if channel B leads
-            yawCounter++;
-        } else {
-            yawCounter--;
-        }
+        direction = (aState != bState) ? 1 : -1; // increments if channel B leads
     }
+    yawCounter += direction;
     yawConstrain();
+
+    yawEdgeCount += direction;
+    yawEdgeTime = timebaseGetCount();
+    PROFILE_END(PROFILE_YAW_ISR);
 }
 
 /** Sets the yawCounter to 0 so the reference yaw is at 0,
-    sets a flag for the main loop, then disables the interrupt.  */
+    posts EVENT_REF_YAW_FOUND, then disables the interrupt.  */
 void refYawIntHandler(void)
 {
     GPIOIntClear(GPIO_PORTC_BASE, GPIO_INT_PIN_4);
     yawCounter = 0;
-    refYawFlag = true;
+    eventPost(&refYawEvents, EVENT_REF_YAW_FOUND, 0, 0);
     GPIOIntDisable(GPIO_PORTC_BASE, GPIO_INT_PIN_4);
 }
 
@@ -114,6 +132,56 @@ int16_t getYawDegrees(void)
     return yawCounter * DEGREES_PER_REV / (EDGES_PER_SLOT * DISC_SLOTS);
 }
 
+/** Initialises the yaw rate estimate, which timestamps encoder edges with the timebase.
+    The timebase must already be initialised.  */
+void initYawRate(void)
+{
+    yawTimerRate = timebaseGetTickRate();
+    prevRateEdgeTime = timebaseGetCount();
+}
+
+/** Estimates the yaw rate from the encoder edges since the last call. The rate is the
+    number of edges over the time between the latest edges of this call and the last,
+    which keeps its resolution at low rates where few edges arrive between calls.
+    @return yaw rate in degrees per second, positive when yawCounter increases.  */
+double getYawRate(void)
+{
+    int16_t edges;
+    uint32_t edgeTime;
+
+    // Takes the edges counted so far without an edge arriving in between
+    IntDisable(INT_GPIOB);
+    edges = yawEdgeCount;
+    edgeTime = yawEdgeTime;
+    yawEdgeCount = 0;
+    IntEnable(INT_GPIOB);
+
+    if ((edges != 0) && yawRateTimedOut) {
+        // Restarts the estimate from the latest edge since the time before it was idle
+        yawRate = 0;
+        prevRateEdgeTime = edgeTime;
+        yawRateTimedOut = false;
+    } else if (edges != 0) {
+        yawRate = (double)edges * DEGREES_PER_REV / (EDGES_PER_SLOT * DISC_SLOTS)
+                  * yawTimerRate / (uint32_t)(edgeTime - prevRateEdgeTime);
+        prevRateEdgeTime = edgeTime;
+    } else {
+        // Without a new edge the rate can be no more than one edge over the time since the latest edge
+        double elapsed = (double)(uint32_t)(timebaseGetCount() - prevRateEdgeTime) / yawTimerRate;
+        double maxRate = (double)DEGREES_PER_REV / (EDGES_PER_SLOT * DISC_SLOTS) / elapsed;
+
+        if (elapsed > YAW_RATE_TIMEOUT_S) {
+            yawRate = 0;
+            yawRateTimedOut = true;
+        } else if (yawRate > maxRate) {
+            yawRate = maxRate;
+        } else if (yawRate < -maxRate) {
+            yawRate = -maxRate;
+        }
+    }
+    return yawRate;
+}
+
 /** Enables PC4 interrupts to be handled and clears any interrupts generated while disabled.  */
 void enableRefYawInt(void)
 {
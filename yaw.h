@@ -7,7 +7,9 @@
 #ifndef YAW_H
 #define YAW_H
 
-extern volatile bool refYawFlag; // flag for refYawIntHandler to set so it can be handled in main loop
+#include "event.h"
+
+extern eventQueue_t refYawEvents; // EVENT_REF_YAW_FOUND posted by refYawIntHandler
 
 /** Enables GPIO port B and initialises YawIntHandler to run when the values on pins 0 or 1 change.  */
 void initYawInt(void);
@@ -24,7 +26,7 @@ void initYawStates(void);
 void YawIntHandler(void);
 
 /** Sets the yawCounter to 0 so the reference yaw is at 0,
-    sets a flag for the main loop, then disables the interrupt.  */
+    posts EVENT_REF_YAW_FOUND, then disables the interrupt.  */
 void refYawIntHandler(void);
 
 /** Constrains yawCounter between the negative and positive values of the counter at half a rotation.
@@ -35,6 +37,14 @@ void yawConstrain(void);
     @return yawCounter converted to degrees.  */
 int16_t getYawDegrees(void);
 
+/** Initialises the yaw rate estimate, which timestamps encoder edges with the timebase.
+    The timebase must already be initialised.  */
+void initYawRate(void);
+
+/** Estimates the yaw rate from the encoder edges since the last call.
+    @return yaw rate in degrees per second, positive when yawCounter increases.  */
+double getYawRate(void);
+
 /** Enables PC4 interrupts to be handled and clears any interrupts generated while disabled.  */
 void enableRefYawInt(void);
 